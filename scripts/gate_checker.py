@@ -22,12 +22,19 @@ from __future__ import annotations
 import argparse
 import json
 import re
+import subprocess
 import sys
 from pathlib import Path
 from typing import Any, Dict, List, Optional, Tuple
 
 import yaml
 
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
+
+from scripts.utils.diff_parser import parse_diff, save_parsed_diff
+from scripts.utils.metrics import StageMetrics
+from scripts.utils.token_budget import estimate_tokens
+
 
 # C++ file extensions that are reviewable
 CPP_EXTENSIONS = {".cpp", ".h", ".inl", ".hpp", ".cc", ".cxx", ".hxx"}
@@ -205,12 +212,50 @@ def parse_diff_files(diff_text: str) -> List[str]:
     return files
 
 
+def _compile_skip_patterns(
+    skip_patterns: List[str],
+) -> Tuple[List[Tuple[str, "re.Pattern[str]"]], Optional["re.Pattern[str]"]]:
+    """Compile skip patterns individually and as one merged alternation.
+
+    The merged regex answers "does any pattern match?" in a single scan
+    per path; the per-pattern list is kept for attributing the matching
+    pattern in the skip reason (and as a fallback if the merge fails).
+
+    Args:
+        skip_patterns: Regex patterns from gate_config.yml.
+
+    Returns:
+        Tuple of (compiled per-pattern list, combined regex or None).
+    """
+    compiled_patterns: List[Tuple[str, "re.Pattern[str]"]] = []
+    for pattern in skip_patterns:
+        try:
+            compiled_patterns.append((pattern, re.compile(pattern)))
+        except re.error as e:
+            print(f"Warning: Invalid skip pattern '{pattern}': {e}", file=sys.stderr)
+
+    combined: Optional["re.Pattern[str]"] = None
+    if compiled_patterns:
+        try:
+            combined = re.compile(
+                "|".join(f"(?:{p})" for p, _ in compiled_patterns)
+            )
+        except re.error:
+            combined = None
+
+    return compiled_patterns, combined
+
+
 def filter_files(
     files: List[str],
     skip_patterns: List[str],
 ) -> Tuple[List[str], List[Dict[str, str]]]:
     """Separate files into reviewable and skipped based on skip_patterns and C++ extension.
 
+    Skip patterns are merged into one compiled alternation, so each path
+    is scanned once instead of once per pattern; only paths that hit are
+    re-checked per pattern to name the filter in the skip reason.
+
     Args:
         files: List of all changed file paths.
         skip_patterns: Regex patterns from gate_config.yml.
@@ -219,27 +264,23 @@ def filter_files(
         Tuple of (reviewable_files, skipped_files).
         skipped_files contains dicts with 'file' and 'reason' keys.
     """
-    compiled_patterns = []
-    for pattern in skip_patterns:
-        try:
-            compiled_patterns.append((pattern, re.compile(pattern)))
-        except re.error as e:
-            print(f"Warning: Invalid skip pattern '{pattern}': {e}", file=sys.stderr)
+    compiled_patterns, combined = _compile_skip_patterns(skip_patterns)
 
     reviewable = []
     skipped = []
 
     for filepath in files:
-        # Check skip patterns first
+        # Check skip patterns first — one combined scan per path
         skip_matched = False
-        for pattern_str, pattern_re in compiled_patterns:
-            if pattern_re.search(filepath):
-                skipped.append({
-                    "file": filepath,
-                    "reason": f"경로 필터: {pattern_str}",
-                })
-                skip_matched = True
-                break
+        if combined is None or combined.search(filepath):
+            for pattern_str, pattern_re in compiled_patterns:
+                if pattern_re.search(filepath):
+                    skipped.append({
+                        "file": filepath,
+                        "reason": f"경로 필터: {pattern_str}",
+                    })
+                    skip_matched = True
+                    break
 
         if skip_matched:
             continue
@@ -299,20 +340,28 @@ def classify_pr(
     return is_large, reasons
 
 
-def determine_allowed_stages(is_large: bool) -> Tuple[List[int], List[int]]:
+def determine_allowed_stages(
+    is_large: bool,
+    stage3_sharded: bool = False,
+) -> Tuple[List[int], List[int]]:
     """Determine which review stages are allowed based on PR size.
 
     Normal PR:  Stage 1 + Stage 2 (if available) + Stage 3
     Large PR:   Stage 1 + Stage 2 (if available), NO Stage 3
+                — unless Stage 3 sharding is enabled, in which case
+                Stage 3 runs split across balanced shards instead of
+                being blocked outright.
 
     Args:
         is_large: Whether the PR is classified as large.
+        stage3_sharded: Whether the config opts into sharded Stage 3
+            for large PRs (``stage3_shard_count`` >= 2).
 
     Returns:
         Tuple of (allowed_stages, manual_allowed_stages).
         Both follow the same rules per current spec.
     """
-    if is_large:
+    if is_large and not stage3_sharded:
         stages = [1, 2]
     else:
         stages = [1, 2, 3]
@@ -321,17 +370,305 @@ def determine_allowed_stages(is_large: bool) -> Tuple[List[int], List[int]]:
     return stages, stages
 
 
+def estimate_file_weights(
+    diff_text: str,
+    files: List[str],
+) -> Dict[str, int]:
+    """Estimate a per-file token weight from the textual diff.
+
+    Splits the diff into per-file sections (keyed by the same header
+    lines :func:`parse_diff_files` uses) and estimates tokens for each.
+    Files without a section — or all files, in plumbing mode where no
+    textual diff exists — fall back to weight 1, degrading balanced
+    sharding to plain count balancing.
+
+    Args:
+        diff_text: Raw unified diff text (may be empty).
+        files: File paths to weigh.
+
+    Returns:
+        Mapping of file path to estimated token weight (>= 1).
+    """
+    weights: Dict[str, int] = {f: 1 for f in files}
+    if not diff_text:
+        return weights
+
+    wanted = set(files)
+    current: Optional[str] = None
+    section: List[str] = []
+    in_header = False
+
+    def _flush() -> None:
+        nonlocal current, section
+        if current is not None and section:
+            weights[current] = max(
+                weights.get(current, 1),
+                estimate_tokens("\n".join(section)),
+            )
+        section = []
+
+    for line in diff_text.splitlines():
+        if _DIFF_MARKER_RE.match(line):
+            _flush()
+            current = None
+            in_header = True
+        elif line.startswith("@@"):
+            in_header = False
+        elif in_header and current is None:
+            for pattern in (_PLUS_HEADER_RE, _BINARY_HEADER_RE, _RENAME_TO_RE):
+                m = pattern.match(line)
+                if m:
+                    path = _decode_git_path(m.group(1))
+                    if path in wanted:
+                        current = path
+                    break
+        section.append(line)
+    _flush()
+
+    return weights
+
+
+def partition_files_by_weight(
+    files: List[str],
+    weights: Dict[str, int],
+    shard_count: int,
+) -> List[List[str]]:
+    """Partition files into at most *shard_count* weight-balanced shards.
+
+    Greedy longest-processing-time assignment: files are placed heaviest
+    first onto the currently lightest shard, which keeps shard token
+    totals close enough for matrix jobs to finish at similar times.
+    Within each shard the original file order is restored so shard
+    contents stay deterministic and diff-ordered.
+
+    Args:
+        files: File paths to partition (order-preserving per shard).
+        weights: Per-file token weights (missing entries count as 1).
+        shard_count: Requested number of shards.
+
+    Returns:
+        Non-empty shards (fewer than *shard_count* when there are fewer
+        files); empty list when *files* is empty.
+    """
+    if not files:
+        return []
+    if shard_count <= 1 or len(files) == 1:
+        return [list(files)]
+
+    shard_count = min(shard_count, len(files))
+    order = {f: i for i, f in enumerate(files)}
+    shards: List[List[str]] = [[] for _ in range(shard_count)]
+    loads = [0] * shard_count
+
+    for filepath in sorted(
+        files, key=lambda f: (-weights.get(f, 1), order[f])
+    ):
+        lightest = min(range(shard_count), key=lambda i: (loads[i], i))
+        shards[lightest].append(filepath)
+        loads[lightest] += weights.get(filepath, 1)
+
+    for shard in shards:
+        shard.sort(key=lambda f: order[f])
+    return [shard for shard in shards if shard]
+
+
+def compute_stage3_shards(
+    files: List[str],
+    diff_text: str,
+    config: Dict[str, Any],
+    is_large: bool,
+) -> List[List[str]]:
+    """Compute the Stage 3 shard layout for the current review set.
+
+    Normal PRs (or configs without ``stage3_shard_count``) get a single
+    shard holding the whole review set, so consumers can treat sharded
+    and unsharded runs uniformly.  Large PRs with sharding enabled are
+    partitioned into token-weight-balanced shards.
+
+    Args:
+        files: Files under review this run.
+        diff_text: Raw unified diff text (may be empty in plumbing mode).
+        config: Parsed gate configuration.
+        is_large: Whether the PR is classified as large.
+
+    Returns:
+        List of shard file lists (empty when *files* is empty).
+    """
+    shard_count = int(config.get("stage3_shard_count", 0) or 0)
+    if not (is_large and shard_count >= 2):
+        shard_count = 1
+    weights = estimate_file_weights(diff_text, files) if shard_count > 1 else {}
+    return partition_files_by_weight(files, weights, shard_count)
+
+
+def get_changed_files_from_git(
+    base_ref: str,
+    head_ref: str = "HEAD",
+) -> List[str]:
+    """List changed files via git plumbing instead of parsing a full diff.
+
+    Runs ``git diff --name-status -z --no-renames`` — no textual diff is
+    generated or parsed, so this stays fast on engine-merge PRs touching
+    tens of thousands of files.  ``-z`` gives NUL-separated raw paths
+    (no quoting/escaping), and ``--no-renames`` keeps records as plain
+    status/path pairs.  Deleted files are excluded, matching
+    :func:`parse_diff_files` semantics.
+
+    Args:
+        base_ref: Base git ref (e.g. ``origin/main``).
+        head_ref: Head ref to compare against (default: HEAD).
+
+    Returns:
+        List of changed file paths (deduplicated, preserving order).
+
+    Raises:
+        RuntimeError: If the git command fails.
+    """
+    cmd = [
+        "git", "diff", "--name-status", "-z", "--no-renames",
+        f"{base_ref}...{head_ref}",
+    ]
+    result = subprocess.run(cmd, capture_output=True, text=True, timeout=60)
+    if result.returncode != 0:
+        raise RuntimeError(f"git diff --name-status failed: {result.stderr}")
+
+    files: List[str] = []
+    seen = set()
+    tokens = result.stdout.split("\0")
+    i = 0
+    while i + 1 < len(tokens):
+        status = tokens[i]
+        filepath = tokens[i + 1]
+        i += 2
+        if not status or not filepath:
+            continue
+        # Deleted files have no reviewable content
+        if status.startswith("D"):
+            continue
+        if filepath not in seen:
+            files.append(filepath)
+            seen.add(filepath)
+    return files
+
+
+def read_last_reviewed_sha(marker_path: str) -> Optional[str]:
+    """Read the last-reviewed commit SHA from a delta marker file.
+
+    The marker is a small JSON file (``{"last_reviewed_sha": "<sha>"}``)
+    persisted across workflow runs (e.g. via actions/cache).  Any problem
+    reading it — missing file, corrupt JSON, unexpected shape — degrades
+    to ``None``, which callers treat as "no previous review: full run".
+
+    Args:
+        marker_path: Path to the marker JSON file.
+
+    Returns:
+        The recorded SHA, or None if unavailable.
+    """
+    path = Path(marker_path)
+    if not path.exists():
+        return None
+    try:
+        data = json.loads(path.read_text(encoding="utf-8"))
+    except (OSError, json.JSONDecodeError) as e:
+        print(
+            f"Warning: Could not read delta marker {marker_path}: {e}",
+            file=sys.stderr,
+        )
+        return None
+    if not isinstance(data, dict):
+        print(
+            f"Warning: Unrecognized delta marker format: {marker_path}",
+            file=sys.stderr,
+        )
+        return None
+    sha = data.get("last_reviewed_sha")
+    if isinstance(sha, str) and sha:
+        return sha
+    return None
+
+
+def write_last_reviewed_sha(marker_path: str, sha: str) -> None:
+    """Record *sha* as the last reviewed commit in the delta marker file.
+
+    Write failures are non-fatal: the next run simply falls back to a
+    full review.
+
+    Args:
+        marker_path: Path to the marker JSON file.
+        sha: Head commit SHA of the review that is about to run.
+    """
+    try:
+        Path(marker_path).write_text(
+            json.dumps({"last_reviewed_sha": sha}) + "\n", encoding="utf-8"
+        )
+    except OSError as e:
+        print(
+            f"Warning: Could not write delta marker {marker_path}: {e}",
+            file=sys.stderr,
+        )
+
+
+def compute_delta_files(last_sha: str, head_sha: str) -> Optional[List[str]]:
+    """List files changed between the last reviewed commit and head.
+
+    Wraps :func:`get_changed_files_from_git`.  Failures (e.g. the
+    recorded SHA was dropped by a force-push and no longer resolves)
+    return ``None`` so callers fall back to a full review instead of
+    silently reviewing nothing.
+
+    Args:
+        last_sha: Commit SHA recorded by the previous review run.
+        head_sha: Current head commit SHA.
+
+    Returns:
+        Changed file paths, or None if the delta could not be computed.
+    """
+    try:
+        return get_changed_files_from_git(last_sha, head_sha)
+    except (RuntimeError, subprocess.TimeoutExpired, OSError) as e:
+        print(
+            f"Warning: Could not compute delta against {last_sha}: {e}; "
+            "falling back to full review",
+            file=sys.stderr,
+        )
+        return None
+
+
+def _resolve_head_sha() -> Optional[str]:
+    """Resolve the current HEAD commit SHA, or None on failure."""
+    try:
+        result = subprocess.run(
+            ["git", "rev-parse", "HEAD"],
+            capture_output=True, text=True, timeout=10,
+        )
+    except (OSError, subprocess.TimeoutExpired) as e:
+        print(f"Warning: git rev-parse HEAD failed: {e}", file=sys.stderr)
+        return None
+    if result.returncode != 0:
+        print(
+            f"Warning: git rev-parse HEAD failed: {result.stderr}",
+            file=sys.stderr,
+        )
+        return None
+    return result.stdout.strip() or None
+
+
 def run_gate_check(
     diff_text: str,
     config: Dict[str, Any],
     labels: Optional[List[str]] = None,
+    changed_files: Optional[List[str]] = None,
 ) -> Dict[str, Any]:
     """Execute the full gate check pipeline.
 
     Args:
-        diff_text: Raw unified diff text.
+        diff_text: Raw unified diff text.  Ignored when *changed_files*
+            is provided.
         config: Parsed gate configuration.
         labels: PR labels (empty list if not provided).
+        changed_files: Pre-computed changed file list (e.g. from
+            :func:`get_changed_files_from_git`).  Skips diff parsing.
 
     Returns:
         Gate check result dictionary matching the output JSON schema.
@@ -339,8 +676,11 @@ def run_gate_check(
     if labels is None:
         labels = []
 
-    # Step 1: Parse diff and filter files
-    all_files = parse_diff_files(diff_text)
+    # Step 1: Parse diff (or take the plumbing list) and filter files
+    if changed_files is not None:
+        all_files = changed_files
+    else:
+        all_files = parse_diff_files(diff_text)
     reviewable_files, skipped_files = filter_files(
         all_files, config["skip_patterns"]
     )
@@ -353,8 +693,17 @@ def run_gate_check(
         large_pr_labels=config["large_pr_labels"],
     )
 
-    # Determine allowed stages
-    allowed_stages, manual_allowed_stages = determine_allowed_stages(is_large)
+    # Determine allowed stages — sharding opts large PRs back into a
+    # scaled-out Stage 3 instead of the hard cutoff.
+    shard_count = int(config.get("stage3_shard_count", 0) or 0)
+    stage3_sharded = bool(is_large and shard_count >= 2 and reviewable_files)
+    allowed_stages, manual_allowed_stages = determine_allowed_stages(
+        is_large, stage3_sharded=stage3_sharded
+    )
+
+    stage3_shards = compute_stage3_shards(
+        reviewable_files, diff_text, config, is_large
+    )
 
     return {
         "is_large_pr": is_large,
@@ -366,6 +715,8 @@ def run_gate_check(
         "reviewable_count": len(reviewable_files),
         "skipped_files": skipped_files,
         "skipped_count": len(skipped_files),
+        "stage3_shards": stage3_shards,
+        "stage3_shard_count": len(stage3_shards),
     }
 
 
@@ -375,9 +726,21 @@ def main() -> None:
     )
     parser.add_argument(
         "--diff",
-        required=True,
         help="Path to the unified diff file",
     )
+    parser.add_argument(
+        "--base-ref",
+        help=(
+            "Base git ref for plumbing mode (e.g. origin/main). Lists "
+            "changed files via git diff --name-status -z --no-renames "
+            "instead of parsing a full textual diff."
+        ),
+    )
+    parser.add_argument(
+        "--head-ref",
+        default="HEAD",
+        help="Head git ref for plumbing mode (default: HEAD)",
+    )
     parser.add_argument(
         "--config",
         default="configs/gate_config.yml",
@@ -393,25 +756,143 @@ def main() -> None:
         default="",
         help="Comma-separated PR labels",
     )
+    parser.add_argument(
+        "--parsed-diff-output",
+        default=None,
+        help=(
+            "Optional path for a parsed-diff JSON artifact. Downstream "
+            "stages can load it (--parsed-diff) instead of each "
+            "re-parsing the raw diff."
+        ),
+    )
+    parser.add_argument(
+        "--metrics-output",
+        default=None,
+        help="Optional path for a structured timing-metrics JSON artifact",
+    )
+    parser.add_argument(
+        "--delta-marker",
+        default=None,
+        help=(
+            "Path to a JSON marker recording the last reviewed commit "
+            "SHA. When it holds a different SHA, review_files is "
+            "narrowed to files changed since that commit (delta "
+            "review); the marker is then advanced to the current head."
+        ),
+    )
+    parser.add_argument(
+        "--head-sha",
+        default=None,
+        help=(
+            "Head commit SHA for delta review bookkeeping "
+            "(default: git rev-parse HEAD)"
+        ),
+    )
 
     args = parser.parse_args()
+    metrics = StageMetrics("gate")
 
     # Load config
     config = load_config(args.config)
 
-    # Read diff
-    diff_path = Path(args.diff)
-    if not diff_path.exists():
-        print(f"Error: Diff file not found: {args.diff}", file=sys.stderr)
+    # Obtain changed files — plumbing mode avoids generating and parsing
+    # a full textual diff on huge PRs.
+    diff_text = ""
+    changed_files: Optional[List[str]] = None
+    if args.base_ref:
+        try:
+            changed_files = get_changed_files_from_git(
+                args.base_ref, args.head_ref
+            )
+        except RuntimeError as e:
+            print(f"Error: {e}", file=sys.stderr)
+            sys.exit(1)
+    elif args.diff:
+        diff_path = Path(args.diff)
+        if not diff_path.exists():
+            print(f"Error: Diff file not found: {args.diff}", file=sys.stderr)
+            sys.exit(1)
+        diff_text = diff_path.read_text(encoding="utf-8", errors="replace")
+    else:
+        print(
+            "Error: Either --diff or --base-ref is required",
+            file=sys.stderr,
+        )
         sys.exit(1)
 
-    diff_text = diff_path.read_text(encoding="utf-8", errors="replace")
-
     # Parse labels
     labels = [l.strip() for l in args.labels.split(",") if l.strip()]
 
     # Run gate check
-    result = run_gate_check(diff_text, config, labels)
+    with metrics.timer("gate_check"):
+        result = run_gate_check(
+            diff_text, config, labels, changed_files=changed_files
+        )
+    metrics.incr("files_total", result.get("total_changed_files", 0))
+    metrics.incr("files_reviewable", result.get("reviewable_count", 0))
+    metrics.incr("is_large_pr", 1 if result.get("is_large_pr") else 0)
+
+    # Delta review: when a marker from a previous run records a different
+    # commit, narrow review_files to files changed since that commit so
+    # synchronize pushes only re-do work proportional to the new change.
+    # Prior commits' comments stay untouched — post_review's fingerprint
+    # cache already skips re-posting, and unlisted files simply get no
+    # new findings.  Any failure falls back to a full review.
+    result["review_files"] = result["reviewable_files"]
+    result["is_delta_review"] = False
+    head_sha: Optional[str] = None
+    if args.delta_marker:
+        head_sha = args.head_sha or _resolve_head_sha()
+        last_sha = read_last_reviewed_sha(args.delta_marker)
+        if head_sha and last_sha and last_sha != head_sha:
+            with metrics.timer("delta_diff"):
+                delta = compute_delta_files(last_sha, head_sha)
+            if delta is not None:
+                delta_set = set(delta)
+                result["review_files"] = [
+                    f for f in result["reviewable_files"] if f in delta_set
+                ]
+                result["is_delta_review"] = True
+                result["delta_base_sha"] = last_sha
+                # Re-shard over the narrowed review set so matrix jobs
+                # are balanced for the work actually being done.
+                result["stage3_shards"] = compute_stage3_shards(
+                    result["review_files"], diff_text, config,
+                    result["is_large_pr"],
+                )
+                result["stage3_shard_count"] = len(result["stage3_shards"])
+                print(
+                    f"Delta review: {len(result['review_files'])} of "
+                    f"{result['reviewable_count']} reviewable files "
+                    f"changed since {last_sha[:12]}",
+                    file=sys.stderr,
+                )
+    metrics.incr("files_review", len(result["review_files"]))
+    metrics.incr("is_delta_review", 1 if result["is_delta_review"] else 0)
+
+    # Optionally write the parsed-diff artifact so Stage 1/3 reuse this
+    # parse instead of re-parsing the same diff text.  Requires the
+    # textual diff, so it is unavailable in plumbing mode.
+    if args.parsed_diff_output:
+        if diff_text:
+            with metrics.timer("parse_diff"):
+                parsed = parse_diff(diff_text)
+            # In a delta review, narrow the artifact so Stage 1/3
+            # consumers only see the files under review this run.
+            if result["is_delta_review"]:
+                review_set = set(result["review_files"])
+                parsed = {
+                    k: v for k, v in parsed.items() if k in review_set
+                }
+            save_parsed_diff(parsed, args.parsed_diff_output)
+            print(
+                f"Parsed diff artifact written to: {args.parsed_diff_output}"
+            )
+        else:
+            print(
+                "Warning: --parsed-diff-output requires --diff; skipped.",
+                file=sys.stderr,
+            )
 
     # Output
     output_json = json.dumps(result, ensure_ascii=False, indent=2)
@@ -423,6 +904,14 @@ def main() -> None:
     else:
         print(output_json)
 
+    # Advance the marker only after the result artifacts are written, so
+    # a crashed run does not record its commit as reviewed.
+    if args.delta_marker and head_sha:
+        write_last_reviewed_sha(args.delta_marker, head_sha)
+
+    if args.metrics_output:
+        metrics.save(args.metrics_output)
+
     # Exit code: 0 for normal PR, 0 for large PR (not an error)
     sys.exit(0)
 
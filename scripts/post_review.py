@@ -25,20 +25,34 @@ Usage:
 from __future__ import annotations
 
 import argparse
+import hashlib
 import json
 import os
+import re
 import sys
+from concurrent.futures import ThreadPoolExecutor, as_completed
 from pathlib import Path
-from typing import Any, Dict, List, Optional, Set, Tuple
+from typing import Any, Callable, Dict, List, Optional, Set, Tuple, Union
 
 sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
 
-from scripts.utils.gh_api import GitHubClient
+from scripts.utils.gh_api import GitHubClient, SecondaryRateLimitError
 from scripts.utils.diff_parser import parse_diff
+from scripts.utils.metrics import (
+    StageMetrics,
+    format_metrics_table,
+    load_stage_metrics,
+)
 
 # Maximum number of inline comments per review (GitHub API limit).
 MAX_COMMENTS_PER_REVIEW = 50
 
+# Continuation batches posted in parallel after the summary review.
+# Review creation on GHES is latency-bound (~1.5s per call), not
+# quota-bound, so a small pool is enough; kept low to stay under
+# GitHub's secondary rate limit for concurrent content creation.
+MAX_POST_CONCURRENCY = 4
+
 # Severity ordering for deduplication: higher-severity wins on same file+line.
 _SEVERITY_PRIORITY = {
     "error": 0,
@@ -90,6 +104,67 @@ def load_findings(file_paths: List[str]) -> List[Dict[str, Any]]:
     return all_findings
 
 
+def finding_fingerprint(finding: Dict[str, Any]) -> str:
+    """Build a stable fingerprint hash for a finding.
+
+    Hashes (file, rule_id-or-category, whitespace-normalized message),
+    so the fingerprint survives body formatting tweaks and line shifts.
+    Embedded in comment bodies by :func:`format_comment_body` and used
+    by :func:`filter_already_posted` as the primary dedup key.
+
+    Args:
+        finding: A finding dict.
+
+    Returns:
+        16-char hex fingerprint string.
+    """
+    file = finding.get("file", "")
+    rule_id = finding.get("rule_id") or finding.get("category", "")
+    message = " ".join(str(finding.get("message", "")).split())
+    raw = f"{file}\x00{rule_id}\x00{message}"
+    return hashlib.sha256(raw.encode("utf-8")).hexdigest()[:16]
+
+
+# Invisible marker appended to comment bodies; GitHub renders HTML
+# comments as nothing, so reviewers never see it.
+_FINGERPRINT_MARKER = "<!-- ue-review-bot:fp={fp} -->"
+_FINGERPRINT_RE = re.compile(r"<!-- ue-review-bot:fp=([0-9a-f]{16}) -->")
+
+
+def extract_fingerprint(body: str) -> Optional[str]:
+    """Extract the embedded finding fingerprint from a comment body.
+
+    Args:
+        body: Review comment body (markdown).
+
+    Returns:
+        The fingerprint hex string, or None for bodies without a marker
+        (e.g. comments posted before fingerprints existed, or human
+        comments).
+    """
+    m = _FINGERPRINT_RE.search(body or "")
+    return m.group(1) if m else None
+
+
+def _strip_fingerprint(body: str) -> str:
+    """Remove fingerprint markers from a body for prefix comparison."""
+    return _FINGERPRINT_RE.sub("", body).rstrip()
+
+
+def _dedup_key(finding: Dict[str, Any]) -> Tuple[str, int, str]:
+    """Build the (file, line, rule_id) deduplication key for a finding.
+
+    Stage 1/2 use ``rule_id``; Stage 3 (LLM) uses ``category`` instead.
+    """
+    file = finding.get("file", "")
+    try:
+        line = int(finding.get("line", 0))
+    except (TypeError, ValueError):
+        line = 0
+    rule_id = finding.get("rule_id") or finding.get("category", "")
+    return (file, line, rule_id)
+
+
 def deduplicate_findings(
     findings: List[Dict[str, Any]],
 ) -> List[Dict[str, Any]]:
@@ -110,14 +185,7 @@ def deduplicate_findings(
     seen: Dict[Tuple[str, int, str], Dict[str, Any]] = {}
 
     for finding in findings:
-        file = finding.get("file", "")
-        try:
-            line = int(finding.get("line", 0))
-        except (TypeError, ValueError):
-            line = 0
-        # Stage 1/2 use rule_id; Stage 3 (LLM) uses category instead.
-        rule_id = finding.get("rule_id") or finding.get("category", "")
-        key = (file, line, rule_id)
+        key = _dedup_key(finding)
 
         if key not in seen:
             seen[key] = finding
@@ -264,6 +332,12 @@ def format_comment_body(finding: Dict[str, Any]) -> str:
         parts.append("")
         parts.append(_format_suggestion_block(suggestion))
 
+    # Invisible fingerprint marker for rerun deduplication
+    parts.append("")
+    parts.append(
+        _FINGERPRINT_MARKER.format(fp=finding_fingerprint(finding))
+    )
+
     return "\n".join(parts)
 
 
@@ -323,21 +397,27 @@ def build_review_comments(
 def build_summary(
     findings: List[Dict[str, Any]],
     stages_available: Optional[List[str]] = None,
+    metrics: Optional[List[Dict[str, Any]]] = None,
 ) -> str:
     """Build a summary body for the top-level review comment.
 
     Args:
         findings: List of all findings being posted.
         stages_available: List of stage names that ran (for information).
+        metrics: Optional per-stage timing metrics (loaded via
+            ``load_stage_metrics``); appended as a compact table.
 
     Returns:
         Markdown-formatted summary string.
     """
     if not findings:
-        return (
+        body = (
             "## UE5 Code Review Bot\n\n"
             "No issues found. :white_check_mark:"
         )
+        if metrics:
+            body += "\n\n" + format_metrics_table(metrics)
+        return body
 
     # Count by severity
     counts: Dict[str, int] = {}
@@ -377,6 +457,11 @@ def build_summary(
         lines.append("")
         lines.append(f"*Stages: {', '.join(stages_available)}*")
 
+    # Timing table (when stage metrics artifacts were collected)
+    if metrics:
+        lines.append("")
+        lines.append(format_metrics_table(metrics))
+
     return "\n".join(lines)
 
 
@@ -409,15 +494,17 @@ def filter_already_posted(
 ) -> List[Dict[str, Any]]:
     """Remove comments that already exist on the PR.
 
-    Compares by (path, start_line, line, body_prefix) to avoid reposting
-    the same inline comment on workflow reruns.  Only the first 120
-    characters of the body are compared so that minor formatting tweaks
-    don't defeat the dedup.
+    Comments carrying an embedded fingerprint marker (see
+    :func:`finding_fingerprint`) are compared by (fingerprint, line) —
+    stable under body formatting tweaks, and matched across commits
+    since the fingerprint identifies the finding content itself.
 
-    When *commit_sha* is provided, only existing comments whose
-    ``commit_id`` matches the current HEAD are considered duplicates.
-    Comments left on older commits are ignored so that new findings on
-    updated code are never suppressed after a push.
+    Comments without a marker (posted before fingerprints existed) fall
+    back to the (path, start_line, line, body_prefix) comparison using
+    the first 120 characters of the body.  For that legacy path, when
+    *commit_sha* is provided only existing comments whose ``commit_id``
+    matches the current HEAD are considered duplicates, since stale
+    positions on older commits should not suppress new findings.
 
     Args:
         comments: New review comment dicts to post.
@@ -428,20 +515,31 @@ def filter_already_posted(
         Filtered list of comments not yet posted.
     """
     existing_keys: Set[Tuple[str, Optional[int], int, str]] = set()
+    existing_fps: Set[Tuple[str, int]] = set()
     for ec in existing:
-        # Skip comments from older commits — they may reference stale
-        # positions and should not prevent posting on the current HEAD.
+        line = ec.get("line") or ec.get("original_line") or 0
+        fp = extract_fingerprint(ec.get("body") or "")
+        if fp:
+            existing_fps.add((fp, line))
+            continue
+        # Legacy comments: skip ones from older commits — they may
+        # reference stale positions and should not prevent posting on
+        # the current HEAD.
         if commit_sha and ec.get("commit_id") != commit_sha:
             continue
         path = ec.get("path", "")
-        line = ec.get("line") or ec.get("original_line") or 0
         start_line = ec.get("start_line")  # None for single-line comments
-        body_prefix = (ec.get("body") or "")[:120]
+        body_prefix = _strip_fingerprint(ec.get("body") or "")[:120]
         existing_keys.add((path, start_line, line, body_prefix))
 
     filtered = []
     for c in comments:
-        body_prefix = (c.get("body") or "")[:120]
+        fp = extract_fingerprint(c.get("body") or "")
+        if fp and (fp, c.get("line", 0)) in existing_fps:
+            continue
+        # Markers are stripped before the prefix comparison so new
+        # fingerprinted bodies still match pre-fingerprint comments.
+        body_prefix = _strip_fingerprint(c.get("body") or "")[:120]
         start_line = c.get("start_line")  # None for single-line comments
         key = (c.get("path", ""), start_line, c.get("line", 0), body_prefix)
         if key not in existing_keys:
@@ -459,6 +557,7 @@ def post_review(
     findings: List[Dict[str, Any]],
     stages_available: Optional[List[str]] = None,
     existing_comments: Optional[List[Dict[str, Any]]] = None,
+    metrics: Optional[List[Dict[str, Any]]] = None,
 ) -> List[Dict[str, Any]]:
     """Post findings as a PR review via the GitHub API.
 
@@ -480,12 +579,14 @@ def post_review(
         stages_available: List of stage names that ran.
         existing_comments: Already-posted review comments on this PR
             (from ``GitHubClient.get_existing_review_comments``).
+        metrics: Optional per-stage timing metrics appended to the
+            summary body as a compact table.
 
     Returns:
         List of API response dicts (one per review batch).
         Entries with an ``"error"`` key indicate failed batches.
     """
-    summary = build_summary(findings, stages_available)
+    summary = build_summary(findings, stages_available, metrics=metrics)
     comments = build_review_comments(findings)
 
     # Filter out comments already posted (workflow rerun protection)
@@ -532,16 +633,180 @@ def post_review(
             return [{"error": str(e)}]
 
     batches = split_into_batches(comments)
-    responses = []
+    return _post_batches(
+        client, owner, repo, pr_number, commit_sha, summary, batches
+    )
 
-    for idx, batch in enumerate(batches):
-        if idx == 0:
-            body = summary
-        else:
-            body = (
-                f"## UE5 Code Review Bot (continued {idx + 1}/{len(batches)})"
+
+def _post_batches(
+    client: GitHubClient,
+    owner: str,
+    repo: str,
+    pr_number: int,
+    commit_sha: str,
+    summary: str,
+    batches: List[List[Dict[str, Any]]],
+    concurrency: int = MAX_POST_CONCURRENCY,
+) -> List[Dict[str, Any]]:
+    """Post review batches: summary first, continuations concurrently.
+
+    The first batch carries the summary body and is posted on its own
+    so reviewers see the verdict immediately.  Remaining batches go
+    through a small thread pool.  GitHub's secondary (abuse-detection)
+    rate limit specifically targets concurrent content creation, so any
+    batch that fails with :class:`SecondaryRateLimitError` after the
+    client's own adaptive backoff is re-posted sequentially once the
+    pool has drained.
+
+    Args:
+        client: Authenticated GitHubClient instance.
+        owner: Repository owner.
+        repo: Repository name.
+        pr_number: Pull request number.
+        commit_sha: The HEAD commit SHA of the PR.
+        summary: Summary body for the first batch.
+        batches: Comment batches from split_into_batches().
+        concurrency: Maximum continuation batches posted in parallel.
+
+    Returns:
+        List of API response dicts in batch order.  Entries with an
+        ``"error"`` key indicate failed batches.
+    """
+    total = len(batches)
+    responses: List[Dict[str, Any]] = [{} for _ in range(total)]
+
+    def _post_one(idx: int) -> None:
+        body = (
+            summary
+            if idx == 0
+            else f"## UE5 Code Review Bot (continued {idx + 1}/{total})"
+        )
+        try:
+            responses[idx] = client.create_review(
+                owner=owner,
+                repo=repo,
+                pr_number=pr_number,
+                commit_sha=commit_sha,
+                body=body,
+                comments=batches[idx],
+                event="COMMENT",
+            )
+        except SecondaryRateLimitError:
+            raise
+        except RuntimeError as e:
+            print(
+                f"Error posting review batch {idx + 1}/{total}: {e}",
+                file=sys.stderr,
+            )
+            # Continue with remaining batches
+            responses[idx] = {"error": str(e)}
+
+    sequential_fallback = False
+    try:
+        _post_one(0)
+    except SecondaryRateLimitError as e:
+        print(
+            f"Error posting review batch 1/{total}: {e}",
+            file=sys.stderr,
+        )
+        responses[0] = {"error": str(e)}
+        sequential_fallback = True
+
+    rest = list(range(1, total))
+    retry_indices: List[int] = []
+
+    if sequential_fallback or concurrency <= 1 or len(rest) <= 1:
+        retry_indices = rest
+    elif rest:
+        with ThreadPoolExecutor(
+            max_workers=min(concurrency, len(rest))
+        ) as executor:
+            futures = {executor.submit(_post_one, idx): idx for idx in rest}
+            for future in as_completed(futures):
+                try:
+                    future.result()
+                except SecondaryRateLimitError:
+                    sequential_fallback = True
+                    retry_indices.append(futures[future])
+
+    if sequential_fallback:
+        print(
+            "Secondary rate limit hit; posting remaining batches "
+            "sequentially.",
+            file=sys.stderr,
+        )
+
+    for idx in sorted(retry_indices):
+        try:
+            _post_one(idx)
+        except SecondaryRateLimitError as e:
+            print(
+                f"Error posting review batch {idx + 1}/{total}: {e}",
+                file=sys.stderr,
             )
+            responses[idx] = {"error": str(e)}
+
+    return responses
+
+
+def post_review_streaming(
+    client: GitHubClient,
+    owner: str,
+    repo: str,
+    pr_number: int,
+    commit_sha: str,
+    finding_batches,
+    stages_available: Optional[List[str]] = None,
+    existing_comments: Optional[List[Dict[str, Any]]] = None,
+    batch_size: int = MAX_COMMENTS_PER_REVIEW,
+    metrics: Optional[
+        Union[List[Dict[str, Any]], Callable[[], List[Dict[str, Any]]]]
+    ] = None,
+) -> List[Dict[str, Any]]:
+    """Post findings as they arrive instead of after all stages finish.
+
+    Pipelined variant of :func:`post_review`: *finding_batches* is an
+    iterable of finding lists (e.g. a generator fed by Stage 3's
+    ``review_pr(on_findings=...)`` hook through a queue), so the first
+    review batch is posted while later files are still being reviewed
+    and reviewers are not gated on the slowest file.
+
+    An interim review is posted each time *batch_size* comments have
+    accumulated.  Because totals are only known at the end, the summary
+    review is posted last, together with any remaining comments.
+    Duplicates on the same (file, line, rule) key are dropped
+    first-wins as the stream arrives — the severity-upgrade rule of
+    :func:`deduplicate_findings` cannot apply once a comment has
+    already been published.
+
+    Args:
+        client: Authenticated GitHubClient instance.
+        owner: Repository owner.
+        repo: Repository name.
+        pr_number: Pull request number.
+        commit_sha: The HEAD commit SHA of the PR.
+        finding_batches: Iterable of finding lists.
+        stages_available: List of stage names that ran.
+        existing_comments: Already-posted review comments on this PR.
+        batch_size: Maximum comments per interim review.
+        metrics: Optional per-stage timing metrics appended to the
+            closing summary body. May be a zero-argument callable,
+            evaluated only when the closing summary is built — by then
+            the streamed stages have finished and their timings are
+            complete.
+
+    Returns:
+        List of API response dicts (interim batches first, summary
+        review last).  Entries with an ``"error"`` key indicate failed
+        batches.
+    """
+    all_findings: List[Dict[str, Any]] = []
+    seen_keys: Set[Tuple[str, int, str]] = set()
+    pending: List[Dict[str, Any]] = []
+    responses: List[Dict[str, Any]] = []
+    interim_count = 0
 
+    def _post(body: str, batch: List[Dict[str, Any]]) -> None:
         try:
             resp = client.create_review(
                 owner=owner,
@@ -555,12 +820,38 @@ def post_review(
             responses.append(resp)
         except RuntimeError as e:
             print(
-                f"Error posting review batch {idx + 1}/{len(batches)}: {e}",
+                f"Error posting streamed review batch: {e}",
                 file=sys.stderr,
             )
-            # Continue with remaining batches
             responses.append({"error": str(e)})
 
+    for batch_findings in finding_batches:
+        for finding in batch_findings:
+            key = _dedup_key(finding)
+            if key in seen_keys:
+                continue
+            seen_keys.add(key)
+            all_findings.append(finding)
+            comments = build_review_comments([finding])
+            if existing_comments:
+                comments = filter_already_posted(
+                    comments, existing_comments, commit_sha
+                )
+            pending.extend(comments)
+
+        while len(pending) >= batch_size:
+            interim_count += 1
+            _post(
+                f"## UE5 Code Review Bot (streaming batch {interim_count})",
+                pending[:batch_size],
+            )
+            pending = pending[batch_size:]
+
+    # Closing review: full summary plus any leftover comments.
+    metrics_list = metrics() if callable(metrics) else metrics
+    summary = build_summary(all_findings, stages_available, metrics=metrics_list)
+    _post(summary, pending)
+
     return responses
 
 
@@ -615,6 +906,33 @@ def main() -> None:
         default=None,
         help="Output JSON file for review payload/result (default: stdout)",
     )
+    parser.add_argument(
+        "--comment-cache",
+        default=None,
+        help=(
+            "JSON cache file for existing review comments. Reruns probe "
+            "with a conditional (ETag) request and skip re-downloading "
+            "unchanged comment pages."
+        ),
+    )
+    parser.add_argument(
+        "--metrics",
+        nargs="*",
+        default=[],
+        help=(
+            "Per-stage metrics JSON files (written by the stage "
+            "scripts' --metrics-output). Appended to the review "
+            "summary as a timing table."
+        ),
+    )
+    parser.add_argument(
+        "--metrics-output",
+        default=None,
+        help=(
+            "Path for the aggregated metrics artifact (all stage "
+            "metrics plus this step's own timings)"
+        ),
+    )
     parser.add_argument(
         "--dry-run",
         action="store_true",
@@ -623,9 +941,13 @@ def main() -> None:
 
     args = parser.parse_args()
 
+    pr_metrics = StageMetrics("post-review")
+    stage_metrics = load_stage_metrics(args.metrics) if args.metrics else []
+
     # Load and process findings
-    findings = load_findings(args.findings)
-    findings = deduplicate_findings(findings)
+    with pr_metrics.timer("process_findings"):
+        findings = load_findings(args.findings)
+        findings = deduplicate_findings(findings)
 
     # Filter out findings on lines not in the PR diff (prevents 422 from
     # the GitHub Review API which only accepts comments on diff hunks).
@@ -654,9 +976,19 @@ def main() -> None:
 
     stages = args.stages.split(",") if args.stages else None
 
+    def _save_aggregated_metrics() -> None:
+        # One artifact holding every stage's metrics plus this step's.
+        if not args.metrics_output:
+            return
+        aggregated = {"stages": stage_metrics + [pr_metrics.finish()]}
+        Path(args.metrics_output).write_text(
+            json.dumps(aggregated, ensure_ascii=False, indent=2) + "\n",
+            encoding="utf-8",
+        )
+
     if args.dry_run:
         # Dry-run: build payload and output without API calls
-        summary = build_summary(findings, stages)
+        summary = build_summary(findings, stages, metrics=stage_metrics)
         comments = build_review_comments(findings)
         payload = {
             "summary": summary,
@@ -678,6 +1010,9 @@ def main() -> None:
         else:
             print(output_json)
 
+        pr_metrics.incr("findings", len(findings))
+        pr_metrics.incr("comments", len(comments))
+        _save_aggregated_metrics()
         sys.exit(0)
 
     # Validate required args for posting
@@ -717,17 +1052,31 @@ def main() -> None:
         sys.exit(1)
     owner, repo = repo_parts
 
-    # Resolve commit SHA
+    client = GitHubClient(token=token, api_url=api_url)
+
+    # One GraphQL round-trip covers the head SHA and review comments.
+    # Skipped when a comment cache is in play — its conditional ETag
+    # probe is already a single cheap request — and the REST methods
+    # remain the fallback when GraphQL is unavailable.
     commit_sha = args.commit_sha
+    pr_context: Optional[Dict[str, Any]] = None
+    if not commit_sha or not args.comment_cache:
+        pr_context = client.get_pr_context(owner, repo, args.pr_number)
+
+    # Resolve commit SHA
     if not commit_sha:
-        # Try to fetch from PR metadata
-        client = GitHubClient(token=token, api_url=api_url)
-        try:
-            pr_data = client.get_pull_request(owner, repo, args.pr_number)
-            commit_sha = pr_data.get("head", {}).get("sha", "")
-        except RuntimeError as e:
-            print(f"Error: Could not determine commit SHA: {e}", file=sys.stderr)
-            sys.exit(1)
+        if pr_context and pr_context.get("head_sha"):
+            commit_sha = pr_context["head_sha"]
+        else:
+            try:
+                pr_data = client.get_pull_request(owner, repo, args.pr_number)
+                commit_sha = pr_data.get("head", {}).get("sha", "")
+            except RuntimeError as e:
+                print(
+                    f"Error: Could not determine commit SHA: {e}",
+                    file=sys.stderr,
+                )
+                sys.exit(1)
 
     if not commit_sha:
         print(
@@ -737,30 +1086,38 @@ def main() -> None:
         sys.exit(1)
 
     # Fetch existing comments to avoid duplicates on reruns
-    client = GitHubClient(token=token, api_url=api_url)
     existing_comments: List[Dict[str, Any]] = []
-    try:
-        existing_comments = client.get_existing_review_comments(
-            owner, repo, args.pr_number
-        )
-    except RuntimeError as e:
-        print(
-            f"Warning: Could not fetch existing comments "
-            f"(duplicate prevention disabled): {e}",
-            file=sys.stderr,
-        )
+    if (
+        not args.comment_cache
+        and pr_context is not None
+        and pr_context.get("review_comments") is not None
+    ):
+        existing_comments = pr_context["review_comments"]
+    else:
+        try:
+            existing_comments = client.get_existing_review_comments(
+                owner, repo, args.pr_number, cache_path=args.comment_cache
+            )
+        except RuntimeError as e:
+            print(
+                f"Warning: Could not fetch existing comments "
+                f"(duplicate prevention disabled): {e}",
+                file=sys.stderr,
+            )
 
     # Post review
-    responses = post_review(
-        client=client,
-        owner=owner,
-        repo=repo,
-        pr_number=args.pr_number,
-        commit_sha=commit_sha,
-        findings=findings,
-        stages_available=stages,
-        existing_comments=existing_comments,
-    )
+    with pr_metrics.timer("github_post"):
+        responses = post_review(
+            client=client,
+            owner=owner,
+            repo=repo,
+            pr_number=args.pr_number,
+            commit_sha=commit_sha,
+            findings=findings,
+            stages_available=stages,
+            existing_comments=existing_comments,
+            metrics=stage_metrics,
+        )
 
     # Output result
     failed = sum(1 for r in responses if "error" in r)
@@ -786,6 +1143,12 @@ def main() -> None:
     else:
         print(output_json)
 
+    pr_metrics.incr("findings", len(findings))
+    pr_metrics.incr("comments", result["total_comments"])
+    pr_metrics.incr("reviews_posted", succeeded)
+    pr_metrics.incr("github_api_calls", getattr(client, "request_count", 0))
+    _save_aggregated_metrics()
+
     # Exit non-zero if ALL batches failed — CI should not be green
     # when no review was actually published.
     if failed > 0 and succeeded == 0:
@@ -0,0 +1,629 @@
+#!/usr/bin/env python3
+"""Single-job pipeline driver — all review stages in one process.
+
+The multi-job workflows (gate → stage1 → stage2 → stage3 → post) pay
+job-scheduling latency, repeated checkouts, and repeated tool installs
+at every stage boundary.  This driver runs the same pipeline in-process,
+passing findings between stages as Python objects instead of JSON
+artifact files, so small PRs — the common case — are reviewed in one
+job with zero hand-off overhead.
+
+Gate rules are unchanged: large PRs skip Stage 3 exactly as in the
+multi-job layout, and Stage 2 only runs when compile_commands.json and
+clang-tidy are available.  Stage 3 findings are handed to
+``post_review_streaming()`` through ``review_pr()``'s ``on_findings``
+hook, so the first review comments are published while later files are
+still being reviewed.
+"""
+
+import argparse
+import json
+import os
+import queue
+import sys
+import threading
+from concurrent.futures import ThreadPoolExecutor
+from pathlib import Path
+from typing import Any, Dict, Iterator, List, Optional, Set, Tuple
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
+
+from scripts.gate_checker import (
+    determine_allowed_stages,
+    load_config,
+    run_gate_check,
+)
+from scripts.post_review import (
+    build_review_comments,
+    build_summary,
+    deduplicate_findings,
+    filter_findings_by_diff,
+    post_review,
+    post_review_streaming,
+)
+from scripts.stage1_format_diff import find_clang_format, process_file
+from scripts.stage1_pattern_checker import check_diff, load_tier1_patterns
+from scripts.stage2_tidy_runner import (
+    find_clang_tidy,
+    merge_fixes_yaml,
+    run_parallel,
+)
+from scripts.stage2_tidy_to_suggestions import (
+    _collect_source_contents,
+    convert_diagnostics,
+    deduplicate,
+    parse_tidy_fixes_text,
+)
+from scripts.stage3_llm_reviewer import drain_api_latencies, review_pr
+from scripts.utils.diff_parser import FileDiff, get_added_line_numbers, parse_diff
+from scripts.utils.gh_api import GitHubClient
+from scripts.utils.metrics import StageMetrics
+from scripts.utils.tidy_cache import TidyCache
+
+# Sentinel marking the end of the Stage 3 findings stream.
+_STREAM_END = object()
+
+
+def run_stage1(
+    diff_data: Dict[str, FileDiff],
+    reviewable_files: List[str],
+    checklist_path: str,
+    clang_format_config: str,
+    jobs: Optional[int] = None,
+    checklist_cache: Optional[str] = None,
+) -> List[Dict[str, Any]]:
+    """Run the Stage 1 pattern and format checkers in-process.
+
+    Args:
+        diff_data: Parsed diff data shared across stages.
+        reviewable_files: Reviewable file list from the gate.
+        checklist_path: Path to checklist.yml.
+        clang_format_config: Path to the .clang-format config.
+        jobs: Parallel clang-format processes (default: CPU count).
+        checklist_cache: Optional compiled-checklist cache artifact
+            path; skips re-parsing the checklist YAML when valid.
+
+    Returns:
+        Combined Stage 1 findings (pattern + format).
+    """
+    patterns = load_tier1_patterns(checklist_path, cache_path=checklist_cache)
+    findings = check_diff(diff_data, patterns)
+
+    clang_format_bin = find_clang_format()
+    if clang_format_bin is None:
+        print(
+            "Warning: clang-format not found. Skipping format checking.",
+            file=sys.stderr,
+        )
+        return findings
+
+    work: List[Tuple[str, Set[int]]] = [
+        (fp, get_added_line_numbers(diff_data, fp)) for fp in reviewable_files
+    ]
+    max_workers = max(1, jobs or os.cpu_count() or 1)
+    max_workers = min(max_workers, len(work)) if work else 1
+
+    with ThreadPoolExecutor(max_workers=max_workers) as executor:
+        futures = [
+            executor.submit(
+                process_file,
+                file_path,
+                added,
+                config_path=clang_format_config,
+                clang_format_bin=clang_format_bin,
+            )
+            for file_path, added in work
+        ]
+        for future in futures:
+            findings.extend(future.result())
+
+    return findings
+
+
+def find_compile_commands(build_dir: Optional[str] = None) -> Optional[str]:
+    """Locate compile_commands.json like the gate job's check_cc step.
+
+    Args:
+        build_dir: Explicit build directory to check first.
+
+    Returns:
+        Directory containing compile_commands.json, or None.
+    """
+    candidates = [build_dir] if build_dir else [".", "build"]
+    for candidate in candidates:
+        if candidate and (Path(candidate) / "compile_commands.json").is_file():
+            return candidate
+    return None
+
+
+def run_stage2(
+    reviewable_files: List[str],
+    stage1_findings: List[Dict[str, Any]],
+    build_dir: str,
+    tidy_config: Optional[str] = None,
+    source_dir: Optional[str] = None,
+    tidy_cache_dir: Optional[str] = None,
+    jobs: Optional[int] = None,
+) -> List[Dict[str, Any]]:
+    """Run clang-tidy and convert diagnostics in-process.
+
+    The merged fixes YAML goes straight from the runner to
+    :func:`parse_tidy_fixes_text` — no tidy-fixes.yaml artifact.
+
+    Args:
+        reviewable_files: Reviewable file list from the gate.
+        stage1_findings: Stage 1 findings for overlap deduplication.
+        build_dir: Directory containing compile_commands.json.
+        tidy_config: Path to the .clang-tidy config file.
+        source_dir: Source directory for path resolution.
+        tidy_cache_dir: Optional incremental tidy cache directory.
+        jobs: clang-tidy worker count (default: CPU count).
+
+    Returns:
+        Stage 2 findings with Stage 1 overlaps removed.
+    """
+    cache = TidyCache(tidy_cache_dir) if tidy_cache_dir else None
+    results = run_parallel(
+        reviewable_files,
+        build_dir,
+        config_file=tidy_config,
+        jobs=jobs,
+        cache=cache,
+    )
+    diagnostics = parse_tidy_fixes_text(merge_fixes_yaml(results))
+    source_contents, path_map = _collect_source_contents(diagnostics, source_dir)
+    findings = convert_diagnostics(
+        diagnostics,
+        source_contents=source_contents,
+        build_dir=build_dir,
+        path_map=path_map,
+    )
+    return deduplicate(findings, stage1_findings)
+
+
+def _finding_batches(
+    early_findings: List[Dict[str, Any]],
+    batch_queue: "queue.Queue",
+    diff_text: str,
+) -> Iterator[List[Dict[str, Any]]]:
+    """Yield finding batches for post_review_streaming.
+
+    Stage 1/2 findings go out first; Stage 3 batches follow as review
+    units complete.  Every batch is hunk-filtered so the Review API
+    never sees comments outside the diff.
+
+    Args:
+        early_findings: Deduplicated Stage 1/2 findings.
+        batch_queue: Queue fed by review_pr's on_findings hook.
+        diff_text: Raw diff text for hunk filtering.
+
+    Yields:
+        Finding lists ready for posting.
+    """
+    if early_findings:
+        yield filter_findings_by_diff(early_findings, diff_text)
+    while True:
+        batch = batch_queue.get()
+        if batch is _STREAM_END:
+            return
+        if batch:
+            yield filter_findings_by_diff(batch, diff_text)
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(
+        description="Single-job review pipeline — gate to post in one process"
+    )
+    parser.add_argument(
+        "--diff",
+        required=True,
+        help="Path to PR unified diff file",
+    )
+    parser.add_argument(
+        "--config",
+        default="configs/gate_config.yml",
+        help="Path to gate_config.yml (default: configs/gate_config.yml)",
+    )
+    parser.add_argument(
+        "--checklist",
+        default="configs/checklist.yml",
+        help="Path to checklist.yml (default: configs/checklist.yml)",
+    )
+    parser.add_argument(
+        "--checklist-cache",
+        default=None,
+        help=(
+            "Path to a compiled-checklist cache artifact (see "
+            "scripts/utils/checklist_cache.py); skips re-parsing the "
+            "checklist YAML when valid"
+        ),
+    )
+    parser.add_argument(
+        "--clang-format-config",
+        default="configs/.clang-format",
+        help="Path to .clang-format config (default: configs/.clang-format)",
+    )
+    parser.add_argument(
+        "--clang-tidy-config",
+        default="configs/.clang-tidy",
+        help="Path to .clang-tidy config (default: configs/.clang-tidy)",
+    )
+    parser.add_argument(
+        "--labels",
+        default="",
+        help="Comma-separated PR labels",
+    )
+    parser.add_argument(
+        "--build-dir",
+        default=None,
+        help="Directory containing compile_commands.json (default: auto-detect)",
+    )
+    parser.add_argument(
+        "--source-dir",
+        default=".",
+        help="Path to the source directory (default: current directory)",
+    )
+    parser.add_argument(
+        "--jobs",
+        type=int,
+        default=None,
+        help="Parallel clang-format/clang-tidy workers (default: CPU count)",
+    )
+    parser.add_argument(
+        "--review-cache-dir",
+        default=None,
+        help="Directory for the persistent Stage 3 review cache",
+    )
+    parser.add_argument(
+        "--tidy-cache-dir",
+        default=None,
+        help="Directory for the incremental clang-tidy cache",
+    )
+    parser.add_argument(
+        "--pr-number",
+        type=int,
+        help="Pull request number",
+    )
+    parser.add_argument(
+        "--repo",
+        help="Repository in owner/repo format",
+    )
+    parser.add_argument(
+        "--commit-sha",
+        help="HEAD commit SHA of the PR",
+    )
+    parser.add_argument(
+        "--token",
+        default=None,
+        help="GitHub token (default: $GIT_ACTION_TOKEN or $GITHUB_TOKEN env)",
+    )
+    parser.add_argument(
+        "--api-url",
+        default=None,
+        help=(
+            "GitHub API base URL "
+            "(default: $GHES_URL/api/v3 or https://api.github.com)"
+        ),
+    )
+    parser.add_argument(
+        "--comment-cache",
+        default=None,
+        help="JSON cache file for existing review comments (ETag probe)",
+    )
+    parser.add_argument(
+        "--output",
+        default=None,
+        help="Output JSON file for pipeline result (default: stdout)",
+    )
+    parser.add_argument(
+        "--metrics-output",
+        default=None,
+        help="Optional path for a structured timing-metrics JSON artifact",
+    )
+    parser.add_argument(
+        "--dry-run",
+        action="store_true",
+        help="Run all stages but build the review payload without posting",
+    )
+
+    args = parser.parse_args()
+
+    metrics = StageMetrics("pipeline")
+    drain_api_latencies()  # discard samples from any earlier in-process use
+
+    def _snapshot_metrics() -> List[Dict[str, Any]]:
+        # Fold any pending API-call latencies in, then snapshot.
+        for latency in drain_api_latencies():
+            metrics.add_timing("api_call", latency)
+        return [metrics.finish()]
+
+    diff_path = Path(args.diff)
+    if not diff_path.exists():
+        print(f"Error: Diff file not found: {args.diff}", file=sys.stderr)
+        sys.exit(1)
+    diff_text = diff_path.read_text(encoding="utf-8", errors="replace")
+
+    # Parse once; every stage shares the same parsed diff object.
+    with metrics.timer("parse_diff"):
+        diff_data = parse_diff(diff_text)
+
+    # --- Gate ---------------------------------------------------------
+    config = load_config(args.config)
+    labels = [l.strip() for l in args.labels.split(",") if l.strip()]
+    with metrics.timer("gate"):
+        gate_result = run_gate_check(
+            diff_text, config, labels, changed_files=list(diff_data.keys())
+        )
+    is_large = gate_result["is_large_pr"]
+    reviewable_files = gate_result["reviewable_files"]
+    allowed_stages, _ = determine_allowed_stages(is_large)
+    print(
+        f"Gate: {len(reviewable_files)} reviewable files, "
+        f"large_pr={is_large}, stages={allowed_stages}"
+    )
+
+    stages_available = ["stage1"]
+
+    # --- Stage 1 ------------------------------------------------------
+    with metrics.timer("stage1"):
+        stage1_findings = run_stage1(
+            diff_data,
+            reviewable_files,
+            args.checklist,
+            args.clang_format_config,
+            jobs=args.jobs,
+            checklist_cache=args.checklist_cache,
+        )
+    print(f"Stage 1: {len(stage1_findings)} findings")
+
+    # --- Stage 2 (conditional) ----------------------------------------
+    stage2_findings: List[Dict[str, Any]] = []
+    build_dir = find_compile_commands(args.build_dir)
+    if 2 in allowed_stages and build_dir and find_clang_tidy():
+        with metrics.timer("stage2"):
+            stage2_findings = run_stage2(
+                reviewable_files,
+                stage1_findings,
+                build_dir,
+                tidy_config=args.clang_tidy_config,
+                source_dir=args.source_dir,
+                tidy_cache_dir=args.tidy_cache_dir,
+                jobs=args.jobs,
+            )
+        stages_available.append("stage2")
+        print(f"Stage 2: {len(stage2_findings)} findings")
+    else:
+        print(
+            "Stage 2 skipped (no compile_commands.json or clang-tidy).",
+            file=sys.stderr,
+        )
+
+    early_findings = deduplicate_findings(stage1_findings + stage2_findings)
+
+    # --- Stage 3 + posting --------------------------------------------
+    run_stage3 = 3 in allowed_stages and bool(
+        os.environ.get("ANTHROPIC_API_KEY")
+    )
+    if 3 in allowed_stages and not run_stage3:
+        print(
+            "Stage 3 skipped (ANTHROPIC_API_KEY not set).",
+            file=sys.stderr,
+        )
+
+    result: Dict[str, Any] = {
+        "gate": {
+            "is_large_pr": is_large,
+            "reviewable_files": reviewable_files,
+        },
+        "stage1_findings": len(stage1_findings),
+        "stage2_findings": len(stage2_findings),
+    }
+
+    if args.dry_run:
+        # Dry-run: run Stage 3 (if allowed) and build the payload
+        # without touching the GitHub API.
+        stage3_findings: List[Dict[str, Any]] = []
+        if run_stage3:
+            with metrics.timer("stage3_review"):
+                stage3_findings, summary = review_pr(
+                    diff_text,
+                    has_compile_commands=build_dir is not None,
+                    source_dir=args.source_dir,
+                    cache_dir=args.review_cache_dir,
+                    batch_small_files=True,
+                    parsed_diff=diff_data,
+                    exclude_findings=early_findings,
+                )
+            result["stage3_budget"] = summary
+            stages_available.append("stage3")
+        findings = deduplicate_findings(early_findings + stage3_findings)
+        findings = filter_findings_by_diff(findings, diff_text)
+        result.update(
+            {
+                "stage3_findings": len(stage3_findings),
+                "total_findings": len(findings),
+                "summary": build_summary(
+                    findings, stages_available, metrics=_snapshot_metrics()
+                ),
+                "comments": build_review_comments(findings),
+            }
+        )
+        _write_result(result, args.output, dry_run=True)
+        if args.metrics_output:
+            metrics.save(args.metrics_output)
+        sys.exit(0)
+
+    # Posting path — validate GitHub arguments.
+    for name, value in (
+        ("--pr-number", args.pr_number),
+        ("--repo", args.repo),
+        ("--commit-sha", args.commit_sha),
+    ):
+        if not value:
+            print(f"Error: {name} is required (unless --dry-run)", file=sys.stderr)
+            sys.exit(1)
+
+    token = (
+        args.token
+        or os.environ.get("GIT_ACTION_TOKEN")
+        or os.environ.get("GITHUB_TOKEN")
+    )
+    if not token:
+        print(
+            "Error: No token provided. Use --token or set "
+            "GIT_ACTION_TOKEN / GITHUB_TOKEN environment variable.",
+            file=sys.stderr,
+        )
+        sys.exit(1)
+
+    api_url = args.api_url
+    if not api_url:
+        ghes_url = os.environ.get("GHES_URL")
+        api_url = (
+            f"{ghes_url.rstrip('/')}/api/v3"
+            if ghes_url
+            else "https://api.github.com"
+        )
+
+    owner, _, repo = args.repo.partition("/")
+    if not owner or not repo:
+        print(
+            f"Error: --repo must be in owner/repo format, got: {args.repo}",
+            file=sys.stderr,
+        )
+        sys.exit(1)
+
+    client = GitHubClient(token=token, api_url=api_url)
+    existing_comments: List[Dict[str, Any]] = []
+    # Single GraphQL round-trip when no comment cache is configured;
+    # the REST pagination path remains the fallback (and handles PRs
+    # whose comments exceed one GraphQL page).
+    pr_context = (
+        client.get_pr_context(owner, repo, args.pr_number)
+        if not args.comment_cache
+        else None
+    )
+    if pr_context is not None and pr_context.get("review_comments") is not None:
+        existing_comments = pr_context["review_comments"]
+    else:
+        try:
+            existing_comments = client.get_existing_review_comments(
+                owner, repo, args.pr_number, cache_path=args.comment_cache
+            )
+        except RuntimeError as e:
+            print(
+                f"Warning: Could not fetch existing comments "
+                f"(duplicate prevention disabled): {e}",
+                file=sys.stderr,
+            )
+
+    if run_stage3:
+        # Pipelined: Stage 3 review units stream into the poster as
+        # they complete, so the first comments appear while later
+        # files are still in review.
+        batch_queue: "queue.Queue" = queue.Queue()
+        stage3_result: Dict[str, Any] = {}
+
+        def _run_review() -> None:
+            try:
+                with metrics.timer("stage3_review"):
+                    findings3, summary = review_pr(
+                        diff_text,
+                        has_compile_commands=build_dir is not None,
+                        source_dir=args.source_dir,
+                        cache_dir=args.review_cache_dir,
+                        batch_small_files=True,
+                        on_findings=batch_queue.put,
+                        parsed_diff=diff_data,
+                        exclude_findings=early_findings,
+                    )
+                stage3_result["findings"] = findings3
+                stage3_result["summary"] = summary
+            except Exception as e:  # noqa: BLE001 — surface, don't hang
+                print(f"Error: Stage 3 review failed: {e}", file=sys.stderr)
+                stage3_result["error"] = str(e)
+            finally:
+                batch_queue.put(_STREAM_END)
+
+        stages_available.append("stage3")
+        reviewer = threading.Thread(target=_run_review, daemon=True)
+        reviewer.start()
+        responses = post_review_streaming(
+            client=client,
+            owner=owner,
+            repo=repo,
+            pr_number=args.pr_number,
+            commit_sha=args.commit_sha,
+            finding_batches=_finding_batches(
+                early_findings, batch_queue, diff_text
+            ),
+            stages_available=stages_available,
+            existing_comments=existing_comments,
+            # Evaluated when the closing summary is built — after the
+            # reviewer thread has streamed its last batch, so the
+            # stage3 timing and API latencies are complete.
+            metrics=_snapshot_metrics,
+        )
+        reviewer.join()
+        result["stage3_findings"] = len(stage3_result.get("findings", []))
+        if "summary" in stage3_result:
+            result["stage3_budget"] = stage3_result["summary"]
+    else:
+        findings = filter_findings_by_diff(early_findings, diff_text)
+        responses = post_review(
+            client=client,
+            owner=owner,
+            repo=repo,
+            pr_number=args.pr_number,
+            commit_sha=args.commit_sha,
+            findings=findings,
+            stages_available=stages_available,
+            existing_comments=existing_comments,
+            metrics=_snapshot_metrics(),
+        )
+        result["stage3_findings"] = 0
+
+    failed = sum(1 for r in responses if "error" in r)
+    succeeded = len(responses) - failed
+    result.update(
+        {
+            "reviews_posted": succeeded,
+            "reviews_failed": failed,
+            "responses": responses,
+        }
+    )
+    _write_result(result, args.output, dry_run=False)
+
+    if args.metrics_output:
+        metrics.incr("github_api_calls", getattr(client, "request_count", 0))
+        _snapshot_metrics()
+        metrics.save(args.metrics_output)
+
+    # Exit non-zero if ALL batches failed — CI should not be green
+    # when no review was actually published.
+    if failed > 0 and succeeded == 0:
+        print(
+            "Error: All review batches failed. No review was posted.",
+            file=sys.stderr,
+        )
+        sys.exit(1)
+    sys.exit(0)
+
+
+def _write_result(
+    result: Dict[str, Any],
+    output_path: Optional[str],
+    dry_run: bool,
+) -> None:
+    """Write the pipeline result JSON to file or stdout."""
+    output_json = json.dumps(result, ensure_ascii=False, indent=2)
+    if output_path:
+        Path(output_path).write_text(output_json + "\n", encoding="utf-8")
+        mode = "Dry-run" if dry_run else "Pipeline"
+        print(f"{mode} result written to: {output_path}")
+    else:
+        print(output_json)
+
+
+if __name__ == "__main__":
+    main()
@@ -21,19 +21,28 @@ from __future__ import annotations
 import argparse
 import difflib
 import json
+import os
 import shutil
 import subprocess
 import sys
+import time
+from concurrent.futures import ThreadPoolExecutor
 from pathlib import Path
-from typing import Any, Dict, List, Optional, Set
+from typing import Any, Dict, List, Optional, Set, Tuple
 
 sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
 
 from scripts.utils.diff_parser import get_added_line_numbers, parse_diff
+from scripts.utils.metrics import StageMetrics
 
 # Maximum lines per suggestion block
 MAX_SUGGESTION_LINES = 20
 
+# Ranges separated by at most this many untouched lines are merged into
+# one --lines argument. clang-format may extend a reformat to the whole
+# enclosing statement anyway, so tiny gaps are not worth separate ranges.
+RANGE_MERGE_GAP = 2
+
 
 def find_clang_format() -> Optional[str]:
     """Find clang-format executable.
@@ -44,10 +53,41 @@ def find_clang_format() -> Optional[str]:
     return shutil.which("clang-format")
 
 
+def added_lines_to_ranges(
+    added_lines: Set[int], merge_gap: int = RANGE_MERGE_GAP
+) -> List[Tuple[int, int]]:
+    """Collapse a set of line numbers into sorted (start, end) ranges.
+
+    Consecutive lines and lines separated by at most *merge_gap*
+    untouched lines are merged into a single inclusive range, so a PR
+    hunk produces one ``--lines`` argument instead of one per line.
+
+    Args:
+        added_lines: Set of 1-based line numbers from the PR diff.
+        merge_gap: Maximum gap between lines that still merges.
+
+    Returns:
+        Sorted list of (start, end) tuples, 1-based inclusive.
+    """
+    if not added_lines:
+        return []
+
+    ordered = sorted(added_lines)
+    ranges = [[ordered[0], ordered[0]]]
+    for line in ordered[1:]:
+        if line - ranges[-1][1] <= merge_gap + 1:
+            ranges[-1][1] = line
+        else:
+            ranges.append([line, line])
+
+    return [(start, end) for start, end in ranges]
+
+
 def run_clang_format(
     file_path: str,
     config_path: Optional[str] = None,
     clang_format_bin: Optional[str] = None,
+    line_ranges: Optional[List[Tuple[int, int]]] = None,
 ) -> Optional[str]:
     """Run clang-format on a file and return the formatted content.
 
@@ -55,6 +95,9 @@ def run_clang_format(
         file_path: Path to the source file.
         config_path: Path to .clang-format config file.
         clang_format_bin: Path to clang-format binary (auto-detected if None).
+        line_ranges: Optional (start, end) ranges to restrict formatting
+            to (1-based inclusive, passed as ``--lines``). When None the
+            whole file is formatted.
 
     Returns:
         Formatted file content as string, or None if clang-format failed.
@@ -67,6 +110,9 @@ def run_clang_format(
     if config_path:
         cmd.append(f"--style=file:{config_path}")
 
+    for start, end in line_ranges or []:
+        cmd.append(f"--lines={start}:{end}")
+
     cmd.append(file_path)
 
     try:
@@ -88,6 +134,68 @@ def run_clang_format(
         return None
 
 
+def _common_affix_lengths(
+    original_lines: List[str],
+    formatted_lines: List[str],
+) -> Tuple[int, int]:
+    """Lengths of the shared line prefix and suffix of the two files.
+
+    clang-format changes are usually local, so most lines match at both
+    ends; anchoring on them shrinks the SequenceMatcher window to the
+    actually-differing middle.  The suffix scan stops before the prefix
+    so the two never overlap.
+
+    Args:
+        original_lines: Lines of the original file.
+        formatted_lines: Lines of the formatted file.
+
+    Returns:
+        Tuple of (prefix_length, suffix_length).
+    """
+    n, m = len(original_lines), len(formatted_lines)
+    limit = min(n, m)
+
+    prefix = 0
+    while prefix < limit and original_lines[prefix] == formatted_lines[prefix]:
+        prefix += 1
+
+    suffix = 0
+    while (
+        suffix < limit - prefix
+        and original_lines[n - 1 - suffix] == formatted_lines[m - 1 - suffix]
+    ):
+        suffix += 1
+
+    return prefix, suffix
+
+
+def _intern_lines(
+    original_lines: List[str],
+    formatted_lines: List[str],
+) -> Tuple[List[int], List[int]]:
+    """Map lines to small integers for cheaper SequenceMatcher compares.
+
+    Identical lines share an id, so element equality inside the matcher
+    becomes an int compare instead of a string compare.  The mapping is
+    bijective per call, so match results are unchanged.
+
+    Args:
+        original_lines: Lines of the original file (or a slice of it).
+        formatted_lines: Lines of the formatted file (or a slice of it).
+
+    Returns:
+        Tuple of (original_ids, formatted_ids).
+    """
+    table: Dict[str, int] = {}
+    original_ids = [
+        table.setdefault(line, len(table)) for line in original_lines
+    ]
+    formatted_ids = [
+        table.setdefault(line, len(table)) for line in formatted_lines
+    ]
+    return original_ids, formatted_ids
+
+
 def _compute_diff_regions(
     original_lines: List[str],
     formatted_lines: List[str],
@@ -95,6 +203,10 @@ def _compute_diff_regions(
     """Compute regions where original and formatted content differ.
 
     Uses difflib.SequenceMatcher to find contiguous blocks of changes.
+    The comparison window is first shrunk to the lines between the
+    common prefix and suffix, and lines are interned to integer ids, so
+    large files with local formatting differences cost little beyond
+    the two anchor scans.
 
     Args:
         original_lines: Lines of the original file.
@@ -104,13 +216,30 @@ def _compute_diff_regions(
         List of dicts with 'start_line' (1-based), 'end_line' (1-based,
         inclusive), 'original' (list of lines), 'formatted' (list of lines).
     """
-    matcher = difflib.SequenceMatcher(None, original_lines, formatted_lines)
+    prefix, suffix = _common_affix_lengths(original_lines, formatted_lines)
+    if (
+        prefix == len(original_lines)
+        and len(original_lines) == len(formatted_lines)
+    ):
+        return []
+
+    original_ids, formatted_ids = _intern_lines(
+        original_lines[prefix:len(original_lines) - suffix],
+        formatted_lines[prefix:len(formatted_lines) - suffix],
+    )
+    matcher = difflib.SequenceMatcher(None, original_ids, formatted_ids)
     regions = []
 
     for tag, i1, i2, j1, j2 in matcher.get_opcodes():
         if tag == "equal":
             continue
 
+        # Opcode indices are relative to the trimmed window
+        i1 += prefix
+        i2 += prefix
+        j1 += prefix
+        j2 += prefix
+
         if tag == "insert":
             # Pure insertion (i1 == i2): no original lines to replace.
             # Anchor to an adjacent original line so the suggestion has
@@ -358,6 +487,10 @@ def process_file(
 ) -> List[Dict[str, Any]]:
     """Process a single file: run clang-format and generate suggestions.
 
+    clang-format is restricted to the PR-touched line ranges via
+    ``--lines``, so a 3-line change in a large header only reformats
+    (and diffs) around those 3 lines instead of the whole file.
+
     Args:
         file_path: Path to the source file.
         added_lines: Set of added line numbers from PR diff.
@@ -375,8 +508,18 @@ def process_file(
         )
         return []
 
+    if not added_lines:
+        # No PR-touched lines → no suggestion could survive the
+        # diff-range filter anyway, so skip clang-format entirely.
+        return []
+
     original = path.read_text(encoding="utf-8", errors="replace")
-    formatted = run_clang_format(file_path, config_path, clang_format_bin)
+    formatted = run_clang_format(
+        file_path,
+        config_path,
+        clang_format_bin,
+        line_ranges=added_lines_to_ranges(added_lines),
+    )
 
     if formatted is None:
         return []
@@ -409,8 +552,20 @@ def main() -> None:
         default=None,
         help="Output JSON file path (default: stdout)",
     )
+    parser.add_argument(
+        "--jobs",
+        type=int,
+        default=None,
+        help="Parallel clang-format processes (default: CPU count)",
+    )
+    parser.add_argument(
+        "--metrics-output",
+        default=None,
+        help="Optional path for a structured timing-metrics JSON artifact",
+    )
 
     args = parser.parse_args()
+    metrics = StageMetrics("stage1-format")
 
     # Check clang-format availability — degrade gracefully when absent
     # so the rest of the pipeline (pattern checking) is not blocked.
@@ -426,6 +581,9 @@ def main() -> None:
             print("Format suggestions: 0 items (clang-format unavailable).")
         else:
             print(empty_json)
+        if args.metrics_output:
+            metrics.incr("clang_format_available", 0)
+            metrics.save(args.metrics_output)
         sys.exit(0)
 
     files = json.loads(args.files)
@@ -449,7 +607,7 @@ def main() -> None:
             added_lines_map[fp] = get_added_line_numbers(diff_data, fp)
         has_diff = True
 
-    all_suggestions = []
+    work: List[Tuple[str, Set[int]]] = []
     for file_path in files:
         if has_diff:
             added = added_lines_map.get(file_path, set())
@@ -464,13 +622,37 @@ def main() -> None:
                 added = set(range(1, line_count + 1))
             else:
                 added = set()
-        suggestions = process_file(
-            file_path,
-            added,
-            config_path=args.clang_format_config,
-            clang_format_bin=clang_format_bin,
-        )
-        all_suggestions.extend(suggestions)
+        work.append((file_path, added))
+
+    # Fan files out across worker threads. clang-format runs as a
+    # subprocess, so threads give process-level parallelism without
+    # pickling the per-file state.
+    max_workers = max(1, args.jobs or os.cpu_count() or 1)
+    max_workers = min(max_workers, len(work)) if work else 1
+
+    def _timed_process(file_path: str, added: Set[int]) -> List[Dict[str, Any]]:
+        # Per-file clang tool wall time, recorded from the worker thread
+        # so queue wait is not counted.
+        start = time.perf_counter()
+        try:
+            return process_file(
+                file_path,
+                added,
+                config_path=args.clang_format_config,
+                clang_format_bin=clang_format_bin,
+            )
+        finally:
+            metrics.add_timing("clang_format_file", time.perf_counter() - start)
+
+    all_suggestions = []
+    with ThreadPoolExecutor(max_workers=max_workers) as executor:
+        futures = [
+            executor.submit(_timed_process, file_path, added)
+            for file_path, added in work
+        ]
+        # Collect in submission order so output stays deterministic.
+        for future in futures:
+            all_suggestions.extend(future.result())
 
     # When --diff is not provided we cannot confirm that lines are
     # PR-touched, so cap severity at "info" to avoid producing
@@ -494,6 +676,11 @@ def main() -> None:
     else:
         print(output_json)
 
+    if args.metrics_output:
+        metrics.incr("files_processed", len(work))
+        metrics.incr("suggestions", len(all_suggestions))
+        metrics.save(args.metrics_output)
+
     sys.exit(0)
 
 
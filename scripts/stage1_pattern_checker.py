@@ -27,10 +27,15 @@ import re
 import subprocess
 import sys
 from pathlib import Path
-from typing import Any, Dict, List, Optional
+from typing import Any, Dict, List, Optional, Set, Tuple
 
 import yaml
 
+try:  # Python 3.11+ moved the regex parser under re._parser
+    from re import _parser as sre_parse  # type: ignore[attr-defined]
+except ImportError:  # pragma: no cover - older interpreters
+    import sre_parse  # type: ignore[no-redef]
+
 # Add project root for imports when run as script
 sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
 
@@ -39,7 +44,9 @@ sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
 # (Markdown, YAML, text, etc.) that may contain false-positive strings.
 _CPP_EXTENSIONS = {".cpp", ".h", ".inl", ".hpp", ".cc", ".cxx", ".hxx"}
 
-from scripts.utils.diff_parser import FileDiff, parse_diff
+from scripts.utils.checklist_cache import compile_rules, load_tier1_rules
+from scripts.utils.diff_parser import FileDiff, load_parsed_diff, parse_diff
+from scripts.utils.metrics import StageMetrics
 
 
 # Patterns for detecting single-line C/C++ comments
@@ -47,13 +54,21 @@ _SINGLE_LINE_COMMENT_RE = re.compile(r"^\s*//")
 _INLINE_COMMENT_RE = re.compile(r"//.*$")
 
 
-def load_tier1_patterns(checklist_path: str) -> List[Dict[str, Any]]:
+def load_tier1_patterns(
+    checklist_path: str,
+    cache_path: Optional[str] = None,
+) -> List[Dict[str, Any]]:
     """Load Tier 1 patterns from checklist.yml.
 
     Extracts items with tier=1 and a 'pattern' field from all categories.
+    When *cache_path* names a valid compiled-checklist artifact (see
+    scripts.utils.checklist_cache), the serialized rules are loaded
+    from it instead of re-parsing the YAML.
 
     Args:
         checklist_path: Path to the checklist YAML file.
+        cache_path: Optional path to a compiled-checklist cache
+            artifact; stale or corrupt artifacts fall back to YAML.
 
     Returns:
         List of pattern info dicts with compiled regex.
@@ -62,52 +77,159 @@ def load_tier1_patterns(checklist_path: str) -> List[Dict[str, Any]]:
         FileNotFoundError: If checklist file doesn't exist.
         ValueError: If a pattern regex is invalid.
     """
-    path = Path(checklist_path)
-    if not path.exists():
-        raise FileNotFoundError(f"Checklist file not found: {checklist_path}")
-
-    with open(path, "r", encoding="utf-8") as f:
-        checklist = yaml.safe_load(f)
-
-    if not isinstance(checklist, dict):
-        raise ValueError(f"Checklist file is empty or not a YAML mapping: {checklist_path}")
-
-    patterns = []
-    for category in checklist.get("categories", []):
-        for item in category.get("items", []):
-            if item.get("tier") == 1 and "pattern" in item:
-                try:
-                    compiled = re.compile(item["pattern"])
-                except re.error as e:
-                    raise ValueError(
-                        f"Invalid regex for pattern '{item['id']}': {e}"
-                    ) from e
-
-                # Compile optional prev_line_pattern for context-aware rules
-                prev_compiled = None
-                if "prev_line_pattern" in item:
-                    try:
-                        prev_compiled = re.compile(item["prev_line_pattern"])
-                    except re.error as e:
-                        raise ValueError(
-                            f"Invalid regex for prev_line_pattern '{item['id']}': {e}"
-                        ) from e
-
-                patterns.append(
-                    {
-                        "id": item["id"],
-                        "compiled": compiled,
-                        "raw_pattern": item["pattern"],
-                        "prev_compiled": prev_compiled,
-                        "severity": item.get("severity", "warning"),
-                        "summary": item.get("summary", ""),
-                        "description": item.get("description", "").strip(),
-                        "auto_fixable": item.get("auto_fixable", False),
-                        "tags": item.get("tags", []),
-                    }
-                )
+    rules = load_tier1_rules(checklist_path, cache_path=cache_path)
+    return compile_rules(rules)
+
+
+# Literal anchors shorter than this are too common to be useful filters.
+_MIN_ANCHOR_LEN = 3
+
+
+def _required_literals(pattern_src: str) -> Optional[Set[str]]:
+    """Derive anchor literals from a regex pattern.
+
+    Returns a set of literal strings such that *every* match of the
+    pattern is guaranteed to contain at least one of them — e.g.
+    ``\\bLogTemp\\b`` yields ``{"LogTemp"}`` and
+    ``(UE_LOG|check|ensure)\\s*\\(`` yields ``{"UE_LOG", "check",
+    "ensure"}``.  Returns None when no such set can be determined
+    (the pattern then cannot be literal-prefiltered).
+
+    Args:
+        pattern_src: Raw regex source string.
+
+    Returns:
+        Set of anchor literals, or None.
+    """
+    try:
+        parsed = sre_parse.parse(pattern_src)
+    except Exception:
+        return None
+    return _sequence_anchors(parsed)
+
+
+def _sequence_anchors(seq) -> Optional[Set[str]]:
+    """Find the best anchor-literal set for a parsed regex sequence.
+
+    Every token in a sequence is required, so any single token's anchor
+    set is valid for the whole sequence; the one with the longest
+    shortest-member is kept (longer literals reject more lines).
+    """
+    best: Optional[Set[str]] = None
+
+    def consider(candidate: Optional[Set[str]]) -> None:
+        nonlocal best
+        if not candidate:
+            return
+        if any(len(lit) < _MIN_ANCHOR_LEN for lit in candidate):
+            return
+        if best is None or min(map(len, candidate)) > min(map(len, best)):
+            best = candidate
+
+    run: List[str] = []
+
+    def flush_run() -> None:
+        if run:
+            consider({"".join(run)})
+            run.clear()
+
+    for op, arg in seq:
+        opname = getattr(op, "name", str(op))
+        if opname == "LITERAL":
+            run.append(chr(arg))
+            continue
+        flush_run()
+        if opname == "SUBPATTERN":
+            # arg = (group, add_flags, del_flags, subpattern)
+            consider(_sequence_anchors(arg[3]))
+        elif opname in ("MAX_REPEAT", "MIN_REPEAT"):
+            min_count, _max_count, sub = arg
+            if min_count >= 1:
+                consider(_sequence_anchors(sub))
+        elif opname == "BRANCH":
+            # Required only if every branch contributes an anchor set.
+            union: Set[str] = set()
+            for branch in arg[1]:
+                branch_anchors = _sequence_anchors(branch)
+                if not branch_anchors:
+                    union = set()
+                    break
+                union |= branch_anchors
+            consider(union)
+        # Assertions, character classes, anchors, etc. contribute no
+        # required literals; they are simply skipped.
+    flush_run()
+
+    return best
+
+
+class CombinedPatternScanner:
+    """One-pass scan engine over all Tier 1 patterns.
+
+    Merges every pattern into a single compiled alternation with one
+    named group per rule, plus a literal prefilter built from each
+    rule's required anchor substrings (see :func:`_required_literals`).
+    For a typical added line — which matches nothing — the work drops
+    from N regex searches to a handful of C-level substring checks and
+    at most one combined search.
+
+    A single alternation pass cannot report *all* matching rules when
+    their matches overlap (the leftmost alternative consumes the span),
+    so lines that do hit are confirmed against the individual rule
+    regexes; the named group of the first hit identifies one matching
+    rule for free.  Results are therefore identical to the per-rule
+    loop.
+    """
 
-    return patterns
+    def __init__(self, patterns: List[Dict[str, Any]]) -> None:
+        self.patterns = patterns
+        self._combined = None
+        self._group_to_pattern: Dict[str, Dict[str, Any]] = {}
+        if patterns:
+            parts = []
+            for i, pat in enumerate(patterns):
+                name = f"r{i}"
+                parts.append(f"(?P<{name}>{pat['raw_pattern']})")
+                self._group_to_pattern[name] = pat
+            try:
+                self._combined = re.compile("|".join(parts))
+            except re.error:
+                # Patterns that cannot be merged (e.g. conflicting
+                # inline flags) fall back to the per-rule loop.
+                self._combined = None
+
+        # Line-level prefilter: usable only when every rule has anchors,
+        # otherwise an anchorless rule could be wrongly rejected.
+        anchors: Set[str] = set()
+        self._prefilter: Optional[Tuple[str, ...]] = None
+        for pat in patterns:
+            rule_anchors = _required_literals(pat["raw_pattern"])
+            if not rule_anchors:
+                break
+            anchors |= rule_anchors
+        else:
+            if anchors:
+                self._prefilter = tuple(sorted(anchors))
+
+    def match_rules(self, text: str) -> List[Dict[str, Any]]:
+        """Return all patterns matching *text*, in checklist order."""
+        if not self.patterns:
+            return []
+        if self._prefilter is not None and not any(
+            lit in text for lit in self._prefilter
+        ):
+            return []
+        if self._combined is not None:
+            m = self._combined.search(text)
+            if m is None:
+                return []
+            first = self._group_to_pattern[m.lastgroup]
+            return [
+                pat
+                for pat in self.patterns
+                if pat is first or pat["compiled"].search(text)
+            ]
+        return [pat for pat in self.patterns if pat["compiled"].search(text)]
 
 
 def _split_code_comment(line: str) -> tuple:
@@ -178,6 +300,98 @@ def _strip_comments(line: str) -> str:
     return code
 
 
+def _scan_code_segment(line: str, in_block_comment: bool) -> Tuple[str, bool]:
+    """Extract the code portion of one line, tracking ``/* */`` state.
+
+    Single character pass handling string literals, char literals
+    (with escapes), ``//`` comments, and block comments.  A block
+    comment removed mid-line is replaced by a single space so adjacent
+    tokens don't glue together.
+
+    Args:
+        line: Raw source line (diff prefix already stripped).
+        in_block_comment: True if the line starts inside a ``/* */``.
+
+    Returns:
+        Tuple of (code text with comments removed, whether a block
+        comment is still open at the end of the line).
+    """
+    out: List[str] = []
+    in_string = False
+    in_char = False
+    i = 0
+    n = len(line)
+    while i < n:
+        if in_block_comment:
+            end = line.find("*/", i)
+            if end == -1:
+                return "".join(out), True
+            in_block_comment = False
+            out.append(" ")
+            i = end + 2
+            continue
+        ch = line[i]
+        if in_string or in_char:
+            out.append(ch)
+            if ch == "\\" and i + 1 < n:
+                out.append(line[i + 1])
+                i += 2
+                continue
+            if in_string and ch == '"':
+                in_string = False
+            elif in_char and ch == "'":
+                in_char = False
+            i += 1
+            continue
+        if ch == "/" and i + 1 < n:
+            nxt = line[i + 1]
+            if nxt == "/":
+                return "".join(out), False
+            if nxt == "*":
+                in_block_comment = True
+                i += 2
+                continue
+        if ch == '"':
+            in_string = True
+        elif ch == "'":
+            in_char = True
+        out.append(ch)
+        i += 1
+    return "".join(out), in_block_comment
+
+
+def build_code_line_mask(lines_by_num: Dict[int, str]) -> Dict[int, str]:
+    """Build a per-line code mask for a file's diff lines in one pass.
+
+    Walks the known lines (added + context) in line-number order with a
+    single state machine, so ``/* */`` block comments spanning multiple
+    lines are classified correctly — something the per-line
+    ``_strip_comments`` cannot do.  A gap in the numbering (lines the
+    diff never saw) resets the state to code; this can only
+    under-strip on a block comment opened in an unseen line, never hide
+    real code.
+
+    Args:
+        lines_by_num: Line number → raw line text.
+
+    Returns:
+        Line number → code portion of the line (comments removed;
+        empty/whitespace string for lines entirely inside comments).
+    """
+    mask: Dict[int, str] = {}
+    in_block_comment = False
+    prev_num: Optional[int] = None
+    for num in sorted(lines_by_num):
+        if prev_num is not None and num != prev_num + 1:
+            in_block_comment = False
+        code, in_block_comment = _scan_code_segment(
+            lines_by_num[num], in_block_comment
+        )
+        mask[num] = code
+        prev_num = num
+    return mask
+
+
 def _generate_suggestion(rule_id: str, line: str) -> Optional[str]:
     """Generate auto-fix suggestion for fixable patterns.
 
@@ -212,6 +426,9 @@ def check_line(
     patterns: List[Dict[str, Any]],
     skip_comments: bool = True,
     prev_line: Optional[str] = None,
+    scanner: Optional[CombinedPatternScanner] = None,
+    code_text: Optional[str] = None,
+    prev_code_text: Optional[str] = None,
 ) -> List[Dict[str, Any]]:
     """Check a single line against all Tier 1 patterns.
 
@@ -222,28 +439,43 @@ def check_line(
                        and strip inline comments before matching.
         prev_line: Optional previous source line for context-aware patterns
                    that use ``prev_line_pattern``.
+        scanner: Optional CombinedPatternScanner built over *patterns*.
+            Replaces the per-pattern search loop with one combined
+            scan; results are identical.
+        code_text: Precomputed code portion of *line* (from
+            build_code_line_mask()).  When given, replaces the per-line
+            _strip_comments() pass.
+        prev_code_text: Precomputed code portion of *prev_line*.
 
     Returns:
         List of finding dicts (without file/line info).
     """
     check_target = line
     if skip_comments:
-        check_target = _strip_comments(line)
+        check_target = (
+            code_text if code_text is not None else _strip_comments(line)
+        )
         if not check_target.strip():
             return []
 
-    findings = []
-    for pat in patterns:
-        if not pat["compiled"].search(check_target):
-            continue
+    if scanner is not None:
+        matched = scanner.match_rules(check_target)
+    else:
+        matched = [p for p in patterns if p["compiled"].search(check_target)]
 
+    findings = []
+    for pat in matched:
         # If this rule requires prev_line context, validate it
         if pat["prev_compiled"] is not None:
             if prev_line is None:
                 continue
             prev_check_target = prev_line
             if skip_comments:
-                prev_check_target = _strip_comments(prev_line)
+                prev_check_target = (
+                    prev_code_text
+                    if prev_code_text is not None
+                    else _strip_comments(prev_line)
+                )
                 if not prev_check_target.strip():
                     continue
             if not pat["prev_compiled"].search(prev_check_target):
@@ -279,6 +511,8 @@ def check_diff(
         message, and suggestion fields.
     """
     all_findings = []
+    # One combined scan per line instead of a per-pattern loop.
+    scanner = CombinedPatternScanner(patterns)
 
     for filepath in sorted(diff_data.keys()):
         # Only check C++ files — skip Markdown, YAML, text, etc. to
@@ -288,6 +522,15 @@ def check_diff(
         file_diff = diff_data[filepath]
         sorted_line_nums = sorted(file_diff.added_lines.keys())
         has_prev_patterns = any(p["prev_compiled"] is not None for p in patterns)
+        # One streaming pass over all known lines (added + context)
+        # classifies comments for the whole file, including /* */
+        # blocks spanning lines — check_line consults the mask in O(1)
+        # instead of re-stripping each line.
+        code_mask: Dict[int, str] = {}
+        if skip_comments:
+            code_mask = build_code_line_mask(
+                {**file_diff.context_lines, **file_diff.added_lines}
+            )
         for i, line_num in enumerate(sorted_line_nums):
             line = file_diff.added_lines[line_num]
             # Only look up prev_line when at least one pattern uses
@@ -300,7 +543,17 @@ def check_diff(
                 elif prev_line_num in file_diff.context_lines:
                     prev_line = file_diff.context_lines[prev_line_num]
             findings = check_line(
-                line, patterns, skip_comments=skip_comments, prev_line=prev_line
+                line,
+                patterns,
+                skip_comments=skip_comments,
+                prev_line=prev_line,
+                scanner=scanner,
+                code_text=code_mask.get(line_num),
+                prev_code_text=(
+                    code_mask.get(line_num - 1)
+                    if prev_line is not None
+                    else None
+                ),
             )
             for finding in findings:
                 all_findings.append(
@@ -355,6 +608,14 @@ def main() -> None:
         "--diff",
         help="Path to a unified diff file",
     )
+    parser.add_argument(
+        "--parsed-diff",
+        help=(
+            "Path to a parsed-diff JSON artifact (written by "
+            "gate_checker --parsed-diff-output). Skips re-parsing "
+            "the raw diff."
+        ),
+    )
     parser.add_argument(
         "--files",
         help='JSON list of files to check (e.g. \'["Source/A.cpp"]\')',
@@ -368,6 +629,15 @@ def main() -> None:
         default="configs/checklist.yml",
         help="Path to checklist.yml (default: configs/checklist.yml)",
     )
+    parser.add_argument(
+        "--checklist-cache",
+        default=None,
+        help=(
+            "Path to a compiled-checklist cache artifact (written by "
+            "scripts/utils/checklist_cache.py). Skips re-parsing the "
+            "checklist YAML when valid."
+        ),
+    )
     parser.add_argument(
         "--output",
         default=None,
@@ -378,31 +648,50 @@ def main() -> None:
         action="store_true",
         help="Don't skip comment lines (check everything)",
     )
+    parser.add_argument(
+        "--metrics-output",
+        default=None,
+        help="Optional path for a structured timing-metrics JSON artifact",
+    )
 
     args = parser.parse_args()
-
-    # Get diff text
-    if args.diff:
+    metrics = StageMetrics("stage1-pattern")
+
+    # Get parsed diff data — prefer the shared artifact when provided
+    if args.parsed_diff:
+        parsed_path = Path(args.parsed_diff)
+        if not parsed_path.exists():
+            print(
+                f"Error: Parsed diff file not found: {args.parsed_diff}",
+                file=sys.stderr,
+            )
+            sys.exit(1)
+        diff_data = load_parsed_diff(parsed_path)
+    elif args.diff:
         diff_path = Path(args.diff)
         if not diff_path.exists():
             print(f"Error: Diff file not found: {args.diff}", file=sys.stderr)
             sys.exit(1)
         diff_text = diff_path.read_text(encoding="utf-8", errors="replace")
+        with metrics.timer("parse_diff"):
+            diff_data = parse_diff(diff_text)
     elif args.files and args.base_ref:
         files = json.loads(args.files)
-        diff_text = get_diff_from_git(files, args.base_ref)
+        with metrics.timer("parse_diff"):
+            diff_data = parse_diff(get_diff_from_git(files, args.base_ref))
     else:
         print(
-            "Error: Either --diff or (--files + --base-ref) is required",
+            "Error: Either --diff, --parsed-diff or (--files + --base-ref) "
+            "is required",
             file=sys.stderr,
         )
         sys.exit(1)
 
-    # Load patterns
-    patterns = load_tier1_patterns(args.checklist)
-
-    # Parse diff and run checks
-    diff_data = parse_diff(diff_text)
+    # Load patterns — via the precompiled artifact when provided
+    with metrics.timer("load_patterns"):
+        patterns = load_tier1_patterns(
+            args.checklist, cache_path=args.checklist_cache
+        )
 
     # When using --files + --base-ref, the diff is generated without a
     # file pathspec (to support rename detection), so restrict analysis
@@ -411,9 +700,12 @@ def main() -> None:
         requested_files = set(json.loads(args.files))
         diff_data = {k: v for k, v in diff_data.items() if k in requested_files}
 
-    findings = check_diff(
-        diff_data, patterns, skip_comments=not args.no_skip_comments
-    )
+    with metrics.timer("regex_scan"):
+        findings = check_diff(
+            diff_data, patterns, skip_comments=not args.no_skip_comments
+        )
+    metrics.incr("files_checked", len(diff_data))
+    metrics.incr("findings", len(findings))
 
     # Output
     output_json = json.dumps(findings, ensure_ascii=False, indent=2)
@@ -428,6 +720,9 @@ def main() -> None:
     else:
         print(output_json)
 
+    if args.metrics_output:
+        metrics.save(args.metrics_output)
+
     sys.exit(0)
 
 
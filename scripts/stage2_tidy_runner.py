@@ -0,0 +1,438 @@
+#!/usr/bin/env python3
+"""Stage 2 — parallel clang-tidy orchestrator.
+
+Replaces the sequential shell loop in the workflow's "Run clang-tidy"
+step.  Schedules one clang-tidy invocation per changed file across a
+worker pool sized by available cores, with:
+
+* longest-file-first ordering so a big translation unit doesn't become
+  a straggler at the end of the run
+* a per-file timeout so one pathological file can't stall the stage
+* per-file ``--export-fixes`` outputs merged into a single multi-document
+  YAML file consumable by ``stage2_tidy_to_suggestions.parse_tidy_fixes()``
+
+Usage:
+    python -m scripts.stage2_tidy_runner \\
+        --files '["Source/A.cpp", "Source/B.cpp"]' \\
+        --build-dir build \\
+        --config-file configs/.clang-tidy \\
+        --output-fixes tidy-fixes.yaml \\
+        --jobs 8 \\
+        --timeout 300
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+from concurrent.futures import ThreadPoolExecutor, as_completed
+from pathlib import Path
+from typing import Any, Dict, List, Optional, Tuple
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
+
+from scripts.utils.metrics import StageMetrics
+from scripts.utils.tidy_cache import (
+    TidyCache,
+    load_compile_commands_index,
+    make_tidy_cache_key,
+)
+
+# Default per-file timeout.  UE5 translation units take 30-90 s under
+# clang-tidy; 300 s leaves ample headroom before declaring a file stuck.
+DEFAULT_TIMEOUT = 300
+
+
+def find_clang_tidy() -> Optional[str]:
+    """Find clang-tidy executable.
+
+    Returns:
+        Path to clang-tidy executable, or None if not found.
+    """
+    return shutil.which("clang-tidy")
+
+
+def order_longest_first(files: List[str]) -> List[str]:
+    """Order files by size descending to avoid straggler tails.
+
+    Starting the biggest translation units first keeps all workers busy
+    until the end of the run; missing files sort last (size 0) and are
+    skipped by the runner anyway.
+
+    Args:
+        files: File paths to order.
+
+    Returns:
+        New list sorted by on-disk size, largest first.
+    """
+    def _size(fp: str) -> int:
+        try:
+            return Path(fp).stat().st_size
+        except OSError:
+            return 0
+
+    return sorted(files, key=_size, reverse=True)
+
+
+def run_clang_tidy_file(
+    file_path: str,
+    build_dir: str,
+    config_file: Optional[str] = None,
+    clang_tidy_bin: Optional[str] = None,
+    timeout: int = DEFAULT_TIMEOUT,
+) -> Dict[str, Any]:
+    """Run clang-tidy on a single file and capture its exported fixes.
+
+    Args:
+        file_path: Source file to analyze.
+        build_dir: Directory containing compile_commands.json.
+        config_file: Path to the .clang-tidy config file.
+        clang_tidy_bin: Path to clang-tidy binary (auto-detected if None).
+        timeout: Per-file timeout in seconds.
+
+    Returns:
+        Result dict with keys:
+        - ``file``: the input path
+        - ``status``: "ok", "skipped", "timeout", or "error"
+        - ``fixes_yaml``: exported fixes YAML text ("" when none)
+        - ``elapsed``: wall time in seconds
+    """
+    start = time.monotonic()
+
+    if not Path(file_path).is_file():
+        return {"file": file_path, "status": "skipped", "fixes_yaml": "", "elapsed": 0.0}
+
+    binary = clang_tidy_bin or find_clang_tidy()
+    if binary is None:
+        return {"file": file_path, "status": "error", "fixes_yaml": "", "elapsed": 0.0}
+
+    # Use a private temp file per invocation so parallel runs never
+    # clobber each other's --export-fixes output.
+    fd, fixes_path = tempfile.mkstemp(suffix=".yaml", prefix="tidy-fixes-")
+    os.close(fd)
+    try:
+        cmd = [binary, file_path, f"--export-fixes={fixes_path}", "-p", build_dir]
+        if config_file:
+            cmd.insert(2, f"--config-file={config_file}")
+
+        try:
+            subprocess.run(
+                cmd,
+                capture_output=True,
+                text=True,
+                timeout=timeout,
+            )
+        except subprocess.TimeoutExpired:
+            print(
+                f"Warning: clang-tidy timed out after {timeout}s: {file_path}",
+                file=sys.stderr,
+            )
+            return {
+                "file": file_path,
+                "status": "timeout",
+                "fixes_yaml": "",
+                "elapsed": time.monotonic() - start,
+            }
+        except OSError as e:
+            print(
+                f"Warning: clang-tidy failed to start for {file_path}: {e}",
+                file=sys.stderr,
+            )
+            return {
+                "file": file_path,
+                "status": "error",
+                "fixes_yaml": "",
+                "elapsed": time.monotonic() - start,
+            }
+
+        # clang-tidy exits non-zero when it emits warnings; the export
+        # file is authoritative, so we read it regardless of exit code.
+        fixes_yaml = ""
+        fixes_file = Path(fixes_path)
+        if fixes_file.exists():
+            fixes_yaml = fixes_file.read_text(encoding="utf-8", errors="replace")
+
+        return {
+            "file": file_path,
+            "status": "ok",
+            "fixes_yaml": fixes_yaml,
+            "elapsed": time.monotonic() - start,
+        }
+    finally:
+        try:
+            os.unlink(fixes_path)
+        except OSError:
+            pass
+
+
+def merge_fixes_yaml(results: List[Dict[str, Any]]) -> str:
+    """Merge per-file fixes YAML into one multi-document YAML text.
+
+    Documents are joined with ``---`` separators, matching the format
+    ``parse_tidy_fixes()`` already accepts (``yaml.safe_load_all``).
+
+    Args:
+        results: Result dicts from run_clang_tidy_file().
+
+    Returns:
+        Merged YAML text (empty string when no file produced fixes).
+    """
+    documents = [
+        r["fixes_yaml"].strip()
+        for r in results
+        if r.get("fixes_yaml", "").strip()
+    ]
+    if not documents:
+        return ""
+    return "\n---\n".join(documents) + "\n"
+
+
+def _cache_lookup(
+    file_path: str,
+    compile_index: Dict[str, str],
+    config_text: str,
+    cache: TidyCache,
+) -> Tuple[Optional[str], Optional[str]]:
+    """Compute the cache key for *file_path* and look it up.
+
+    Returns:
+        Tuple of (key, cached_yaml).  key is None when the file is
+        unreadable (no caching possible); cached_yaml is None on a miss.
+    """
+    try:
+        content = Path(file_path).read_text(encoding="utf-8", errors="replace")
+    except OSError:
+        return None, None
+
+    try:
+        resolved = str(Path(file_path).resolve())
+    except OSError:
+        resolved = file_path
+    compile_entry = compile_index.get(resolved, "")
+
+    key = make_tidy_cache_key(content, compile_entry, config_text)
+    return key, cache.get(key)
+
+
+def run_parallel(
+    files: List[str],
+    build_dir: str,
+    config_file: Optional[str] = None,
+    clang_tidy_bin: Optional[str] = None,
+    jobs: Optional[int] = None,
+    timeout: int = DEFAULT_TIMEOUT,
+    cache: Optional[TidyCache] = None,
+) -> List[Dict[str, Any]]:
+    """Run clang-tidy over *files* on a worker pool.
+
+    When *cache* is provided, each file's content, compile-command
+    entry, and the .clang-tidy config are hashed first; hits replay the
+    stored fixes YAML (status ``"cached"``) without spawning clang-tidy,
+    and clean completions are written back.  Timeouts and launch errors
+    are never cached.
+
+    Args:
+        files: Source files to analyze.
+        build_dir: Directory containing compile_commands.json.
+        config_file: Path to the .clang-tidy config file.
+        clang_tidy_bin: Path to clang-tidy binary.
+        jobs: Worker count (default: os.cpu_count()).
+        timeout: Per-file timeout in seconds.
+        cache: Optional incremental result cache.
+
+    Returns:
+        List of per-file result dicts, in completion order
+        (cache hits first).
+    """
+    if not files:
+        return []
+
+    results: List[Dict[str, Any]] = []
+    to_analyze = order_longest_first(files)
+
+    cache_keys: Dict[str, Optional[str]] = {}
+    if cache is not None:
+        config_text = ""
+        if config_file:
+            try:
+                config_text = Path(config_file).read_text(
+                    encoding="utf-8", errors="replace"
+                )
+            except OSError:
+                pass
+        compile_index = load_compile_commands_index(build_dir)
+
+        remaining: List[str] = []
+        for fp in to_analyze:
+            key, cached_yaml = _cache_lookup(fp, compile_index, config_text, cache)
+            cache_keys[fp] = key
+            if cached_yaml is not None:
+                results.append({
+                    "file": fp,
+                    "status": "cached",
+                    "fixes_yaml": cached_yaml,
+                    "elapsed": 0.0,
+                })
+            else:
+                remaining.append(fp)
+        to_analyze = remaining
+
+    if not to_analyze:
+        return results
+
+    max_workers = max(1, jobs or os.cpu_count() or 1)
+    max_workers = min(max_workers, len(to_analyze))
+
+    with ThreadPoolExecutor(max_workers=max_workers) as executor:
+        futures = {
+            executor.submit(
+                run_clang_tidy_file,
+                fp,
+                build_dir,
+                config_file=config_file,
+                clang_tidy_bin=clang_tidy_bin,
+                timeout=timeout,
+            ): fp
+            for fp in to_analyze
+        }
+        for future in as_completed(futures):
+            result = future.result()
+            if (
+                cache is not None
+                and result["status"] == "ok"
+                and cache_keys.get(result["file"]) is not None
+            ):
+                cache.put(
+                    cache_keys[result["file"]],
+                    result["file"],
+                    result["fixes_yaml"],
+                )
+            results.append(result)
+
+    return results
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(
+        description="Stage 2 — parallel clang-tidy orchestrator"
+    )
+    parser.add_argument(
+        "--files",
+        required=True,
+        help='JSON list of files to analyze (e.g. \'["Source/A.cpp"]\')',
+    )
+    parser.add_argument(
+        "--build-dir",
+        default=".",
+        help="Directory containing compile_commands.json (default: .)",
+    )
+    parser.add_argument(
+        "--config-file",
+        default="configs/.clang-tidy",
+        help="Path to .clang-tidy config (default: configs/.clang-tidy)",
+    )
+    parser.add_argument(
+        "--output-fixes",
+        required=True,
+        help="Path for the merged --export-fixes YAML output",
+    )
+    parser.add_argument(
+        "--jobs",
+        type=int,
+        default=None,
+        help="Parallel clang-tidy processes (default: CPU count)",
+    )
+    parser.add_argument(
+        "--timeout",
+        type=int,
+        default=DEFAULT_TIMEOUT,
+        help=f"Per-file timeout in seconds (default: {DEFAULT_TIMEOUT})",
+    )
+    parser.add_argument(
+        "--cache-dir",
+        default=None,
+        help=(
+            "Directory for the incremental result cache. Files whose "
+            "content, compile command, and .clang-tidy config are "
+            "unchanged replay cached fixes instead of re-running "
+            "clang-tidy."
+        ),
+    )
+    parser.add_argument(
+        "--metrics-output",
+        default=None,
+        help="Optional path for a structured timing-metrics JSON artifact",
+    )
+
+    args = parser.parse_args()
+    metrics = StageMetrics("stage2-tidy")
+
+    # Degrade gracefully when clang-tidy is unavailable — write an empty
+    # fixes file so the conversion step still runs.
+    clang_tidy_bin = find_clang_tidy()
+    if clang_tidy_bin is None:
+        print(
+            "Warning: clang-tidy not found. Writing empty fixes file.",
+            file=sys.stderr,
+        )
+        Path(args.output_fixes).write_text("", encoding="utf-8")
+        if args.metrics_output:
+            metrics.incr("clang_tidy_available", 0)
+            metrics.save(args.metrics_output)
+        sys.exit(0)
+
+    files = json.loads(args.files)
+    cache = TidyCache(args.cache_dir) if args.cache_dir else None
+
+    start = time.monotonic()
+    results = run_parallel(
+        files,
+        args.build_dir,
+        config_file=args.config_file,
+        clang_tidy_bin=clang_tidy_bin,
+        jobs=args.jobs,
+        timeout=args.timeout,
+        cache=cache,
+    )
+    elapsed = time.monotonic() - start
+
+    merged = merge_fixes_yaml(results)
+    Path(args.output_fixes).write_text(merged, encoding="utf-8")
+
+    counts: Dict[str, int] = {}
+    for r in results:
+        counts[r["status"]] = counts.get(r["status"], 0) + 1
+    print(
+        f"clang-tidy: {len(results)} file(s) in {elapsed:.1f}s "
+        f"({', '.join(f'{k}={v}' for k, v in sorted(counts.items())) or 'none'}). "
+        f"Merged fixes written to: {args.output_fixes}"
+    )
+    if cache is not None:
+        cs = cache.summary()
+        print(
+            f"Tidy cache: {cs['cache_hits']} hit(s), "
+            f"{cs['cache_misses']} miss(es)."
+        )
+
+    if args.metrics_output:
+        metrics.add_timing("clang_tidy_total", elapsed)
+        for r in results:
+            metrics.add_timing("clang_tidy_file", r.get("elapsed", 0.0))
+            metrics.incr(f"status_{r['status']}")
+        if cache is not None:
+            cs = cache.summary()
+            metrics.incr("cache_hits", cs["cache_hits"])
+            metrics.incr("cache_misses", cs["cache_misses"])
+        metrics.save(args.metrics_output)
+
+    sys.exit(0)
+
+
+if __name__ == "__main__":
+    main()
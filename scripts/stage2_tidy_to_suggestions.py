@@ -18,13 +18,19 @@ Usage:
 from __future__ import annotations
 
 import argparse
+import bisect
 import json
 import sys
+from functools import lru_cache
 from pathlib import Path
 from typing import Any, Dict, List, Optional, Set, Tuple
 
 import yaml
 
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
+
+from scripts.utils.metrics import StageMetrics
+
 # ---------------------------------------------------------------------------
 # clang-tidy --export-fixes YAML schema (abbreviated):
 #
@@ -94,6 +100,9 @@ def _offset_to_line(content: str, offset: int) -> int:
 
     clang-tidy emits byte offsets, so we encode to UTF-8 first to get
     accurate line numbers when the file contains multi-byte characters.
+
+    For repeated lookups in the same file use :class:`SourceIndex`,
+    which encodes and scans the content once instead of per call.
     """
     raw = content.encode("utf-8")
     # Clamp to valid range
@@ -101,10 +110,40 @@ def _offset_to_line(content: str, offset: int) -> int:
     return raw[:offset].count(b"\n") + 1
 
 
+class SourceIndex:
+    """Per-file index for repeated byte-offset lookups.
+
+    ``_offset_to_line()`` re-encodes the file and rescans it from the
+    start on every call — O(file size) per diagnostic.  UE5 translation
+    units routinely carry dozens of clang-tidy diagnostics each, so this
+    precomputes the UTF-8 bytes and a sorted table of newline offsets
+    once, making each offset→line lookup a bisect.  The cached
+    ``encoded`` bytes are also reused by :func:`_apply_replacements`.
+    """
+
+    def __init__(self, content: str) -> None:
+        self.content = content
+        self.encoded = content.encode("utf-8")
+        offsets: List[int] = []
+        pos = self.encoded.find(b"\n")
+        while pos != -1:
+            offsets.append(pos)
+            pos = self.encoded.find(b"\n", pos + 1)
+        self._newline_offsets = offsets
+
+    def line_at(self, offset: int) -> int:
+        """Return the 1-based line number containing byte *offset*."""
+        offset = min(offset, len(self.encoded))
+        # Number of newlines strictly before the offset, matching
+        # _offset_to_line() semantics.
+        return bisect.bisect_left(self._newline_offsets, offset) + 1
+
+
 def _apply_replacements(
     content: str,
     replacements: List[Dict[str, Any]],
     target_file: str,
+    encoded: Optional[bytes] = None,
 ) -> Optional[str]:
     """Apply clang-tidy replacements to source content and return the
     modified text.
@@ -119,6 +158,10 @@ def _apply_replacements(
 
     When multiple replacements target different offsets we apply them
     back-to-front (highest offset first) so earlier offsets remain valid.
+
+    *encoded* optionally supplies the already-encoded UTF-8 bytes of
+    *content* (e.g. from a :class:`SourceIndex`) so files with many
+    diagnostics are not re-encoded per diagnostic.
     """
     applicable = [
         r for r in replacements
@@ -131,7 +174,7 @@ def _apply_replacements(
     applicable.sort(key=lambda r: r.get("Offset", 0), reverse=True)
 
     # Work in bytes — clang-tidy offsets are byte-based
-    modified = content.encode("utf-8")
+    modified = encoded if encoded is not None else content.encode("utf-8")
     for repl in applicable:
         offset = repl.get("Offset", 0)
         length = repl.get("Length", 0)
@@ -141,8 +184,13 @@ def _apply_replacements(
     return modified.decode("utf-8", errors="replace")
 
 
+@lru_cache(maxsize=4096)
 def _normalise(path: str) -> str:
-    """Normalise a path for comparison (resolve, lower on Windows)."""
+    """Normalise a path for comparison (resolve, lower on Windows).
+
+    Memoized — comparisons repeat the same handful of paths once per
+    diagnostic, and ``Path.resolve()`` hits the filesystem.
+    """
     try:
         return str(Path(path).resolve())
     except (OSError, ValueError):
@@ -165,15 +213,31 @@ def parse_tidy_fixes(
     if not path.exists():
         return []
 
-    text = path.read_text(encoding="utf-8", errors="replace")
-    if not text.strip():
+    return parse_tidy_fixes_text(path.read_text(encoding="utf-8", errors="replace"))
+
+
+def parse_tidy_fixes_text(yaml_text: str) -> List[Dict[str, Any]]:
+    """Parse clang-tidy fixes YAML text already held in memory.
+
+    Used by the single-job pipeline driver, which gets the merged YAML
+    straight from :func:`scripts.stage2_tidy_runner.merge_fixes_yaml`
+    without going through a file.
+
+    Args:
+        yaml_text: Fixes YAML content (may be multi-document).
+
+    Returns:
+        List of raw diagnostic dicts.  Empty list if the text is empty
+        or invalid.
+    """
+    if not yaml_text.strip():
         return []
 
     # Handle multi-document YAML produced by concatenating multiple
     # clang-tidy --export-fixes outputs (one document per invocation).
     all_diagnostics: List[Dict[str, Any]] = []
     try:
-        for doc in yaml.safe_load_all(text):
+        for doc in yaml.safe_load_all(yaml_text):
             if isinstance(doc, dict):
                 diags = doc.get("Diagnostics") or []
                 all_diagnostics.extend(diags)
@@ -309,6 +373,30 @@ def convert_diagnostics(
     """
     findings: List[Dict[str, Any]] = []
 
+    # Per-run caches shared across diagnostics: files are indexed once
+    # (encode + newline scan) and path normalisation is looked up in a
+    # precomputed table instead of rescanning source_contents per
+    # diagnostic.
+    indexes: Dict[str, SourceIndex] = {}
+    norm_lookup: Dict[str, str] = {}
+    if source_contents:
+        norm_lookup = {_normalise(k): k for k in source_contents}
+
+    def _index_for(key: str) -> SourceIndex:
+        idx = indexes.get(key)
+        if idx is None:
+            idx = SourceIndex(source_contents[key])
+            indexes[key] = idx
+        return idx
+
+    def _content_key(file_path: str) -> Optional[str]:
+        """Resolve a diagnostic path to its source_contents key."""
+        if not source_contents:
+            return None
+        if file_path in source_contents:
+            return file_path
+        return norm_lookup.get(_normalise(file_path))
+
     for diag in diagnostics:
         if not isinstance(diag, dict):
             continue
@@ -334,19 +422,12 @@ def convert_diagnostics(
         else:
             rel_path = _resolve_path(file_path, build_dir)
 
-        # Compute line number
-        if source_contents and file_path in source_contents:
-            line_num = _offset_to_line(source_contents[file_path], file_offset)
-        elif source_contents:
-            # Try with resolved path
-            for src_path, content in source_contents.items():
-                if _normalise(src_path) == _normalise(file_path):
-                    line_num = _offset_to_line(content, file_offset)
-                    break
-            else:
-                # Rough estimate: ~80 chars per line
-                line_num = max(1, file_offset // 80 + 1)
+        # Compute line number via the shared per-file index
+        content_key = _content_key(file_path)
+        if content_key is not None:
+            line_num = _index_for(content_key).line_at(file_offset)
         else:
+            # Rough estimate: ~80 chars per line
             line_num = max(1, file_offset // 80 + 1)
 
         # Map check name to rule_id
@@ -355,17 +436,14 @@ def convert_diagnostics(
         # Generate suggestion from replacements if available
         suggestion = None
         end_line = None
-        if replacements and source_contents:
-            abs_path = file_path
-            content = source_contents.get(abs_path)
-            if content is None:
-                for src_path, src_content in source_contents.items():
-                    if _normalise(src_path) == _normalise(abs_path):
-                        content = src_content
-                        break
+        if replacements and content_key is not None:
+            index = _index_for(content_key)
+            content = index.content
 
             if content is not None:
-                modified = _apply_replacements(content, replacements, abs_path)
+                modified = _apply_replacements(
+                    content, replacements, file_path, encoded=index.encoded
+                )
                 if modified is not None and modified != content:
                     suggestion, span_start, span_end = _extract_suggestion_span(
                         content, modified
@@ -441,6 +519,20 @@ def _collect_source_contents(
     path_map: Dict[str, str] = {}
     seen_paths: set = set()
 
+    # Per-run read cache keyed by resolved path — diagnostics referring
+    # to the same physical file through different spellings (build-tree
+    # vs source-tree path) hit the disk only once.
+    read_cache: Dict[str, str] = {}
+
+    def _read_cached(p: Path) -> str:
+        try:
+            key = str(p.resolve())
+        except (OSError, ValueError):
+            key = str(p)
+        if key not in read_cache:
+            read_cache[key] = _read_source(p)
+        return read_cache[key]
+
     for diag in diagnostics:
         if not isinstance(diag, dict):
             continue
@@ -466,7 +558,7 @@ def _collect_source_contents(
         # Try absolute path first
         if p.is_file():
             try:
-                contents[file_path] = _read_source(p)
+                contents[file_path] = _read_cached(p)
                 # When source_dir is provided, populate path_map even for
                 # readable absolute paths so findings use repo-relative paths.
                 if source_dir:
@@ -490,7 +582,7 @@ def _collect_source_contents(
                                 if matched.is_file():
                                     path_map[file_path] = suffix
                                     try:
-                                        contents[file_path] = _read_source(matched)
+                                        contents[file_path] = _read_cached(matched)
                                     except OSError:
                                         pass  # keep original content
                                     break
@@ -522,7 +614,7 @@ def _collect_source_contents(
                 seen_candidates.add(resolved)
                 if candidate.is_file():
                     try:
-                        contents[file_path] = _read_source(candidate)
+                        contents[file_path] = _read_cached(candidate)
                         path_map[file_path] = rel_suffix
                         break
                     except OSError:
@@ -560,8 +652,14 @@ def main() -> None:
         default=None,
         help="Output JSON file path (default: stdout)",
     )
+    parser.add_argument(
+        "--metrics-output",
+        default=None,
+        help="Optional path for a structured timing-metrics JSON artifact",
+    )
 
     args = parser.parse_args()
+    metrics = StageMetrics("stage2-convert")
 
     # PVS-Studio placeholder
     if args.pvs_report:
@@ -571,7 +669,9 @@ def main() -> None:
         )
 
     # Parse clang-tidy fixes
-    diagnostics = parse_tidy_fixes(args.tidy_fixes)
+    with metrics.timer("parse_fixes"):
+        diagnostics = parse_tidy_fixes(args.tidy_fixes)
+    metrics.incr("diagnostics", len(diagnostics))
 
     # Load source files for accurate line numbers and suggestion generation
     source_contents, path_map = _collect_source_contents(diagnostics, args.source_dir)
@@ -588,11 +688,12 @@ def main() -> None:
             file=sys.stderr,
         )
 
-    findings = convert_diagnostics(
-        diagnostics,
-        source_contents=source_contents,
-        path_map=path_map,
-    )
+    with metrics.timer("convert_diagnostics"):
+        findings = convert_diagnostics(
+            diagnostics,
+            source_contents=source_contents,
+            path_map=path_map,
+        )
 
     # Deduplicate against Stage 1
     if args.stage1_results:
@@ -619,6 +720,10 @@ def main() -> None:
     else:
         print(output_json)
 
+    if args.metrics_output:
+        metrics.incr("findings", len(findings))
+        metrics.save(args.metrics_output)
+
     sys.exit(0)
 
 
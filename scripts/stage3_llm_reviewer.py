@@ -31,16 +31,28 @@ import argparse
 import json
 import logging
 import os
+import re
 import sys
+import threading
 import time
+from concurrent.futures import ThreadPoolExecutor, as_completed
 from pathlib import Path
-from typing import Any, Dict, List, Optional, Set, Tuple
+from typing import Any, Callable, Dict, List, Optional, Set, Tuple
+
+import yaml
 
 sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
 
-from scripts.utils.diff_parser import parse_diff
+from scripts.utils.checklist_cache import compile_rules, load_tier1_rules
+from scripts.utils.context_extractor import extract_review_context
+from scripts.utils.diff_parser import FileDiff, load_parsed_diff, parse_diff
+from scripts.utils.metrics import StageMetrics
+from scripts.utils.review_cache import ReviewCache, make_cache_key
 from scripts.utils.token_budget import (
+    BATCH_FILE_MAX_TOKENS,
     BUDGET_PER_FILE,
+    BUDGET_PER_PR,
+    COST_LIMIT_PER_PR,
     BudgetTracker,
     chunk_diff,
     estimate_tokens,
@@ -61,9 +73,171 @@ DEFAULT_TEMPERATURE = 0
 MAX_RETRIES = 3
 RETRY_BASE_DELAY = 2.0  # seconds
 
+# Number of files reviewed in parallel by review_pr().  Each worker issues
+# its own call_anthropic_api() request; 8 keeps us well under the default
+# Anthropic requests-per-minute limit while hiding most per-file latency.
+DEFAULT_CONCURRENCY = 8
+
 # C++ file extensions eligible for LLM review.
 _CPP_EXTENSIONS = {".cpp", ".h", ".inl", ".hpp", ".cc", ".cxx", ".hxx"}
 
+# ---------------------------------------------------------------------------
+# Model routing
+# ---------------------------------------------------------------------------
+
+# Files scoring at or above this complexity use the strong model
+# (overridable via gate_config.yml `stage3_complexity_threshold`).
+DEFAULT_COMPLEXITY_THRESHOLD = 40.0
+
+# Complexity score weights: per added line, per 100 estimated diff
+# tokens, and per Tier-1 checklist pattern hit on an added line.  A
+# ~20-line mechanical edit stays under the default threshold; a
+# 100-line change or one with several checklist hits crosses it.
+_SCORE_PER_ADDED_LINE = 0.5
+_SCORE_PER_100_TOKENS = 1.0
+_SCORE_PER_CHECKLIST_HIT = 5.0
+
+
+class ModelRouter:
+    """Routes each review unit to a fast or strong model by complexity.
+
+    Most reviewed files are trivial edits where a fast/cheap model's
+    latency and price do fine; the strong model is reserved for changes
+    whose size, token weight, or checklist-flagged constructs warrant
+    it.  Files under configured high-risk paths always get the strong
+    model regardless of score, and a batched unit uses the strong model
+    when any member does.
+
+    Args:
+        strong_model: Model ID for complex changes (the ``--model``
+            default).
+        fast_model: Model ID for low-complexity diffs.
+        threshold: Complexity score at which a file routes to the
+            strong model.
+        high_risk_patterns: Path regexes that force the strong model.
+        checklist_rules: Compiled Tier-1 rules (checker shape, see
+            ``scripts.utils.checklist_cache.compile_rules``) whose hits
+            raise the score.
+    """
+
+    def __init__(
+        self,
+        strong_model: str,
+        fast_model: str,
+        threshold: float = DEFAULT_COMPLEXITY_THRESHOLD,
+        high_risk_patterns: Optional[List[str]] = None,
+        checklist_rules: Optional[List[Dict[str, Any]]] = None,
+    ) -> None:
+        self.strong_model = strong_model
+        self.fast_model = fast_model
+        self.threshold = threshold
+        self._high_risk: List[Any] = []
+        for pattern in high_risk_patterns or []:
+            try:
+                self._high_risk.append(re.compile(pattern))
+            except re.error as e:
+                print(
+                    f"Warning: Invalid high-risk path pattern "
+                    f"{pattern!r} ignored: {e}",
+                    file=sys.stderr,
+                )
+        self._rules = checklist_rules or []
+
+    @classmethod
+    def from_configs(
+        cls,
+        strong_model: str,
+        gate_config_path: str,
+        checklist_path: Optional[str] = None,
+    ) -> Optional["ModelRouter"]:
+        """Build a router from gate_config.yml (None when disabled).
+
+        Routing is enabled by setting ``stage3_fast_model`` in the gate
+        config; an empty value, a missing config, or a read error all
+        return None so the caller pins every file to *strong_model* —
+        the pre-routing behavior.
+
+        Args:
+            strong_model: Model ID for complex changes.
+            gate_config_path: Path to gate_config.yml.
+            checklist_path: Optional checklist.yml whose Tier-1
+                patterns weight the complexity score.
+
+        Returns:
+            A configured ModelRouter, or None when routing is disabled.
+        """
+        try:
+            with open(gate_config_path, encoding="utf-8") as f:
+                config = yaml.safe_load(f) or {}
+        except (OSError, yaml.YAMLError) as e:
+            print(
+                f"Warning: Could not read gate config {gate_config_path} "
+                f"({e}) — model routing disabled",
+                file=sys.stderr,
+            )
+            return None
+
+        fast_model = str(config.get("stage3_fast_model") or "").strip()
+        if not fast_model:
+            return None
+
+        threshold = float(
+            config.get(
+                "stage3_complexity_threshold", DEFAULT_COMPLEXITY_THRESHOLD
+            )
+        )
+        high_risk = config.get("stage3_strong_model_paths") or []
+
+        rules: List[Dict[str, Any]] = []
+        if checklist_path:
+            try:
+                rules = compile_rules(load_tier1_rules(checklist_path))
+            except (FileNotFoundError, ValueError) as e:
+                print(
+                    f"Warning: Checklist unavailable for model routing "
+                    f"({e}) — scoring without Tier-1 weighting",
+                    file=sys.stderr,
+                )
+
+        return cls(
+            strong_model,
+            fast_model,
+            threshold=threshold,
+            high_risk_patterns=high_risk,
+            checklist_rules=rules,
+        )
+
+    def is_high_risk(self, file_path: str) -> bool:
+        """Return True when *file_path* matches a high-risk pattern."""
+        return any(p.search(file_path) for p in self._high_risk)
+
+    def score_file(self, file_path: str, diff_text: str) -> float:
+        """Complexity score for one file's reconstructed diff."""
+        added = [
+            line[1:]
+            for line in diff_text.split("\n")
+            if line.startswith("+") and not line.startswith("+++")
+        ]
+        score = _SCORE_PER_ADDED_LINE * len(added)
+        score += estimate_tokens(diff_text) / 100.0 * _SCORE_PER_100_TOKENS
+        for rule in self._rules:
+            compiled = rule["compiled"]
+            for line in added:
+                if compiled.search(line):
+                    score += _SCORE_PER_CHECKLIST_HIT
+        return score
+
+    def model_for_unit(
+        self, unit: List[Tuple[str, str, Optional[str]]]
+    ) -> str:
+        """Pick the model for a review unit (file or batch)."""
+        for file_path, diff_text, _full_source in unit:
+            if self.is_high_risk(file_path):
+                return self.strong_model
+            if self.score_file(file_path, diff_text) >= self.threshold:
+                return self.strong_model
+        return self.fast_model
+
 # ---------------------------------------------------------------------------
 # System prompt
 # ---------------------------------------------------------------------------
@@ -203,6 +377,120 @@ def build_user_message(
     return "\n".join(parts)
 
 
+def build_user_content(
+    file_path: str,
+    diff_text: str,
+    full_source: Optional[str] = None,
+) -> Any:
+    """Build user content with a prompt-cache breakpoint after full source.
+
+    Splits the text of :func:`build_user_message` into two content
+    blocks so the full-source block carries ``cache_control`` — repeat
+    calls for the same file (chunk retries, reruns within the cache
+    TTL) read the source as cached tokens instead of resending it.
+    The concatenated block text is byte-identical to the single-string
+    message, so token estimates and review-cache keys are unaffected.
+
+    Args:
+        file_path: Path of the file being reviewed.
+        diff_text: Unified diff text for this file.
+        full_source: Optional full file source.
+
+    Returns:
+        A plain string when there is no full source (nothing stable to
+        cache beyond the system prompt), otherwise a list of content
+        blocks for the Messages API.
+    """
+    if full_source is None:
+        return build_user_message(file_path, diff_text)
+
+    head = [
+        f"## 파일: `{file_path}`\n",
+        "### 전체 소스\n```cpp\n",
+        full_source,
+        "\n```\n",
+    ]
+    tail = [
+        "### Diff (변경 사항)\n```diff\n",
+        diff_text,
+        "\n```\n",
+        "위 diff를 코드 리뷰하고 JSON 배열로 결과를 반환하세요.",
+    ]
+    return [
+        {
+            "type": "text",
+            "text": "\n".join(head),
+            "cache_control": {"type": "ephemeral"},
+        },
+        {"type": "text", "text": "\n" + "\n".join(tail)},
+    ]
+
+
+def build_batch_user_message(
+    items: List[Tuple[str, str, Optional[str]]],
+) -> str:
+    """Build one user message covering several small file diffs.
+
+    Each file gets the same section layout as :func:`build_user_message`;
+    the closing instruction tells the model to return a single JSON
+    array and to fill the ``file`` field of every finding with the exact
+    path of the file it belongs to.
+
+    Args:
+        items: List of (file_path, diff_text, full_source) tuples.
+
+    Returns:
+        User message string covering all files in the batch.
+    """
+    parts: List[str] = []
+    for file_path, diff_text, full_source in items:
+        parts.append(f"## 파일: `{file_path}`\n")
+        if full_source is not None:
+            parts.append("### 전체 소스\n```cpp\n")
+            parts.append(full_source)
+            parts.append("\n```\n")
+        parts.append("### Diff (변경 사항)\n```diff\n")
+        parts.append(diff_text)
+        parts.append("\n```\n")
+
+    parts.append(
+        f"위 {len(items)}개 파일의 diff를 각각 코드 리뷰하고, "
+        "모든 지적을 하나의 JSON 배열로 반환하세요. "
+        '각 항목의 "file" 필드에는 해당 지적이 속한 파일 경로를 '
+        "위에 표기된 그대로 기입하세요."
+    )
+    return "\n".join(parts)
+
+
+def exclusion_keys(findings: List[Dict[str, Any]]) -> Set[Tuple[str, int]]:
+    """Build (file, line) exclusion keys from in-memory findings.
+
+    Same key scheme as :func:`load_exclude_findings`, but for findings
+    that are already Python objects (single-job pipeline mode) instead
+    of JSON artifact files.
+
+    Args:
+        findings: Finding dicts from earlier stages.
+
+    Returns:
+        Set of (file, line) tuples to exclude.
+    """
+    excluded: Set[Tuple[str, int]] = set()
+    for finding in findings:
+        if not isinstance(finding, dict):
+            continue
+        file = finding.get("file", "")
+        if not isinstance(file, str):
+            continue
+        try:
+            line = int(finding.get("line", 0))
+        except (TypeError, ValueError):
+            continue
+        if file and line > 0:
+            excluded.add((file, line))
+    return excluded
+
+
 def load_exclude_findings(file_paths: List[str]) -> Set[Tuple[str, int]]:
     """Load findings from Stage 1/2 to exclude from Stage 3 review.
 
@@ -229,18 +517,7 @@ def load_exclude_findings(file_paths: List[str]) -> Set[Tuple[str, int]]:
             data = json.loads(path.read_text(encoding="utf-8", errors="replace"))
             if not isinstance(data, list):
                 continue
-            for finding in data:
-                if not isinstance(finding, dict):
-                    continue
-                file = finding.get("file", "")
-                if not isinstance(file, str):
-                    continue
-                try:
-                    line = int(finding.get("line", 0))
-                except (TypeError, ValueError):
-                    continue
-                if file and line > 0:
-                    excluded.add((file, line))
+            excluded |= exclusion_keys(data)
         except (json.JSONDecodeError, OSError) as e:
             logger.warning("Failed to load exclude findings from %s: %s", fp, e)
 
@@ -383,6 +660,75 @@ def _try_parse_json_array(text: str) -> Optional[List[Dict[str, Any]]]:
     return None
 
 
+class StreamingFindingsParser:
+    """Incrementally extract finding objects from a streamed response.
+
+    Extends the tolerant extraction strategy of
+    :func:`parse_llm_response` to text that arrives in deltas:
+    :meth:`feed` scans the accumulated buffer for complete top-level
+    JSON objects and emits each finding-shaped one exactly once,
+    without waiting for the array's closing ``]`` (or the end of the
+    stream).  Markdown fences and prose around the array are ignored
+    because extraction anchors on ``{``, not on the array itself.
+
+    :meth:`finish` re-parses the complete buffer with
+    :func:`parse_llm_response` as the authoritative result and returns
+    the findings not already emitted, so streamed and non-streamed
+    parses of the same response always agree.
+    """
+
+    _FINDING_KEYS = {"line", "message"}
+
+    def __init__(self) -> None:
+        self._buffer = ""
+        self._pos = 0
+        self._decoder = json.JSONDecoder()
+        self.emitted: List[Dict[str, Any]] = []
+
+    def reset(self) -> None:
+        """Discard all buffered state.
+
+        Called by :func:`call_anthropic_api` before each streamed
+        attempt so that deltas from an aborted, retried stream are not
+        mixed into the next one.
+        """
+        self._buffer = ""
+        self._pos = 0
+        self.emitted = []
+
+    def feed(self, delta: str) -> List[Dict[str, Any]]:
+        """Consume a text delta; return findings completed by it."""
+        self._buffer += delta
+        new_findings: List[Dict[str, Any]] = []
+        while True:
+            start = self._buffer.find("{", self._pos)
+            if start == -1:
+                break
+            try:
+                obj, end = self._decoder.raw_decode(self._buffer, start)
+            except ValueError:
+                # Object still incomplete — wait for more deltas.
+                break
+            self._pos = end
+            if isinstance(obj, dict) and (self._FINDING_KEYS & obj.keys()):
+                new_findings.append(obj)
+        self.emitted.extend(new_findings)
+        return new_findings
+
+    def finish(self) -> List[Dict[str, Any]]:
+        """Finalize the stream; return findings not yet emitted."""
+        final = parse_llm_response(self._buffer)
+        if final[: len(self.emitted)] == self.emitted:
+            return final[len(self.emitted):]
+        # Incremental extraction disagreed with the full parse (e.g. a
+        # stray non-array object in prose) — diff by value instead.
+        remaining = list(final)
+        for f in self.emitted:
+            if f in remaining:
+                remaining.remove(f)
+        return remaining
+
+
 def validate_finding(finding: Dict[str, Any], file_path: str) -> Dict[str, Any]:
     """Normalize and validate a single finding from LLM output.
 
@@ -445,26 +791,221 @@ def validate_finding(finding: Dict[str, Any], file_path: str) -> Dict[str, Any]:
     return normalized
 
 
+def _match_batch_file(raw_file: Any, batch_files: List[str]) -> Optional[str]:
+    """Map an LLM-returned file path to one of the batch's files.
+
+    The model may return path variants (``b/Source/...``, ``./Source/...``
+    or just the basename).  Tries exact match first, then prefix-stripped
+    match, then an unambiguous suffix match.
+
+    Args:
+        raw_file: ``file`` value from a raw finding.
+        batch_files: Canonical paths of the files in the batch.
+
+    Returns:
+        The matching canonical path, or None when no unambiguous match
+        exists.
+    """
+    if not isinstance(raw_file, str) or not raw_file:
+        return None
+
+    if raw_file in batch_files:
+        return raw_file
+
+    stripped = raw_file
+    for prefix in ("a/", "b/", "./"):
+        if stripped.startswith(prefix):
+            stripped = stripped[len(prefix):]
+            break
+    if stripped in batch_files:
+        return stripped
+
+    # Suffix match (e.g. basename only) — accept only if unambiguous.
+    candidates = [
+        bf for bf in batch_files
+        if bf.endswith("/" + stripped) or stripped.endswith("/" + bf)
+    ]
+    if len(candidates) == 1:
+        return candidates[0]
+    return None
+
+
+def attribute_batch_findings(
+    findings: List[Dict[str, Any]],
+    batch_files: List[str],
+) -> Dict[str, List[Dict[str, Any]]]:
+    """Attribute raw batch-response findings back to their files.
+
+    Findings whose ``file`` value cannot be matched to a batch member
+    are dropped with a warning — a comment anchored to the wrong file
+    is worse than a missing one.  Matched findings are normalized via
+    :func:`validate_finding` with the canonical path.
+
+    Args:
+        findings: Raw findings parsed from the batch LLM response.
+        batch_files: Canonical paths of the files in the batch.
+
+    Returns:
+        Mapping of every batch file to its (possibly empty) list of
+        validated findings.
+    """
+    per_file: Dict[str, List[Dict[str, Any]]] = {fp: [] for fp in batch_files}
+    for finding in findings:
+        if not isinstance(finding, dict):
+            continue
+        target = _match_batch_file(finding.get("file"), batch_files)
+        if target is None:
+            logger.warning(
+                "Dropping batch finding with unattributable file %r",
+                finding.get("file"),
+            )
+            continue
+        per_file[target].append(validate_finding(finding, target))
+    return per_file
+
+
+class _RateLimitGate:
+    """Shared pause signal so parallel workers back off together.
+
+    When one worker receives a 429 from the API it registers a hold;
+    every worker calls :meth:`wait` before issuing a request, so new
+    requests are not fired into a window where the rate limit is known
+    to be exhausted.
+    """
+
+    def __init__(self) -> None:
+        self._resume_at = 0.0
+        self._lock = threading.Lock()
+
+    def hold(self, delay: float) -> None:
+        """Pause all request issuance for *delay* seconds from now."""
+        with self._lock:
+            self._resume_at = max(self._resume_at, time.monotonic() + delay)
+
+    def wait(self) -> None:
+        """Block until any active rate-limit hold has expired."""
+        while True:
+            with self._lock:
+                remaining = self._resume_at - time.monotonic()
+            if remaining <= 0:
+                return
+            time.sleep(min(remaining, 1.0))
+
+
+_rate_limit_gate = _RateLimitGate()
+
+# Wall time of each successful API call, recorded by call_anthropic_api
+# and drained by main() into the metrics artifact. Module-level so the
+# recording needs no plumbing through review_file/review_batch.
+_api_latency_lock = threading.Lock()
+_api_latencies: List[float] = []
+
+
+def _record_api_latency(seconds: float) -> None:
+    with _api_latency_lock:
+        _api_latencies.append(seconds)
+
+
+def drain_api_latencies() -> List[float]:
+    """Return and clear the recorded per-call API latencies."""
+    with _api_latency_lock:
+        drained = list(_api_latencies)
+        _api_latencies.clear()
+    return drained
+
+
+def _read_sse_response(
+    resp: Any,
+    stream_parser: Optional["StreamingFindingsParser"] = None,
+    usage_out: Optional[Dict[str, int]] = None,
+) -> Tuple[str, int, int]:
+    """Consume a streaming Messages API response (server-sent events).
+
+    Accumulates ``content_block_delta`` text (feeding each delta to
+    *stream_parser* when given) and picks up token usage from the
+    ``message_start`` / ``message_delta`` events.
+
+    Args:
+        resp: The open HTTP response object (iterable of byte lines).
+        stream_parser: Optional incremental parser fed with each delta.
+        usage_out: Optional dict updated with the raw usage fields
+            (including prompt-cache token counts) from the stream.
+
+    Returns:
+        Tuple of (response_text, input_tokens, output_tokens).
+
+    Raises:
+        RuntimeError: When the stream carries an ``error`` event.
+    """
+    text_parts: List[str] = []
+    input_tokens = 0
+    output_tokens = 0
+
+    for raw_line in resp:
+        line = raw_line.decode("utf-8", errors="replace").strip()
+        if not line.startswith("data:"):
+            continue
+        try:
+            event = json.loads(line[len("data:"):].strip())
+        except json.JSONDecodeError:
+            continue
+        event_type = event.get("type")
+        if event_type == "message_start":
+            usage = event.get("message", {}).get("usage", {})
+            input_tokens = usage.get("input_tokens", 0)
+            if usage_out is not None:
+                usage_out.update(usage)
+        elif event_type == "content_block_delta":
+            delta = event.get("delta", {})
+            if delta.get("type") == "text_delta":
+                piece = delta.get("text", "")
+                text_parts.append(piece)
+                if stream_parser is not None:
+                    stream_parser.feed(piece)
+        elif event_type == "message_delta":
+            usage = event.get("usage", {})
+            output_tokens = usage.get("output_tokens", output_tokens)
+        elif event_type == "error":
+            raise RuntimeError(f"API stream error: {event.get('error')}")
+
+    return "".join(text_parts), input_tokens, output_tokens
+
+
 def call_anthropic_api(
     system_prompt: str,
-    user_message: str,
+    user_message: Any,
     *,
     model: str = DEFAULT_MODEL,
     max_tokens: int = DEFAULT_MAX_TOKENS,
     temperature: int = DEFAULT_TEMPERATURE,
     api_key: Optional[str] = None,
     api_url: Optional[str] = None,
+    stream: bool = False,
+    stream_parser: Optional["StreamingFindingsParser"] = None,
+    usage_out: Optional[Dict[str, int]] = None,
 ) -> Tuple[str, int, int]:
     """Call the Anthropic Messages API.
 
     Args:
-        system_prompt: System message content.
-        user_message: User message content.
+        system_prompt: System message content.  Sent as a content
+            block with a ``cache_control`` breakpoint so repeat calls
+            within a PR read it from the provider's prompt cache.
+        user_message: User message content — a plain string or a list
+            of content blocks (see :func:`build_user_content`).
         model: Model ID.
         max_tokens: Max output tokens.
         temperature: Sampling temperature.
         api_key: API key (defaults to ANTHROPIC_API_KEY env var).
         api_url: Optional base URL override.
+        stream: Use server-sent-event streaming.  The return value is
+            unchanged; text deltas are additionally fed to
+            *stream_parser* as they arrive.
+        stream_parser: Incremental parser receiving deltas (stream
+            only).  It is reset before each attempt so retried streams
+            start clean.
+        usage_out: Optional dict updated with the response's raw usage
+            fields, including ``cache_read_input_tokens`` and
+            ``cache_creation_input_tokens``.
 
     Returns:
         Tuple of (response_text, input_tokens, output_tokens).
@@ -489,9 +1030,19 @@ def call_anthropic_api(
         "model": model,
         "max_tokens": max_tokens,
         "temperature": temperature,
-        "system": system_prompt,
+        # Cache breakpoint on the system prompt (checklist included) —
+        # every call in the PR after the first reads it at 0.1x cost.
+        "system": [
+            {
+                "type": "text",
+                "text": system_prompt,
+                "cache_control": {"type": "ephemeral"},
+            }
+        ],
         "messages": [{"role": "user", "content": user_message}],
     }
+    if stream:
+        payload["stream"] = True
 
     headers = {
         "Content-Type": "application/json",
@@ -503,9 +1054,17 @@ def call_anthropic_api(
 
     last_error: Optional[Exception] = None
     for attempt in range(MAX_RETRIES + 1):
+        _rate_limit_gate.wait()
+        if stream and stream_parser is not None:
+            stream_parser.reset()
+        attempt_start = time.perf_counter()
         try:
             req = urllib.request.Request(url, data=data, headers=headers, method="POST")
             with urllib.request.urlopen(req, timeout=120) as resp:
+                if stream:
+                    result = _read_sse_response(resp, stream_parser, usage_out)
+                    _record_api_latency(time.perf_counter() - attempt_start)
+                    return result
                 raw_body = resp.read().decode("utf-8")
                 try:
                     body = json.loads(raw_body)
@@ -523,7 +1082,10 @@ def call_anthropic_api(
             usage = body.get("usage", {})
             input_tokens = usage.get("input_tokens", 0)
             output_tokens = usage.get("output_tokens", 0)
+            if usage_out is not None:
+                usage_out.update(usage)
 
+            _record_api_latency(time.perf_counter() - attempt_start)
             return text, input_tokens, output_tokens
 
         except urllib.error.HTTPError as e:
@@ -533,6 +1095,9 @@ def call_anthropic_api(
             if status == 429 or status >= 500:
                 if attempt < MAX_RETRIES:
                     delay = RETRY_BASE_DELAY * (2**attempt)
+                    if status == 429:
+                        # Hold back parallel workers too, not just this one.
+                        _rate_limit_gate.hold(delay)
                     logger.warning(
                         "API error %d on attempt %d, retrying in %.1fs...",
                         status,
@@ -579,9 +1144,17 @@ def review_file(
     model: str = DEFAULT_MODEL,
     api_key: Optional[str] = None,
     api_url: Optional[str] = None,
+    cache: Optional[ReviewCache] = None,
+    stream: bool = False,
 ) -> List[Dict[str, Any]]:
     """Review a single file using the LLM.
 
+    When *cache* is provided, a content-hash lookup is done first and a
+    hit replays the stored findings without any API call.  Cached
+    entries hold validated-but-unfiltered findings, so the current
+    run's exclusion set is always applied on replay.  Only complete
+    reviews (no budget skips, no API errors) are written back.
+
     Args:
         file_path: Path of the file.
         diff_text: Unified diff text for the file.
@@ -592,10 +1165,23 @@ def review_file(
         model: Model ID.
         api_key: API key.
         api_url: API base URL.
+        cache: Optional persistent review cache.
+        stream: Use streaming API responses with incremental parsing.
 
     Returns:
         List of validated findings for this file.
     """
+    cache_key = None
+    if cache is not None:
+        cache_key = make_cache_key(
+            file_path, diff_text, system_prompt, model, full_source
+        )
+        cached = cache.get(cache_key)
+        if cached is not None:
+            logger.info("Cache hit for %s — skipping API call", file_path)
+            budget.record_file_reviewed()
+            return filter_excluded(cached, excluded)
+
     # Check budget
     user_msg = build_user_message(file_path, diff_text, full_source)
     system_tokens = estimate_tokens(system_prompt)
@@ -611,9 +1197,11 @@ def review_file(
         chunk_budget = max(BUDGET_PER_FILE - system_tokens - wrapper_overhead, 1000)
         chunks = chunk_diff(diff_text, chunk_budget)
         all_findings: List[Dict[str, Any]] = []
+        unfiltered_findings: List[Dict[str, Any]] = []  # for cache write-back
         file_input_used = 0  # cumulative input tokens for this file
         chunks_reviewed = 0
         file_had_skip = False
+        file_had_error = False
         for i, chunk in enumerate(chunks):
             # Include full source only in first chunk, and only if it fits
             chunk_source = full_source if i == 0 else None
@@ -638,60 +1226,319 @@ def review_file(
                     file_path, file_input_used, chunk_tokens, BUDGET_PER_FILE,
                 )
                 break
-            if not budget.can_review_file(chunk_tokens):
+            if not budget.reserve(chunk_tokens):
                 logger.warning(
                     "Budget exhausted, skipping remaining chunks for %s", file_path
                 )
                 file_had_skip = True
                 break
             try:
+                usage: Dict[str, int] = {}
                 resp_text, actual_input, actual_output = call_anthropic_api(
                     system_prompt,
-                    chunk_msg,
+                    build_user_content(file_path, chunk, chunk_source),
                     model=model,
                     api_key=api_key,
                     api_url=api_url,
+                    stream=stream,
+                    usage_out=usage,
+                )
+                budget.settle(
+                    chunk_tokens,
+                    actual_input,
+                    actual_output,
+                    cache_read_tokens=usage.get("cache_read_input_tokens", 0),
+                    cache_creation_tokens=usage.get(
+                        "cache_creation_input_tokens", 0
+                    ),
+                    model=model,
                 )
-                budget.record_chunk_usage(actual_input, actual_output)
                 file_input_used += actual_input
                 chunks_reviewed += 1
                 findings = parse_llm_response(resp_text)
                 findings = [validate_finding(f, file_path) for f in findings if isinstance(f, dict)]
+                unfiltered_findings.extend(findings)
                 findings = filter_excluded(findings, excluded)
                 all_findings.extend(findings)
             except RuntimeError as e:
+                budget.release(chunk_tokens)
+                file_had_error = True
                 logger.error("API error reviewing %s chunk %d: %s", file_path, i, e)
         if chunks_reviewed > 0:
             budget.record_file_reviewed()
         if file_had_skip and chunks_reviewed == 0:
             budget.record_skip()
+        # Cache only complete reviews — partial chunk coverage must be
+        # retried on the next run.
+        if (
+            cache is not None
+            and cache_key is not None
+            and chunks_reviewed == len(chunks)
+            and not file_had_error
+        ):
+            cache.put(cache_key, file_path, unfiltered_findings)
         return all_findings
 
-    if not budget.can_review_file(total_input):
+    if not budget.reserve(total_input):
         logger.warning("Budget exhausted, skipping file: %s", file_path)
         budget.record_skip()
         return []
 
+    stream_parser = StreamingFindingsParser() if stream else None
     try:
+        usage: Dict[str, int] = {}
         resp_text, actual_input, actual_output = call_anthropic_api(
             system_prompt,
-            user_msg,
+            build_user_content(file_path, diff_text, full_source),
             model=model,
             api_key=api_key,
             api_url=api_url,
+            stream=stream,
+            stream_parser=stream_parser,
+            usage_out=usage,
         )
-        budget.record_usage(actual_input, actual_output)
+        budget.settle(
+            total_input,
+            actual_input,
+            actual_output,
+            cache_read_tokens=usage.get("cache_read_input_tokens", 0),
+            cache_creation_tokens=usage.get("cache_creation_input_tokens", 0),
+            model=model,
+        )
+        budget.record_file_reviewed()
     except RuntimeError as e:
+        budget.release(total_input)
         logger.error("API error reviewing %s: %s", file_path, e)
         return []
 
-    findings = parse_llm_response(resp_text)
+    if stream_parser is not None:
+        findings = stream_parser.emitted + stream_parser.finish()
+    else:
+        findings = parse_llm_response(resp_text)
     findings = [validate_finding(f, file_path) for f in findings if isinstance(f, dict)]
+    if cache is not None and cache_key is not None:
+        cache.put(cache_key, file_path, findings)
     findings = filter_excluded(findings, excluded)
 
     return findings
 
 
+def plan_review_batches(
+    work_items: List[Tuple[str, str, Optional[str]]],
+    system_prompt: str,
+) -> List[List[Tuple[str, str, Optional[str]]]]:
+    """Group small files into batched review units.
+
+    Files whose single-file user message stays under
+    ``BATCH_FILE_MAX_TOKENS`` are packed greedily (in input order, which
+    review_pr keeps sorted) into batches whose combined request stays
+    under ``BUDGET_PER_FILE``; everything else becomes a singleton unit
+    reviewed through the normal per-file path, keeping chunking intact.
+
+    Args:
+        work_items: (file_path, diff_text, full_source) tuples.
+        system_prompt: System prompt (its token count eats into each
+            batch's budget).
+
+    Returns:
+        List of units; each unit is a list of one or more work items.
+    """
+    system_tokens = estimate_tokens(system_prompt)
+    units: List[List[Tuple[str, str, Optional[str]]]] = []
+    current: List[Tuple[str, str, Optional[str]]] = []
+    current_tokens = 0
+
+    for item in work_items:
+        file_path, diff_text, full_source = item
+        item_tokens = estimate_tokens(
+            build_user_message(file_path, diff_text, full_source)
+        )
+        if item_tokens > BATCH_FILE_MAX_TOKENS:
+            units.append([item])
+            continue
+        if current and system_tokens + current_tokens + item_tokens > BUDGET_PER_FILE:
+            units.append(current)
+            current = []
+            current_tokens = 0
+        current.append(item)
+        current_tokens += item_tokens
+
+    if current:
+        units.append(current)
+    return units
+
+
+def review_batch(
+    batch_items: List[Tuple[str, str, Optional[str]]],
+    system_prompt: str,
+    excluded: Set[Tuple[str, int]],
+    budget: BudgetTracker,
+    *,
+    model: str = DEFAULT_MODEL,
+    api_key: Optional[str] = None,
+    api_url: Optional[str] = None,
+    cache: Optional[ReviewCache] = None,
+    stream: bool = False,
+) -> List[Dict[str, Any]]:
+    """Review several small files with a single API call.
+
+    Cache lookups stay per-file (same keys as :func:`review_file`), so a
+    batch member changing does not invalidate its neighbours: hits are
+    replayed up front, only the misses go into the batched request, and
+    the response findings are attributed back and written to each file's
+    own cache entry.
+
+    Args:
+        batch_items: (file_path, diff_text, full_source) tuples.
+        system_prompt: System prompt to use.
+        excluded: Set of (file, line) tuples from earlier stages.
+        budget: Budget tracker instance.
+        model: Model ID.
+        api_key: API key.
+        api_url: API base URL.
+        cache: Optional persistent review cache.
+        stream: Use streaming API responses.
+
+    Returns:
+        List of validated findings across the batch, in batch order.
+    """
+    all_findings: List[Dict[str, Any]] = []
+    pending: List[Tuple[str, str, Optional[str]]] = []
+    cache_keys: Dict[str, str] = {}
+
+    for item in batch_items:
+        file_path, diff_text, full_source = item
+        if cache is not None:
+            key = make_cache_key(
+                file_path, diff_text, system_prompt, model, full_source
+            )
+            cached = cache.get(key)
+            if cached is not None:
+                logger.info("Cache hit for %s — skipping API call", file_path)
+                budget.record_file_reviewed()
+                all_findings.extend(filter_excluded(cached, excluded))
+                continue
+            cache_keys[file_path] = key
+        pending.append(item)
+
+    if not pending:
+        return all_findings
+
+    if len(pending) == 1:
+        # A lone leftover gets the full per-file path (chunking etc.).
+        file_path, diff_text, full_source = pending[0]
+        all_findings.extend(
+            review_file(
+                file_path,
+                diff_text,
+                system_prompt,
+                excluded,
+                budget,
+                full_source=full_source,
+                model=model,
+                api_key=api_key,
+                api_url=api_url,
+                cache=cache,
+                stream=stream,
+            )
+        )
+        return all_findings
+
+    user_msg = build_batch_user_message(pending)
+    total_input = estimate_tokens(system_prompt) + estimate_tokens(user_msg)
+
+    if not budget.reserve(total_input):
+        logger.warning(
+            "Budget exhausted, skipping batch of %d files", len(pending)
+        )
+        for _ in pending:
+            budget.record_skip()
+        return all_findings
+
+    try:
+        usage: Dict[str, int] = {}
+        resp_text, actual_input, actual_output = call_anthropic_api(
+            system_prompt,
+            user_msg,
+            model=model,
+            api_key=api_key,
+            api_url=api_url,
+            stream=stream,
+            usage_out=usage,
+        )
+    except RuntimeError as e:
+        budget.release(total_input)
+        logger.error(
+            "API error reviewing batch of %d files: %s", len(pending), e
+        )
+        return all_findings
+
+    budget.settle(
+        total_input,
+        actual_input,
+        actual_output,
+        cache_read_tokens=usage.get("cache_read_input_tokens", 0),
+        cache_creation_tokens=usage.get("cache_creation_input_tokens", 0),
+        model=model,
+    )
+    for _ in pending:
+        budget.record_file_reviewed()
+
+    batch_files = [fp for fp, _, _ in pending]
+    raw = parse_llm_response(resp_text)
+    per_file = attribute_batch_findings(raw, batch_files)
+
+    for file_path in batch_files:
+        findings = per_file[file_path]
+        if cache is not None and file_path in cache_keys:
+            # An empty list is a valid "clean file" result.
+            cache.put(cache_keys[file_path], file_path, findings)
+        all_findings.extend(filter_excluded(findings, excluded))
+
+    return all_findings
+
+
+def _review_unit(
+    unit: List[Tuple[str, str, Optional[str]]],
+    system_prompt: str,
+    excluded: Set[Tuple[str, int]],
+    budget: BudgetTracker,
+    *,
+    model: str,
+    api_key: Optional[str],
+    api_url: Optional[str],
+    cache: Optional[ReviewCache],
+    stream: bool = False,
+) -> List[Dict[str, Any]]:
+    """Dispatch a review unit to the per-file or batched path."""
+    if len(unit) == 1:
+        file_path, diff_text, full_source = unit[0]
+        return review_file(
+            file_path,
+            diff_text,
+            system_prompt,
+            excluded,
+            budget,
+            full_source=full_source,
+            model=model,
+            api_key=api_key,
+            api_url=api_url,
+            cache=cache,
+            stream=stream,
+        )
+    return review_batch(
+        unit,
+        system_prompt,
+        excluded,
+        budget,
+        model=model,
+        api_key=api_key,
+        api_url=api_url,
+        cache=cache,
+        stream=stream,
+    )
+
+
 def review_pr(
     diff_text: str,
     *,
@@ -701,29 +1548,100 @@ def review_pr(
     model: str = DEFAULT_MODEL,
     api_key: Optional[str] = None,
     api_url: Optional[str] = None,
+    concurrency: int = DEFAULT_CONCURRENCY,
+    cache_dir: Optional[str] = None,
+    batch_small_files: bool = False,
+    stream: bool = False,
+    on_findings: Optional[Callable[[List[Dict[str, Any]]], None]] = None,
+    parsed_diff: Optional[Dict[str, FileDiff]] = None,
+    exclude_findings: Optional[List[Dict[str, Any]]] = None,
+    include_files: Optional[List[str]] = None,
+    max_budget_tokens: Optional[int] = None,
+    max_budget_cost: Optional[float] = None,
+    router: Optional[ModelRouter] = None,
 ) -> Tuple[List[Dict[str, Any]], dict]:
     """Review all files in a PR diff.
 
+    Files are reviewed by a worker pool of *concurrency* threads (each
+    review is an independent API round-trip, so this is I/O-bound).
+    Findings are collected per file and concatenated in sorted file
+    order, so the output is deterministic regardless of completion
+    order.  Pass ``concurrency=1`` to force strictly sequential review.
+
+    With *batch_small_files*, small diffs are packed into shared API
+    requests (see :func:`plan_review_batches`), cutting both request
+    count and repeated system-prompt input tokens on many-small-files
+    PRs.  Large files keep the individual per-file path.
+
     Args:
         diff_text: Full PR unified diff text.
         has_compile_commands: Whether compile_commands.json exists.
         exclude_files: Paths to Stage 1/2 finding JSON files.
-        source_dir: Path to the source directory for full file context.
+        source_dir: Path to the source directory for file context.
+            Small files are sent whole; large files are reduced to the
+            function/class scopes enclosing the changed lines (see
+            scripts.utils.context_extractor).
         model: Model ID.
         api_key: API key.
         api_url: API base URL.
+        concurrency: Number of files reviewed in parallel.
+        cache_dir: Optional directory for the persistent review cache.
+            Unchanged files whose cached review is still valid skip the
+            API entirely (see scripts.utils.review_cache).
+        batch_small_files: Pack small file diffs into shared API calls.
+        stream: Use streaming API responses (the result is identical;
+            responses are parsed incrementally as deltas arrive).
+        on_findings: Optional callback invoked with each review unit's
+            filtered findings as soon as that unit completes — in
+            completion order, not file order — so a pipelined consumer
+            (e.g. :func:`scripts.post_review.post_review_streaming`)
+            can start posting while later files are still in review.
+            The returned findings list keeps sorted file order either
+            way.
+        parsed_diff: Pre-parsed diff data (e.g. loaded from the gate's
+            parsed-diff artifact). When given, *diff_text* is ignored
+            and not re-parsed.
+        exclude_findings: In-memory Stage 1/2 findings to exclude
+            (single-job pipeline mode); merged with *exclude_files*.
+        include_files: Optional allow-list restricting the review to a
+            subset of the diff (a gate-computed shard); files outside
+            the list are ignored entirely, not counted as skipped.
+        max_budget_tokens: Optional per-run input token budget override
+            (default: ``BUDGET_PER_PR``) — shard runs divide the PR
+            budget between themselves.
+        max_budget_cost: Optional per-run USD cost cap override
+            (default: ``COST_LIMIT_PER_PR``).
+        router: Optional :class:`ModelRouter` sending low-complexity
+            units to a fast/cheap model; without one, every unit is
+            pinned to *model*.  Per-model usage shows up in the budget
+            summary's ``per_model`` section.
 
     Returns:
-        Tuple of (all_findings, budget_summary).
+        Tuple of (all_findings, budget_summary).  The budget summary
+        includes cache hit/miss counters when caching is enabled.
     """
     system_prompt = build_system_prompt(has_compile_commands)
     excluded = load_exclude_findings(exclude_files or [])
-    budget = BudgetTracker()
+    if exclude_findings:
+        excluded |= exclusion_keys(exclude_findings)
+    budget = BudgetTracker(
+        max_tokens=(
+            max_budget_tokens if max_budget_tokens else BUDGET_PER_PR
+        ),
+        max_cost=max_budget_cost if max_budget_cost else COST_LIMIT_PER_PR,
+    )
+    cache = ReviewCache(cache_dir) if cache_dir else None
+    included = set(include_files) if include_files is not None else None
 
-    parsed = parse_diff(diff_text)
-    all_findings: List[Dict[str, Any]] = []
+    parsed = parsed_diff if parsed_diff is not None else parse_diff(diff_text)
 
+    # Collect reviewable work items up front (sorted for determinism).
+    work_items: List[Tuple[str, str, Optional[str]]] = []
     for file_path, file_diff in sorted(parsed.items()):
+        # Outside this run's shard — another matrix job reviews it
+        if included is not None and file_path not in included:
+            continue
+
         # Skip non-C++ files
         ext = Path(file_path).suffix.lower()
         if ext not in _CPP_EXTENSIONS:
@@ -738,7 +1656,11 @@ def review_pr(
         if not file_diff_text.strip():
             continue
 
-        # Try to load full source
+        # Try to load source context.  Large files are reduced to the
+        # blocks enclosing the changed lines (plus includes and UE
+        # reflection declarations) — sending 8k lines of gameplay class
+        # for a 10-line diff burns the per-file budget on code the
+        # model does not need.
         full_source = None
         if source_dir:
             source_path = Path(source_dir) / file_path
@@ -747,21 +1669,95 @@ def review_pr(
                     full_source = source_path.read_text(encoding="utf-8", errors="replace")
                 except OSError:
                     pass
+                else:
+                    full_source = extract_review_context(
+                        full_source, file_diff.added_lines.keys()
+                    )
 
-        findings = review_file(
-            file_path,
-            file_diff_text,
-            system_prompt,
-            excluded,
-            budget,
-            full_source=full_source,
-            model=model,
-            api_key=api_key,
-            api_url=api_url,
-        )
-        all_findings.extend(findings)
+        work_items.append((file_path, file_diff_text, full_source))
 
-    return all_findings, budget.summary()
+    # Group into review units: singletons, or multi-file batches when
+    # batching is enabled.  Units preserve sorted file order.
+    if batch_small_files:
+        units = plan_review_batches(work_items, system_prompt)
+    else:
+        units = [[item] for item in work_items]
+
+    all_findings: List[Dict[str, Any]] = []
+
+    if concurrency <= 1 or len(units) <= 1:
+        for unit in units:
+            unit_findings = _review_unit(
+                unit,
+                system_prompt,
+                excluded,
+                budget,
+                model=(
+                    router.model_for_unit(unit)
+                    if router is not None
+                    else model
+                ),
+                api_key=api_key,
+                api_url=api_url,
+                cache=cache,
+                stream=stream,
+            )
+            if on_findings is not None:
+                on_findings(unit_findings)
+            all_findings.extend(unit_findings)
+        return _finish_pr_review(all_findings, budget, cache)
+
+    # Parallel path — BudgetTracker is thread-safe and reservation-based,
+    # so workers share it directly; results are collected per unit and
+    # flattened in submission (= sorted file) order.
+    max_workers = min(concurrency, len(units))
+    with ThreadPoolExecutor(max_workers=max_workers) as executor:
+        futures = [
+            executor.submit(
+                _review_unit,
+                unit,
+                system_prompt,
+                excluded,
+                budget,
+                model=(
+                    router.model_for_unit(unit)
+                    if router is not None
+                    else model
+                ),
+                api_key=api_key,
+                api_url=api_url,
+                cache=cache,
+                stream=stream,
+            )
+            for unit in units
+        ]
+        if on_findings is not None:
+            # Hand findings off as units complete; keep the returned
+            # list in submission order regardless.
+            ordered: Dict[Any, List[Dict[str, Any]]] = {}
+            for future in as_completed(futures):
+                result = future.result()
+                ordered[future] = result
+                on_findings(result)
+            for future in futures:
+                all_findings.extend(ordered[future])
+        else:
+            for future in futures:
+                all_findings.extend(future.result())
+
+    return _finish_pr_review(all_findings, budget, cache)
+
+
+def _finish_pr_review(
+    all_findings: List[Dict[str, Any]],
+    budget: BudgetTracker,
+    cache: Optional[ReviewCache],
+) -> Tuple[List[Dict[str, Any]], dict]:
+    """Assemble the (findings, summary) result for review_pr."""
+    summary = budget.summary()
+    if cache is not None:
+        summary.update(cache.summary())
+    return all_findings, summary
 
 
 def _reconstruct_file_diff(file_diff) -> str:
@@ -808,13 +1804,32 @@ def main(argv: Optional[List[str]] = None) -> int:
     )
     parser.add_argument(
         "--diff",
-        required=True,
         help="Path to the PR unified diff file",
     )
+    parser.add_argument(
+        "--parsed-diff",
+        help=(
+            "Path to a parsed-diff JSON artifact (written by "
+            "gate_checker --parsed-diff-output). Skips re-parsing "
+            "the raw diff."
+        ),
+    )
     parser.add_argument(
         "--checklist",
         default="configs/checklist.yml",
-        help="Path to checklist.yml (currently unused but reserved)",
+        help=(
+            "Path to checklist.yml (Tier-1 patterns weight the "
+            "complexity score when model routing is enabled)"
+        ),
+    )
+    parser.add_argument(
+        "--gate-config",
+        default=None,
+        help=(
+            "Path to gate_config.yml enabling complexity-based model "
+            "routing (stage3_fast_model); omit to pin every file to "
+            "--model"
+        ),
     )
     parser.add_argument(
         "--exclude-findings",
@@ -830,7 +1845,8 @@ def main(argv: Optional[List[str]] = None) -> int:
     )
     parser.add_argument(
         "--source-dir",
-        help="Path to source directory for full file context",
+        help="Path to source directory for file context "
+        "(large files are reduced to the scopes enclosing the changes)",
     )
     parser.add_argument(
         "--output",
@@ -850,6 +1866,64 @@ def main(argv: Optional[List[str]] = None) -> int:
         "--api-url",
         help="Anthropic API base URL override",
     )
+    parser.add_argument(
+        "--concurrency",
+        type=int,
+        default=DEFAULT_CONCURRENCY,
+        help=(
+            f"Number of files reviewed in parallel "
+            f"(default: {DEFAULT_CONCURRENCY}, 1 = sequential)"
+        ),
+    )
+    parser.add_argument(
+        "--cache-dir",
+        default=None,
+        help=(
+            "Directory for the persistent review cache. Files whose "
+            "diff/source/prompt are unchanged since the last run replay "
+            "cached findings instead of calling the API."
+        ),
+    )
+    parser.add_argument(
+        "--batch-small-files",
+        action="store_true",
+        help=(
+            "Pack small file diffs into shared API requests to cut "
+            "request count and repeated system-prompt tokens"
+        ),
+    )
+    parser.add_argument(
+        "--stream",
+        action="store_true",
+        help=(
+            "Use streaming API responses (parsed incrementally as "
+            "deltas arrive; findings are identical to non-streaming)"
+        ),
+    )
+    parser.add_argument(
+        "--metrics-output",
+        default=None,
+        help="Optional path for a structured timing-metrics JSON artifact",
+    )
+    parser.add_argument(
+        "--include-files",
+        default=None,
+        help=(
+            'JSON list restricting review to one gate-computed shard '
+            '(e.g. \'["Source/A.cpp"]\'); other files in the diff are '
+            "left to sibling matrix jobs"
+        ),
+    )
+    parser.add_argument(
+        "--budget-split",
+        type=int,
+        default=1,
+        help=(
+            "Divide the per-PR token/cost budget by N (the shard "
+            "count), so parallel shard jobs respect the combined PR "
+            "budget (default: 1)"
+        ),
+    )
     parser.add_argument(
         "--dry-run",
         action="store_true",
@@ -872,23 +1946,77 @@ def main(argv: Optional[List[str]] = None) -> int:
         print(f"\n=== Prompt tokens (estimated): {estimate_tokens(prompt)} ===")
         return 0
 
-    # Load diff
-    diff_path = Path(args.diff)
-    if not diff_path.exists():
-        print(f"Error: Diff file not found: {args.diff}", file=sys.stderr)
+    # Load diff — prefer the shared parsed artifact when provided
+    parsed = None
+    diff_text = ""
+    if args.parsed_diff:
+        parsed_path = Path(args.parsed_diff)
+        if not parsed_path.exists():
+            print(
+                f"Error: Parsed diff file not found: {args.parsed_diff}",
+                file=sys.stderr,
+            )
+            return 1
+        parsed = load_parsed_diff(parsed_path)
+    elif args.diff:
+        diff_path = Path(args.diff)
+        if not diff_path.exists():
+            print(f"Error: Diff file not found: {args.diff}", file=sys.stderr)
+            return 1
+        diff_text = diff_path.read_text(encoding="utf-8", errors="replace")
+    else:
+        print(
+            "Error: Either --diff or --parsed-diff is required",
+            file=sys.stderr,
+        )
         return 1
 
-    diff_text = diff_path.read_text(encoding="utf-8", errors="replace")
+    include_files: Optional[List[str]] = None
+    if args.include_files is not None:
+        try:
+            include_files = json.loads(args.include_files)
+        except json.JSONDecodeError as e:
+            print(f"Error: Invalid --include-files JSON: {e}", file=sys.stderr)
+            return 1
+        if not isinstance(include_files, list):
+            print(
+                "Error: --include-files must be a JSON list",
+                file=sys.stderr,
+            )
+            return 1
+
+    budget_split = max(args.budget_split, 1)
+    max_budget_tokens = BUDGET_PER_PR // budget_split
+    max_budget_cost = COST_LIMIT_PER_PR / budget_split
+
+    router = None
+    if args.gate_config:
+        router = ModelRouter.from_configs(
+            args.model, args.gate_config, checklist_path=args.checklist
+        )
 
-    findings, budget_summary = review_pr(
-        diff_text,
-        has_compile_commands=has_cc,
-        exclude_files=args.exclude_findings,
-        source_dir=args.source_dir,
-        model=args.model,
-        api_key=args.api_key,
-        api_url=args.api_url,
-    )
+    metrics = StageMetrics("stage3-llm")
+    drain_api_latencies()  # discard samples from any earlier in-process use
+
+    with metrics.timer("review_pr"):
+        findings, budget_summary = review_pr(
+            diff_text,
+            parsed_diff=parsed,
+            has_compile_commands=has_cc,
+            exclude_files=args.exclude_findings,
+            source_dir=args.source_dir,
+            model=args.model,
+            api_key=args.api_key,
+            api_url=args.api_url,
+            concurrency=args.concurrency,
+            cache_dir=args.cache_dir,
+            batch_small_files=args.batch_small_files,
+            stream=args.stream,
+            include_files=include_files,
+            max_budget_tokens=max_budget_tokens,
+            max_budget_cost=max_budget_cost,
+            router=router,
+        )
 
     # Write output
     output = {
@@ -913,6 +2041,26 @@ def main(argv: Optional[List[str]] = None) -> int:
         encoding="utf-8",
     )
 
+    if args.metrics_output:
+        latencies = drain_api_latencies()
+        for latency in latencies:
+            metrics.add_timing("api_call", latency)
+        metrics.incr("api_calls", len(latencies))
+        metrics.incr("findings", len(findings))
+        metrics.incr("files_reviewed", budget_summary.get("files_reviewed", 0))
+        metrics.incr(
+            "files_skipped_budget",
+            budget_summary.get("files_skipped_budget", 0),
+        )
+        metrics.incr(
+            "input_tokens", budget_summary.get("total_input_tokens", 0)
+        )
+        metrics.incr(
+            "output_tokens", budget_summary.get("total_output_tokens", 0)
+        )
+        metrics.set_info("budget", budget_summary)
+        metrics.save(args.metrics_output)
+
     logger.info(
         "Stage 3 complete: %d findings, %d files reviewed, %d files skipped (budget)",
         len(findings),
@@ -926,6 +2074,12 @@ def main(argv: Optional[List[str]] = None) -> int:
         budget_summary["total_cost_usd"],
         budget_summary["total_cost_usd"] + budget_summary["budget_remaining_usd"],
     )
+    if "cache_hits" in budget_summary:
+        logger.info(
+            "Review cache: %d hit(s), %d miss(es)",
+            budget_summary["cache_hits"],
+            budget_summary["cache_misses"],
+        )
 
     return 0
 
@@ -0,0 +1,310 @@
+#!/usr/bin/env python3
+"""Precompiled checklist cache for fast multi-job startup.
+
+configs/checklist.yml is re-parsed and its Tier 1 regexes recompiled on
+every invocation of the pattern checker, and PyYAML's pure-Python loader
+dominates that startup cost.  Since the bot runs on every push, this
+module lets a build step validate the checklist once and serialize the
+pre-parsed rules to a small JSON artifact that later stages load
+instead.
+
+The cached form stores raw pattern strings (compiled ``re.Pattern``
+objects are not portably marshallable); reconstruction is a plain
+``re.compile`` per rule, which is cheap next to the YAML parse and has
+already been validated at build time.  The cache is keyed on a
+fingerprint of checklist.yml — mtime/size as the fast path, content
+hash as the fallback (fresh checkouts get new mtimes for identical
+content) — so a stale or mismatched artifact transparently falls back
+to parsing the YAML.
+
+Usage (build step):
+  python scripts/utils/checklist_cache.py \\
+    --checklist configs/checklist.yml \\
+    --cache checklist-cache.json
+"""
+
+from __future__ import annotations
+
+import argparse
+import hashlib
+import json
+import re
+import sys
+from pathlib import Path
+from typing import Any, Dict, List, Optional
+
+import yaml
+
+# Bumped when the cached rule schema changes — old artifacts are ignored.
+CACHE_SCHEMA_VERSION = 1
+
+
+def _file_fingerprint(path: Path, with_hash: bool = True) -> Dict[str, Any]:
+    """Fingerprint a file for cache validation.
+
+    Args:
+        path: File to fingerprint.
+        with_hash: Include the content SHA-256 (skipped on the fast
+            mtime/size comparison path).
+
+    Returns:
+        Dict with ``mtime_ns``, ``size``, and optionally ``sha256``.
+    """
+    stat = path.stat()
+    fingerprint: Dict[str, Any] = {
+        "mtime_ns": stat.st_mtime_ns,
+        "size": stat.st_size,
+    }
+    if with_hash:
+        fingerprint["sha256"] = hashlib.sha256(path.read_bytes()).hexdigest()
+    return fingerprint
+
+
+def extract_tier1_rules(
+    checklist: Dict[str, Any],
+    checklist_path: str,
+) -> List[Dict[str, Any]]:
+    """Extract and validate Tier 1 rules into a serializable form.
+
+    Every regex is compiled once here so invalid patterns fail the
+    build step rather than a per-push review run.
+
+    Args:
+        checklist: Parsed checklist.yml mapping.
+        checklist_path: Source path (for error messages only).
+
+    Returns:
+        List of JSON-serializable rule dicts.
+
+    Raises:
+        ValueError: If the checklist shape is wrong or a regex is
+            invalid.
+    """
+    if not isinstance(checklist, dict):
+        raise ValueError(
+            f"Checklist file is empty or not a YAML mapping: {checklist_path}"
+        )
+
+    rules: List[Dict[str, Any]] = []
+    for category in checklist.get("categories", []):
+        for item in category.get("items", []):
+            if item.get("tier") != 1 or "pattern" not in item:
+                continue
+
+            try:
+                re.compile(item["pattern"])
+            except re.error as e:
+                raise ValueError(
+                    f"Invalid regex for pattern '{item['id']}': {e}"
+                ) from e
+
+            prev_line_pattern = item.get("prev_line_pattern")
+            if prev_line_pattern is not None:
+                try:
+                    re.compile(prev_line_pattern)
+                except re.error as e:
+                    raise ValueError(
+                        f"Invalid regex for prev_line_pattern "
+                        f"'{item['id']}': {e}"
+                    ) from e
+
+            rules.append(
+                {
+                    "id": item["id"],
+                    "pattern": item["pattern"],
+                    "prev_line_pattern": prev_line_pattern,
+                    "severity": item.get("severity", "warning"),
+                    "summary": item.get("summary", ""),
+                    "description": item.get("description", "").strip(),
+                    "auto_fixable": item.get("auto_fixable", False),
+                    "tags": item.get("tags", []),
+                }
+            )
+
+    return rules
+
+
+def compile_rules(rules: List[Dict[str, Any]]) -> List[Dict[str, Any]]:
+    """Reconstruct compiled pattern dicts from serialized rules.
+
+    Produces the shape the pattern checker works with (``compiled`` /
+    ``prev_compiled`` regex objects alongside the rule metadata).
+
+    Args:
+        rules: Serializable rule dicts from :func:`extract_tier1_rules`
+            (or a cache artifact).
+
+    Returns:
+        List of pattern info dicts with compiled regexes.
+    """
+    patterns: List[Dict[str, Any]] = []
+    for rule in rules:
+        prev_line_pattern = rule.get("prev_line_pattern")
+        patterns.append(
+            {
+                "id": rule["id"],
+                "compiled": re.compile(rule["pattern"]),
+                "raw_pattern": rule["pattern"],
+                "prev_compiled": (
+                    re.compile(prev_line_pattern)
+                    if prev_line_pattern
+                    else None
+                ),
+                "severity": rule.get("severity", "warning"),
+                "summary": rule.get("summary", ""),
+                "description": rule.get("description", ""),
+                "auto_fixable": rule.get("auto_fixable", False),
+                "tags": rule.get("tags", []),
+            }
+        )
+    return patterns
+
+
+def _read_cache(
+    cache_path: Path,
+    checklist_path: Path,
+) -> Optional[List[Dict[str, Any]]]:
+    """Load cached rules if the artifact is valid for *checklist_path*.
+
+    Returns None — silently for a missing artifact, with a stderr
+    warning for a corrupt one — whenever the caller should fall back to
+    parsing the YAML.
+    """
+    if not cache_path.exists():
+        return None
+    try:
+        data = json.loads(cache_path.read_text(encoding="utf-8"))
+    except (OSError, json.JSONDecodeError) as e:
+        print(
+            f"Warning: Could not read checklist cache {cache_path}: {e}",
+            file=sys.stderr,
+        )
+        return None
+
+    if (
+        not isinstance(data, dict)
+        or data.get("schema_version") != CACHE_SCHEMA_VERSION
+        or not isinstance(data.get("rules"), list)
+        or not isinstance(data.get("checklist"), dict)
+    ):
+        return None
+
+    recorded = data["checklist"]
+    current = _file_fingerprint(checklist_path, with_hash=False)
+    if (
+        recorded.get("mtime_ns") == current["mtime_ns"]
+        and recorded.get("size") == current["size"]
+    ):
+        return data["rules"]
+
+    # mtime differs (e.g. a fresh checkout) — fall back to content hash
+    current_hash = hashlib.sha256(checklist_path.read_bytes()).hexdigest()
+    if recorded.get("sha256") == current_hash:
+        return data["rules"]
+
+    return None
+
+
+def _write_cache(
+    cache_path: Path,
+    checklist_path: Path,
+    rules: List[Dict[str, Any]],
+) -> None:
+    """Write the cache artifact atomically; failures are non-fatal."""
+    payload = {
+        "schema_version": CACHE_SCHEMA_VERSION,
+        "checklist": _file_fingerprint(checklist_path),
+        "rules": rules,
+    }
+    tmp_path = cache_path.with_suffix(cache_path.suffix + ".tmp")
+    try:
+        tmp_path.write_text(
+            json.dumps(payload, ensure_ascii=False) + "\n",
+            encoding="utf-8",
+        )
+        tmp_path.replace(cache_path)
+    except OSError as e:
+        print(
+            f"Warning: Could not write checklist cache {cache_path}: {e}",
+            file=sys.stderr,
+        )
+
+
+def load_tier1_rules(
+    checklist_path: str,
+    cache_path: Optional[str] = None,
+) -> List[Dict[str, Any]]:
+    """Load serializable Tier 1 rules, via the cache when valid.
+
+    Args:
+        checklist_path: Path to checklist.yml.
+        cache_path: Optional path to the compiled-checklist artifact.
+            A valid artifact skips the YAML parse; an invalid or stale
+            one is rebuilt in place.
+
+    Returns:
+        List of serializable rule dicts (see :func:`extract_tier1_rules`).
+
+    Raises:
+        FileNotFoundError: If the checklist file doesn't exist.
+        ValueError: If the checklist shape or a regex is invalid.
+    """
+    path = Path(checklist_path)
+    if not path.exists():
+        raise FileNotFoundError(f"Checklist file not found: {checklist_path}")
+
+    if cache_path:
+        cached = _read_cache(Path(cache_path), path)
+        if cached is not None:
+            return cached
+
+    with open(path, "r", encoding="utf-8") as f:
+        checklist = yaml.safe_load(f)
+
+    rules = extract_tier1_rules(checklist, checklist_path)
+
+    if cache_path:
+        _write_cache(Path(cache_path), path, rules)
+
+    return rules
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(
+        description=(
+            "Validate checklist.yml and serialize pre-parsed Tier 1 "
+            "rules to a compiled-checklist cache artifact"
+        )
+    )
+    parser.add_argument(
+        "--checklist",
+        default="configs/checklist.yml",
+        help="Path to checklist.yml (default: configs/checklist.yml)",
+    )
+    parser.add_argument(
+        "--cache",
+        required=True,
+        help="Output path for the compiled-checklist JSON artifact",
+    )
+
+    args = parser.parse_args()
+
+    try:
+        path = Path(args.checklist)
+        if not path.exists():
+            raise FileNotFoundError(
+                f"Checklist file not found: {args.checklist}"
+            )
+        with open(path, "r", encoding="utf-8") as f:
+            checklist = yaml.safe_load(f)
+        rules = extract_tier1_rules(checklist, args.checklist)
+    except (FileNotFoundError, ValueError, yaml.YAMLError) as e:
+        print(f"Error: {e}", file=sys.stderr)
+        sys.exit(1)
+
+    _write_cache(Path(args.cache), path, rules)
+    print(f"Compiled {len(rules)} checklist rules to: {args.cache}")
+
+
+if __name__ == "__main__":
+    main()
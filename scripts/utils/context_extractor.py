@@ -0,0 +1,347 @@
+#!/usr/bin/env python3
+"""Function-scope source context extraction for Stage 3.
+
+When ``--source-dir`` is set, the reviewer used to ship the entire file
+as context with each diff.  For large gameplay classes most of those
+input tokens are code far from the change, and the inflated estimate
+regularly pushed exactly those files over the per-file budget and out
+of review.  This module extracts only the parts of the source the LLM
+needs to judge the diff:
+
+  * the enclosing function/class bodies of every changed line (the
+    smallest brace-delimited block of manageable size, found by the
+    same lightweight brace-depth scanning the diff chunker uses),
+  * the signature lines of every enclosing outer scope (class
+    declarations, namespaces, the function a changed loop sits in),
+  * file-level preprocessor lines (#include / #pragma / #define) and
+    UCLASS / USTRUCT / UENUM reflection declarations.
+
+Omitted regions are replaced with a single ``// ... (N-M행 생략)``
+marker so the model knows code was elided rather than missing.  Small
+files are returned unchanged — extraction only pays off when it
+actually removes a meaningful share of the file.
+
+The scanner tracks string/char literals and // and /* */ comments, so
+braces inside them never desynchronize the block structure.  Unbalanced
+braces (e.g. asymmetric #if/#else arms) degrade gracefully: depth is
+clamped at zero and unclosed blocks simply extend to end of file.
+"""
+
+from __future__ import annotations
+
+import re
+from dataclasses import dataclass, field
+from typing import Iterable, List, Optional, Set, Tuple
+
+# ---------------------------------------------------------------------------
+# Extraction constants
+# ---------------------------------------------------------------------------
+
+# Files at or under this many lines are sent whole — the savings would
+# not cover the risk of eliding something relevant.
+MIN_EXTRACT_LINES: int = 200
+
+# A block containing a changed line is included whole when its span is
+# at most this many lines; larger blocks (a whole class, a monster
+# function) are descended into instead.
+MAX_BLOCK_LINES: int = 200
+
+# Context radius around a changed line when even its innermost
+# enclosing block is too large to include whole.
+FALLBACK_RADIUS: int = 25
+
+# If extraction keeps at least this fraction of the file, return the
+# full source instead — an elision marker per tiny gap is pure noise.
+_MIN_SAVINGS_RATIO: float = 0.9
+
+# Gaps of at most this many lines are kept rather than elided.
+_MAX_GAP_TO_KEEP: int = 2
+
+# Cap on the contiguous non-blank run kept above an opening brace
+# (signature, UFUNCTION/UPROPERTY macros, doc comment).
+_MAX_HEADER_LINES: int = 10
+
+# File-level lines that are always kept: preprocessor directives and
+# UE reflection macros marking type declarations.
+_PREAMBLE_RE = re.compile(
+    r"^\s*(#\s*(include|pragma|define|undef|if|ifdef|ifndef|else|elif|endif)\b"
+    r"|(UCLASS|USTRUCT|UENUM|UINTERFACE|UDELEGATE)\s*(\(|$))"
+)
+
+
+# ---------------------------------------------------------------------------
+# Brace-block tree
+# ---------------------------------------------------------------------------
+
+
+@dataclass
+class _Block:
+    """One brace-delimited block of source.
+
+    Attributes:
+        header_start: First line (0-based) of the signature/comment run
+            introducing the block.
+        open_line: Line containing the opening ``{``.
+        close_line: Line containing the matching ``}`` (last file line
+            when the block is never closed).
+        children: Directly nested blocks, in source order.
+    """
+
+    header_start: int
+    open_line: int
+    close_line: int
+    children: List["_Block"] = field(default_factory=list)
+
+    def span(self) -> int:
+        return self.close_line - self.header_start + 1
+
+    def contains(self, line: int) -> bool:
+        return self.header_start <= line <= self.close_line
+
+
+def _scan_line_events(
+    code: str, in_block_comment: bool
+) -> Tuple[List[str], bool]:
+    """Scan one source line for brace events outside comments/strings.
+
+    Args:
+        code: Raw source line.
+        in_block_comment: Whether the line starts inside ``/* */``.
+
+    Returns:
+        Tuple of (events, in_block_comment) where events is a list of
+        ``"{"`` / ``"}"`` in occurrence order and the flag is the block
+        comment state after the line.
+    """
+    events: List[str] = []
+    i = 0
+    n = len(code)
+    while i < n:
+        c = code[i]
+        if in_block_comment:
+            if c == "*" and i + 1 < n and code[i + 1] == "/":
+                in_block_comment = False
+                i += 2
+                continue
+            i += 1
+            continue
+        if c == "/" and i + 1 < n:
+            nxt = code[i + 1]
+            if nxt == "/":
+                break
+            if nxt == "*":
+                in_block_comment = True
+                i += 2
+                continue
+        if c in ('"', "'"):
+            quote = c
+            i += 1
+            while i < n:
+                if code[i] == "\\":
+                    i += 2
+                    continue
+                if code[i] == quote:
+                    i += 1
+                    break
+                i += 1
+            continue
+        if c == "{" or c == "}":
+            events.append(c)
+        i += 1
+    return events, in_block_comment
+
+
+def _header_start(lines: List[str], open_line: int, floor: int) -> int:
+    """First line of the signature run introducing a block.
+
+    Walks up from the opening brace through contiguous non-blank lines
+    so multi-line signatures, UFUNCTION/UPROPERTY macros, and doc
+    comments stay attached to the block they describe.
+
+    Args:
+        lines: All source lines.
+        open_line: Line containing the opening brace.
+        floor: Lowest line the header may extend to (end of the
+            previous sibling, or the parent's opening line + 1).
+
+    Returns:
+        0-based line index where the header starts.
+    """
+    start = open_line
+    while (
+        start > floor
+        and open_line - (start - 1) < _MAX_HEADER_LINES
+        and lines[start - 1].strip()
+    ):
+        start -= 1
+    return start
+
+
+def _build_block_tree(lines: List[str]) -> List[_Block]:
+    """Build the tree of brace-delimited blocks for a source file.
+
+    Args:
+        lines: Source lines.
+
+    Returns:
+        Top-level blocks in source order (nested blocks hang off
+        ``children``).
+    """
+    roots: List[_Block] = []
+    stack: List[_Block] = []
+    in_block_comment = False
+
+    for num, line in enumerate(lines):
+        events, in_block_comment = _scan_line_events(line, in_block_comment)
+        for event in events:
+            if event == "{":
+                siblings = stack[-1].children if stack else roots
+                if siblings:
+                    floor = siblings[-1].close_line + 1
+                elif stack:
+                    floor = stack[-1].open_line + 1
+                else:
+                    floor = 0
+                block = _Block(
+                    header_start=_header_start(lines, num, floor),
+                    open_line=num,
+                    close_line=len(lines) - 1,
+                )
+                siblings.append(block)
+                stack.append(block)
+            elif stack:
+                stack.pop().close_line = num
+    return roots
+
+
+# ---------------------------------------------------------------------------
+# Line selection
+# ---------------------------------------------------------------------------
+
+
+def _block_chain(roots: List[_Block], line: int) -> List[_Block]:
+    """Blocks enclosing *line*, outermost first."""
+    chain: List[_Block] = []
+    candidates = roots
+    while True:
+        match = next((b for b in candidates if b.contains(line)), None)
+        if match is None:
+            return chain
+        chain.append(match)
+        candidates = match.children
+
+
+def _select_for_line(
+    roots: List[_Block],
+    line: int,
+    total_lines: int,
+    selected: Set[int],
+) -> None:
+    """Mark the lines giving context for one changed line.
+
+    Picks the outermost enclosing block small enough to include whole;
+    for every scope above it only the signature run and closing brace
+    are kept.  When even the innermost block is oversized, a fixed
+    radius around the change is kept instead.
+
+    Args:
+        roots: Top-level blocks of the file.
+        line: 0-based changed line index.
+        total_lines: Number of lines in the file.
+        selected: Line index set updated in place.
+    """
+    chain = _block_chain(roots, line)
+
+    chosen: Optional[_Block] = None
+    outer: List[_Block] = []
+    for block in chain:
+        if block.span() <= MAX_BLOCK_LINES:
+            chosen = block
+            break
+        outer.append(block)
+
+    for block in outer:
+        selected.update(range(block.header_start, block.open_line + 1))
+        selected.add(block.close_line)
+
+    if chosen is not None:
+        selected.update(range(chosen.header_start, chosen.close_line + 1))
+    else:
+        lo = max(0, line - FALLBACK_RADIUS)
+        hi = min(total_lines - 1, line + FALLBACK_RADIUS)
+        selected.update(range(lo, hi + 1))
+
+
+def _select_preamble(lines: List[str], selected: Set[int]) -> None:
+    """Mark file-level directives and UE reflection declarations.
+
+    A UCLASS/USTRUCT-style macro also carries the declaration line that
+    follows it, so the model sees ``class AFoo : public AActor`` and
+    not just the bare macro.
+    """
+    for num, line in enumerate(lines):
+        if not _PREAMBLE_RE.match(line):
+            continue
+        selected.add(num)
+        if line.lstrip().startswith("U"):
+            nxt = num + 1
+            while nxt < len(lines) and not lines[nxt].strip():
+                nxt += 1
+            if nxt < len(lines):
+                selected.add(nxt)
+
+
+# ---------------------------------------------------------------------------
+# Public API
+# ---------------------------------------------------------------------------
+
+
+def extract_review_context(
+    source: str, changed_lines: Iterable[int]
+) -> str:
+    """Reduce a source file to the context relevant to changed lines.
+
+    Args:
+        source: Full source text of the (new-side) file.
+        changed_lines: 1-based line numbers of changed lines, in the
+            file's own numbering (``FileDiff.added_lines`` keys).
+
+    Returns:
+        The reduced source with elision markers, or the original
+        source when the file is small, nothing changed, or extraction
+        would save almost nothing.
+    """
+    lines = source.split("\n")
+    changed = sorted(
+        num - 1 for num in set(changed_lines) if 1 <= num <= len(lines)
+    )
+    if len(lines) <= MIN_EXTRACT_LINES or not changed:
+        return source
+
+    roots = _build_block_tree(lines)
+
+    selected: Set[int] = set()
+    _select_preamble(lines, selected)
+    for line in changed:
+        _select_for_line(roots, line, len(lines), selected)
+
+    if len(selected) >= _MIN_SAVINGS_RATIO * len(lines):
+        return source
+
+    ordered = sorted(selected)
+    # Absorb tiny gaps — a marker for one skipped line is noise.
+    for i in range(len(ordered) - 1):
+        gap = ordered[i + 1] - ordered[i] - 1
+        if 0 < gap <= _MAX_GAP_TO_KEEP:
+            selected.update(range(ordered[i] + 1, ordered[i + 1]))
+
+    out: List[str] = []
+    prev = -1
+    for num in sorted(selected):
+        if num != prev + 1:
+            out.append(f"// ... ({prev + 2}-{num}행 생략)")
+        out.append(lines[num])
+        prev = num
+    if prev < len(lines) - 1:
+        out.append(f"// ... ({prev + 2}-{len(lines)}행 생략)")
+    return "\n".join(out)
@@ -20,9 +20,11 @@ This field is intentionally excluded from ``to_dict()``.
 
 from __future__ import annotations
 
+import json
 import re
 from dataclasses import dataclass, field
-from typing import Dict, List, Optional
+from pathlib import Path
+from typing import Dict, Iterable, Iterator, List, Optional, Union
 
 
 @dataclass
@@ -91,21 +93,28 @@ _MINUS_HEADER_RE = re.compile(r"^--- ")
 _HUNK_RE = re.compile(r"^@@ -(\d+)(?:,(\d+))? \+(\d+)(?:,(\d+))? @@")
 
 
-def parse_diff(diff_text: str) -> Dict[str, FileDiff]:
-    """Parse unified diff text into structured per-file data.
+def iter_parse_diff(lines: Iterable[str]) -> Iterator[FileDiff]:
+    """Stream-parse unified diff lines, yielding one FileDiff per section.
 
-    Extracts added lines (with new-file line numbers) and hunk information
-    for each changed file.
+    Unlike :func:`parse_diff`, this never holds more than one file's
+    data in memory at a time: each FileDiff is yielded as soon as the
+    next ``diff --git`` marker (or end of input) completes its section.
+    Callers can therefore feed an open file object directly and process
+    multi-hundred-MB diffs without materializing the whole text.
+
+    A path that appears in multiple sections yields multiple FileDiff
+    objects; :func:`parse_diff` merges them for callers that want a
+    per-path dictionary.
 
     Args:
-        diff_text: Raw unified diff text.
+        lines: Iterable of diff lines (trailing newlines are ignored),
+            e.g. an open text file or ``diff_text.splitlines()``.
 
-    Returns:
-        Dictionary mapping file paths to FileDiff objects.
+    Yields:
+        FileDiff objects in diff order.
         Deleted files (with +++ /dev/null) are excluded.
     """
-    result: Dict[str, FileDiff] = {}
-    current_file: Optional[str] = None
+    current: Optional[FileDiff] = None
     in_header = False
     in_hunk = False
     line_num = 0
@@ -118,7 +127,7 @@ def parse_diff(diff_text: str) -> Dict[str, FileDiff]:
     def _flush_hunk() -> None:
         """Save the accumulated hunk to the current file's data."""
         nonlocal hunk_lines
-        if current_file and hunk_lines and current_file in result:
+        if current is not None and hunk_lines:
             # Calculate end line from hunk content
             end_line = hunk_start
             for hl in hunk_lines:
@@ -128,7 +137,7 @@ def parse_diff(diff_text: str) -> Dict[str, FileDiff]:
             if end_line < hunk_start:
                 end_line = hunk_start
 
-            result[current_file].hunks.append(
+            current.hunks.append(
                 {
                     "start": hunk_start,
                     "end": end_line,
@@ -138,11 +147,15 @@ def parse_diff(diff_text: str) -> Dict[str, FileDiff]:
             )
             hunk_lines = []
 
-    for raw_line in diff_text.splitlines():
+    for raw_line in lines:
+        raw_line = raw_line.rstrip("\n").rstrip("\r")
+
         # --- New file section ---
         if _DIFF_MARKER_RE.match(raw_line):
             _flush_hunk()
-            current_file = None  # Reset so deleted files don't corrupt prior entry
+            if current is not None:
+                yield current
+            current = None  # Reset so deleted files don't corrupt prior entry
             in_header = True
             in_hunk = False
             continue
@@ -152,9 +165,7 @@ def parse_diff(diff_text: str) -> Dict[str, FileDiff]:
             m = _PLUS_HEADER_RE.match(raw_line)
             if m:
                 filepath = _decode_git_path(m.group(1))
-                current_file = filepath
-                if filepath not in result:
-                    result[filepath] = FileDiff(path=filepath)
+                current = FileDiff(path=filepath)
                 continue
 
             if _MINUS_HEADER_RE.match(raw_line):
@@ -173,11 +184,11 @@ def parse_diff(diff_text: str) -> Dict[str, FileDiff]:
             continue
 
         # --- Hunk body ---
-        if in_hunk and current_file and current_file in result:
+        if in_hunk and current is not None:
             if raw_line.startswith("+"):
                 # Added line — record with new-file line number
                 content = raw_line[1:]
-                result[current_file].added_lines[line_num] = content
+                current.added_lines[line_num] = content
                 hunk_lines.append(raw_line)
                 line_num += 1
             elif raw_line.startswith("-"):
@@ -186,7 +197,7 @@ def parse_diff(diff_text: str) -> Dict[str, FileDiff]:
             elif raw_line.startswith(" "):
                 # Context line — record content and advance new-file counter
                 content = raw_line[1:]
-                result[current_file].context_lines[line_num] = content
+                current.context_lines[line_num] = content
                 hunk_lines.append(raw_line)
                 line_num += 1
             elif raw_line.startswith("\\"):
@@ -197,8 +208,94 @@ def parse_diff(diff_text: str) -> Dict[str, FileDiff]:
                 _flush_hunk()
                 in_hunk = False
 
-    # Flush final hunk
+    # Flush final section
     _flush_hunk()
+    if current is not None:
+        yield current
+
+
+def parse_diff(diff_text: str) -> Dict[str, FileDiff]:
+    """Parse unified diff text into structured per-file data.
+
+    Extracts added lines (with new-file line numbers) and hunk information
+    for each changed file.  Thin wrapper over :func:`iter_parse_diff`
+    that merges repeated sections for the same path.
+
+    Args:
+        diff_text: Raw unified diff text.
+
+    Returns:
+        Dictionary mapping file paths to FileDiff objects.
+        Deleted files (with +++ /dev/null) are excluded.
+    """
+    result: Dict[str, FileDiff] = {}
+    for file_diff in iter_parse_diff(diff_text.splitlines()):
+        existing = result.get(file_diff.path)
+        if existing is None:
+            result[file_diff.path] = file_diff
+        else:
+            existing.added_lines.update(file_diff.added_lines)
+            existing.context_lines.update(file_diff.context_lines)
+            existing.hunks.extend(file_diff.hunks)
+    return result
+
+
+def save_parsed_diff(
+    diff_data: Dict[str, FileDiff], output_path: Union[str, Path]
+) -> None:
+    """Serialize parsed diff data to a JSON artifact.
+
+    The artifact lets downstream stages (pattern checker, LLM reviewer)
+    reuse the gate's parse instead of each re-parsing the raw diff.
+    Unlike ``to_dict()``, ``context_lines`` is included because the
+    pattern checker's prev_line_pattern matching needs it.
+
+    Args:
+        diff_data: Parsed diff data from parse_diff().
+        output_path: Destination JSON file path.
+    """
+    payload = {
+        path: {
+            "path": fd.path,
+            "added_lines": fd.added_lines,
+            "context_lines": fd.context_lines,
+            "hunks": fd.hunks,
+        }
+        for path, fd in diff_data.items()
+    }
+    Path(output_path).write_text(
+        json.dumps(payload, ensure_ascii=False), encoding="utf-8"
+    )
+
+
+def load_parsed_diff(input_path: Union[str, Path]) -> Dict[str, FileDiff]:
+    """Load a parsed-diff JSON artifact written by save_parsed_diff().
+
+    JSON object keys are always strings, so line-number keys are
+    converted back to int here.
+
+    Args:
+        input_path: Path to the artifact file.
+
+    Returns:
+        Dictionary mapping file paths to FileDiff objects, equivalent
+        to the parse_diff() result that was saved.
+    """
+    payload = json.loads(
+        Path(input_path).read_text(encoding="utf-8")
+    )
+    result: Dict[str, FileDiff] = {}
+    for path, entry in payload.items():
+        result[path] = FileDiff(
+            path=entry["path"],
+            added_lines={
+                int(k): v for k, v in entry.get("added_lines", {}).items()
+            },
+            context_lines={
+                int(k): v for k, v in entry.get("context_lines", {}).items()
+            },
+            hunks=entry.get("hunks", []),
+        )
     return result
 
 
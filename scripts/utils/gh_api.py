@@ -10,13 +10,72 @@ Used by:
 
 from __future__ import annotations
 
+import http.client
 import json
+import re
 import subprocess
 import sys
+import threading
 import time
-import urllib.error
-import urllib.request
-from typing import Any, Dict, List, Optional, Union
+import urllib.parse
+from concurrent.futures import ThreadPoolExecutor
+from typing import Any, Dict, List, Optional, Tuple, Union
+
+# Extracts the page number from the rel="last" entry of a Link header part.
+_LINK_PAGE_RE = re.compile(r"[?&]page=(\d+)")
+
+# Maximum pages fetched in parallel once the last page number is known.
+MAX_PAGE_CONCURRENCY = 8
+
+# Upper bound for a single rate-limit wait.  Retry-After / quota-reset
+# values above this abort the request instead of stalling the job.
+_RATE_LIMIT_MAX_WAIT = 120
+
+
+# Single-query PR context: labels, head/base SHAs, changed-file count,
+# and review comments.  One round-trip instead of gh-CLI label fetch +
+# PR metadata GET + paginated comment GETs — significant on GHES where
+# every round-trip is expensive.  Page sizes cover typical PRs; the
+# pageInfo flags tell callers when the REST pagination path is needed.
+_PR_CONTEXT_QUERY = """
+query($owner: String!, $name: String!, $number: Int!) {
+  repository(owner: $owner, name: $name) {
+    pullRequest(number: $number) {
+      headRefOid
+      baseRefOid
+      changedFiles
+      labels(first: 100) {
+        nodes { name }
+      }
+      reviewThreads(first: 100) {
+        pageInfo { hasNextPage }
+        nodes {
+          comments(first: 50) {
+            pageInfo { hasNextPage }
+            nodes {
+              path
+              body
+              line
+              startLine
+              originalLine
+              commit { oid }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+"""
+
+
+class SecondaryRateLimitError(RuntimeError):
+    """GitHub secondary (abuse-detection) rate limit hit after retries.
+
+    Subclass of RuntimeError so existing ``except RuntimeError`` callers
+    keep working; callers doing concurrent writes catch it specifically
+    to fall back to sequential submission.
+    """
 
 
 def get_pr_labels(pr_number: int) -> List[str]:
@@ -52,7 +111,10 @@ def get_pr_labels(pr_number: int) -> List[str]:
 class GitHubClient:
     """HTTP client for GitHub REST API (supports GHES and github.com).
 
-    Uses urllib to avoid external dependencies beyond the standard library.
+    Uses http.client to avoid external dependencies beyond the standard
+    library.  Connections are persistent (HTTP keep-alive) and held per
+    thread, so repeated calls skip the TLS handshake and paginated
+    endpoints can be fetched concurrently.
 
     Args:
         token: Personal access token for authentication.
@@ -70,71 +132,104 @@ class GitHubClient:
         self.token = token
         self.api_url = api_url.rstrip("/")
         self.max_retries = max_retries
+        self._local = threading.local()
+        # Count of HTTP requests sent (including retries), for the
+        # timing-metrics artifact. Guarded — paginated fetches run
+        # requests from a thread pool.
+        self._stats_lock = threading.Lock()
+        self.request_count = 0
+
+    def _new_connection(self) -> http.client.HTTPConnection:
+        """Open a fresh HTTP(S) connection to the API host."""
+        parsed = urllib.parse.urlsplit(self.api_url)
+        if parsed.scheme == "http":
+            return http.client.HTTPConnection(parsed.netloc, timeout=60)
+        return http.client.HTTPSConnection(parsed.netloc, timeout=60)
+
+    def _get_connection(self) -> http.client.HTTPConnection:
+        """Return this thread's persistent connection, opening if needed."""
+        conn = getattr(self._local, "conn", None)
+        if conn is None:
+            conn = self._new_connection()
+            self._local.conn = conn
+        return conn
+
+    def _close_connection(self) -> None:
+        """Close and drop this thread's persistent connection."""
+        conn = getattr(self._local, "conn", None)
+        if conn is not None:
+            try:
+                conn.close()
+            except Exception:
+                pass
+            self._local.conn = None
 
-    def _request(
+    def _request_with_headers(
         self,
         method: str,
         path: str,
         body: Optional[Dict[str, Any]] = None,
-    ) -> Union[Dict[str, Any], List[Any]]:
-        """Make an authenticated API request with retry on transient errors.
+        extra_headers: Optional[Dict[str, str]] = None,
+        raw_path: Optional[str] = None,
+    ) -> Tuple[Union[Dict[str, Any], List[Any], None], Dict[str, str]]:
+        """Make an authenticated API request, returning response headers too.
+
+        Reuses this thread's keep-alive connection.  A connection that the
+        server closed while idle is reopened and retried immediately
+        (without backoff); genuine network errors and rate limits retry
+        with exponential backoff as before.
 
         Args:
             method: HTTP method (GET, POST, PUT, etc.).
             path: API path (e.g., ``/repos/owner/repo/pulls/1/reviews``).
             body: Request body (will be JSON-encoded).
+            extra_headers: Additional request headers (e.g.
+                ``If-None-Match`` for conditional requests).
+            raw_path: Full request path used verbatim instead of
+                prefixing *path* with the REST base path — needed for
+                GraphQL, which GHES serves outside ``/api/v3``.
 
         Returns:
-            Parsed JSON response (dict or list).
+            Tuple of (parsed JSON response, response header dict).
+            The response is None for ``304 Not Modified`` (conditional
+            request, content unchanged).
 
         Raises:
             RuntimeError: If the request fails after retries.
         """
-        url = f"{self.api_url}{path}"
+        base_path = urllib.parse.urlsplit(self.api_url).path
+        request_path = raw_path if raw_path is not None else f"{base_path}{path}"
         headers = {
             "Authorization": f"token {self.token}",
             "Accept": "application/vnd.github.v3+json",
             "Content-Type": "application/json",
         }
+        if extra_headers:
+            headers.update(extra_headers)
 
         data = json.dumps(body).encode("utf-8") if body else None
 
         last_error: Optional[Exception] = None
         for attempt in range(self.max_retries + 1):
+            was_reused = getattr(self._local, "conn", None) is not None
+            with self._stats_lock:
+                self.request_count += 1
             try:
-                req = urllib.request.Request(
-                    url, data=data, headers=headers, method=method
-                )
-                with urllib.request.urlopen(req, timeout=60) as resp:
-                    resp_body = resp.read().decode("utf-8")
-                    if resp_body:
-                        return json.loads(resp_body)
-                    return {}
-            except urllib.error.HTTPError as e:
-                last_error = e
-                status = e.code
-                # Rate limit (403/429) or server error (5xx) → retry
-                if status in (403, 429) or status >= 500:
-                    if attempt < self.max_retries:
-                        wait = 2 ** (attempt + 1)
-                        print(
-                            f"GitHub API {status} on {method} {path}, "
-                            f"retrying in {wait}s (attempt {attempt + 1})...",
-                            file=sys.stderr,
-                        )
-                        time.sleep(wait)
-                        continue
-                # 422 Unprocessable Entity — GitHub validation error
-                error_body = ""
-                try:
-                    error_body = e.read().decode("utf-8", errors="replace")
-                except Exception:
-                    pass
-                raise RuntimeError(
-                    f"GitHub API error {status} on {method} {path}: {error_body}"
-                ) from e
-            except (urllib.error.URLError, OSError) as e:
+                conn = self._get_connection()
+                conn.request(method, request_path, body=data, headers=headers)
+                resp = conn.getresponse()
+                status = resp.status
+                resp_headers = dict(resp.getheaders())
+                # Body must be fully read before the connection can be reused
+                resp_body = resp.read().decode("utf-8", errors="replace")
+            except (http.client.HTTPException, OSError) as e:
+                self._close_connection()
                 last_error = e
+                # A keep-alive connection the server closed while idle
+                # typically fails on first reuse — reconnect and retry
+                # immediately rather than backing off.
+                if was_reused and attempt < self.max_retries:
+                    continue
                 if attempt < self.max_retries:
                     wait = 2 ** (attempt + 1)
                     print(
@@ -148,11 +243,127 @@ class GitHubClient:
                     f"GitHub API network error on {method} {path}: {e}"
                 ) from e
 
+            if status == 304:
+                # Conditional request — content unchanged since the ETag
+                return None, resp_headers
+
+            if status < 400:
+                if resp_body:
+                    return json.loads(resp_body), resp_headers
+                return {}, resp_headers
+
+            last_error = RuntimeError(f"HTTP {status}")
+            # Rate limit (403/429) or server error (5xx) → retry
+            if status in (403, 429) or status >= 500:
+                if attempt < self.max_retries:
+                    wait = self._rate_limit_wait(resp_headers, attempt)
+                    print(
+                        f"GitHub API {status} on {method} {path}, "
+                        f"retrying in {wait}s (attempt {attempt + 1})...",
+                        file=sys.stderr,
+                    )
+                    time.sleep(wait)
+                    continue
+                if self._is_secondary_rate_limit(status, resp_body):
+                    raise SecondaryRateLimitError(
+                        f"GitHub secondary rate limit on {method} {path}: "
+                        f"{resp_body}"
+                    )
+            # 422 Unprocessable Entity — GitHub validation error
+            raise RuntimeError(
+                f"GitHub API error {status} on {method} {path}: {resp_body}"
+            )
+
         raise RuntimeError(
             f"GitHub API request failed after {self.max_retries + 1} attempts: "
             f"{last_error}"
         )
 
+    def _rate_limit_wait(self, headers: Dict[str, str], attempt: int) -> int:
+        """Compute the wait before retrying a rate-limited request.
+
+        Prefers what the server says over blind exponential backoff:
+        ``Retry-After`` first (GitHub sends it on secondary rate
+        limits), then the quota reset time when ``X-RateLimit-Remaining``
+        is exhausted.  Both are capped at ``_RATE_LIMIT_MAX_WAIT``;
+        exponential backoff remains the fallback for 5xx responses that
+        carry neither header.
+
+        Args:
+            headers: Response header dict.
+            attempt: Zero-based retry attempt number.
+
+        Returns:
+            Seconds to sleep before the next attempt.
+        """
+        retry_after = self._get_header(headers, "Retry-After")
+        if retry_after and retry_after.strip().isdigit():
+            return min(int(retry_after.strip()), _RATE_LIMIT_MAX_WAIT)
+
+        remaining = self._get_header(headers, "X-RateLimit-Remaining")
+        reset = self._get_header(headers, "X-RateLimit-Reset")
+        if remaining == "0" and reset and reset.strip().isdigit():
+            until_reset = int(reset.strip()) - int(time.time()) + 1
+            return max(1, min(until_reset, _RATE_LIMIT_MAX_WAIT))
+
+        return 2 ** (attempt + 1)
+
+    @staticmethod
+    def _is_secondary_rate_limit(status: int, resp_body: str) -> bool:
+        """Detect GitHub's secondary (abuse-detection) rate limit."""
+        if status != 403 and status != 429:
+            return False
+        body = resp_body.lower()
+        return "secondary rate limit" in body or "abuse detection" in body
+
+    def _request(
+        self,
+        method: str,
+        path: str,
+        body: Optional[Dict[str, Any]] = None,
+    ) -> Union[Dict[str, Any], List[Any]]:
+        """Make an authenticated API request with retry on transient errors.
+
+        Args:
+            method: HTTP method (GET, POST, PUT, etc.).
+            path: API path (e.g., ``/repos/owner/repo/pulls/1/reviews``).
+            body: Request body (will be JSON-encoded).
+
+        Returns:
+            Parsed JSON response (dict or list).
+
+        Raises:
+            RuntimeError: If the request fails after retries.
+        """
+        result, _headers = self._request_with_headers(method, path, body)
+        return result
+
+    @staticmethod
+    def _parse_last_page(headers: Dict[str, str]) -> Optional[int]:
+        """Extract the last page number from a Link response header.
+
+        Args:
+            headers: Response header dict (case-insensitive lookup).
+
+        Returns:
+            The rel="last" page number, or None when absent.
+        """
+        link = None
+        for key, value in headers.items():
+            if key.lower() == "link":
+                link = value
+                break
+        if not link:
+            return None
+
+        for part in link.split(","):
+            if 'rel="last"' not in part:
+                continue
+            m = _LINK_PAGE_RE.search(part)
+            if m:
+                return int(m.group(1))
+        return None
+
     def _get_all_pages(
         self,
         path: str,
@@ -160,8 +371,11 @@ class GitHubClient:
     ) -> List[Any]:
         """Fetch all pages of a paginated GET endpoint.
 
-        Uses page-number pagination (``?per_page=N&page=P``) and stops when
-        an empty page is returned.
+        Fetches the first page, reads the last page number from the Link
+        header, and pulls the remaining pages concurrently (each worker
+        thread holds its own keep-alive connection).  Results keep page
+        order.  When the Link header is absent, falls back to the serial
+        ``?per_page=N&page=P`` scan that stops on an incomplete page.
 
         Args:
             path: API path **without** query parameters.
@@ -170,9 +384,37 @@ class GitHubClient:
         Returns:
             Concatenated list of all items across pages.
         """
-        all_items: List[Any] = []
         separator = "&" if "?" in path else "?"
-        page = 1
+        first_path = f"{path}{separator}per_page={per_page}&page=1"
+        result, resp_headers = self._request_with_headers("GET", first_path)
+        if not isinstance(result, list) or len(result) == 0:
+            return []
+
+        all_items: List[Any] = list(result)
+        if len(result) < per_page:
+            # Last page — no more results
+            return all_items
+
+        last_page = self._parse_last_page(resp_headers)
+        if last_page is not None and last_page > 1:
+            remaining = [
+                f"{path}{separator}per_page={per_page}&page={page}"
+                for page in range(2, last_page + 1)
+            ]
+            max_workers = min(MAX_PAGE_CONCURRENCY, len(remaining))
+            with ThreadPoolExecutor(max_workers=max_workers) as executor:
+                pages = list(
+                    executor.map(
+                        lambda p: self._request("GET", p), remaining
+                    )
+                )
+            for page_items in pages:
+                if isinstance(page_items, list):
+                    all_items.extend(page_items)
+            return all_items
+
+        # No Link header — serial scan until an incomplete page
+        page = 2
         while True:
             paginated_path = f"{path}{separator}per_page={per_page}&page={page}"
             result = self._request("GET", paginated_path)
@@ -232,24 +474,94 @@ class GitHubClient:
         }
         return self._request("POST", path, payload)
 
+    @staticmethod
+    def _get_header(headers: Dict[str, str], name: str) -> Optional[str]:
+        """Case-insensitive response header lookup."""
+        for key, value in headers.items():
+            if key.lower() == name.lower():
+                return value
+        return None
+
     def get_existing_review_comments(
         self,
         owner: str,
         repo: str,
         pr_number: int,
+        cache_path: Optional[str] = None,
     ) -> List[Dict[str, Any]]:
         """Fetch all existing review comments on a PR to avoid duplicates.
 
         Paginates through all pages (100 items per page) so that PRs with
         many comments are fully covered.
 
+        When *cache_path* is given, a conditional probe request
+        (``If-None-Match`` against the newest-updated comment) decides
+        whether anything changed since the last run.  A ``304 Not
+        Modified`` replays the cached list without re-downloading every
+        page; otherwise all pages are fetched and the cache is rewritten
+        with the new ETag.  Cache read/write failures degrade gracefully
+        to a full fetch.
+
         API: GET /repos/{owner}/{repo}/pulls/{pull_number}/comments
 
+        Args:
+            owner: Repository owner.
+            repo: Repository name.
+            pr_number: Pull request number.
+            cache_path: Optional JSON cache file for the ETag and the
+                comment list.
+
         Returns:
             List of review comment dicts from the API.
         """
         path = f"/repos/{owner}/{repo}/pulls/{pr_number}/comments"
-        return self._get_all_pages(path)
+        if cache_path is None:
+            return self._get_all_pages(path)
+
+        cached: Optional[Dict[str, Any]] = None
+        try:
+            with open(cache_path, "r", encoding="utf-8") as f:
+                loaded = json.load(f)
+            if isinstance(loaded, dict) and isinstance(
+                loaded.get("comments"), list
+            ):
+                cached = loaded
+        except (OSError, ValueError):
+            cached = None
+
+        # Probe the newest-updated comment: any added or edited comment
+        # changes this response, invalidating the ETag.  Sorting by
+        # created ascending (the default) would keep page 1 stable when
+        # new comments land on the last page.
+        probe_path = f"{path}?per_page=1&sort=updated&direction=desc"
+        extra = {}
+        if cached and cached.get("etag"):
+            extra["If-None-Match"] = cached["etag"]
+
+        result, resp_headers = self._request_with_headers(
+            "GET", probe_path, extra_headers=extra or None
+        )
+        if result is None and cached is not None:
+            # 304 Not Modified — cached list is still current
+            return cached["comments"]
+
+        comments = self._get_all_pages(path)
+        etag = self._get_header(resp_headers, "ETag")
+        if etag:
+            try:
+                with open(cache_path, "w", encoding="utf-8") as f:
+                    json.dump(
+                        {"etag": etag, "comments": comments},
+                        f,
+                        ensure_ascii=False,
+                    )
+            except OSError as e:
+                print(
+                    f"Warning: could not write comment cache "
+                    f"{cache_path}: {e}",
+                    file=sys.stderr,
+                )
+        return comments
 
     def get_pull_request(
         self,
@@ -266,3 +578,137 @@ class GitHubClient:
         """
         path = f"/repos/{owner}/{repo}/pulls/{pr_number}"
         return self._request("GET", path)
+
+    def _graphql_path(self) -> str:
+        """Absolute request path of the GraphQL endpoint.
+
+        GHES serves GraphQL at ``/api/graphql`` — outside the REST base
+        path ``/api/v3`` — while github.com uses ``/graphql``.
+        """
+        base_path = urllib.parse.urlsplit(self.api_url).path
+        if base_path.endswith("/api/v3"):
+            return base_path[: -len("v3")] + "graphql"
+        return f"{base_path}/graphql"
+
+    def graphql(
+        self,
+        query: str,
+        variables: Optional[Dict[str, Any]] = None,
+    ) -> Dict[str, Any]:
+        """Execute a GraphQL query and return its ``data`` payload.
+
+        Args:
+            query: GraphQL query string.
+            variables: Query variables.
+
+        Returns:
+            The ``data`` dict from the GraphQL response.
+
+        Raises:
+            RuntimeError: On transport failures, GraphQL-level errors,
+                or a malformed response.
+        """
+        result, _headers = self._request_with_headers(
+            "POST",
+            "/graphql",
+            body={"query": query, "variables": variables or {}},
+            raw_path=self._graphql_path(),
+        )
+        if not isinstance(result, dict):
+            raise RuntimeError("GraphQL response is not a JSON object")
+        if result.get("errors"):
+            raise RuntimeError(
+                f"GraphQL query failed: {json.dumps(result['errors'])}"
+            )
+        data = result.get("data")
+        if not isinstance(data, dict):
+            raise RuntimeError("GraphQL response has no data")
+        return data
+
+    def get_pr_context(
+        self,
+        owner: str,
+        repo: str,
+        pr_number: int,
+    ) -> Optional[Dict[str, Any]]:
+        """Fetch PR labels, SHAs, file count and comments in one query.
+
+        One GraphQL round-trip replaces :func:`get_pr_labels`,
+        :meth:`get_pull_request`, and the page fetches of
+        :meth:`get_existing_review_comments` for typical PRs.  Review
+        comments are normalized to the REST field names
+        (``start_line``, ``original_line``, ``commit_id``) so existing
+        consumers like ``filter_already_posted`` work unchanged.
+
+        Args:
+            owner: Repository owner.
+            repo: Repository name.
+            pr_number: Pull request number.
+
+        Returns:
+            Dict with ``head_sha``, ``base_sha``, ``changed_files``,
+            ``labels`` (name list), and ``review_comments``.
+            ``review_comments`` is None when the PR has more threads or
+            comments than one page covers — use the paginated REST
+            fetch then.  Returns None entirely when GraphQL is
+            unavailable or errors (some GHES instances disable it), so
+            callers fall back to the REST methods.
+        """
+        try:
+            data = self.graphql(
+                _PR_CONTEXT_QUERY,
+                {"owner": owner, "name": repo, "number": pr_number},
+            )
+        except RuntimeError as e:
+            print(
+                f"Warning: GraphQL PR context fetch failed "
+                f"(falling back to REST): {e}",
+                file=sys.stderr,
+            )
+            return None
+
+        pr = (data.get("repository") or {}).get("pullRequest")
+        if not isinstance(pr, dict):
+            print(
+                f"Warning: GraphQL returned no pull request for "
+                f"{owner}/{repo}#{pr_number} (falling back to REST)",
+                file=sys.stderr,
+            )
+            return None
+
+        labels = [
+            node["name"]
+            for node in (pr.get("labels") or {}).get("nodes") or []
+            if isinstance(node, dict) and node.get("name")
+        ]
+
+        threads = pr.get("reviewThreads") or {}
+        complete = not (threads.get("pageInfo") or {}).get(
+            "hasNextPage", False
+        )
+        comments: List[Dict[str, Any]] = []
+        for thread in threads.get("nodes") or []:
+            thread_comments = (thread or {}).get("comments") or {}
+            if (thread_comments.get("pageInfo") or {}).get("hasNextPage"):
+                complete = False
+            for node in thread_comments.get("nodes") or []:
+                if not isinstance(node, dict):
+                    continue
+                comments.append(
+                    {
+                        "path": node.get("path", ""),
+                        "body": node.get("body", ""),
+                        "line": node.get("line"),
+                        "start_line": node.get("startLine"),
+                        "original_line": node.get("originalLine"),
+                        "commit_id": (node.get("commit") or {}).get("oid"),
+                    }
+                )
+
+        return {
+            "head_sha": pr.get("headRefOid", ""),
+            "base_sha": pr.get("baseRefOid", ""),
+            "changed_files": pr.get("changedFiles", 0),
+            "labels": labels,
+            "review_comments": comments if complete else None,
+        }
@@ -0,0 +1,203 @@
+"""Structured per-stage timing and hot-path metrics.
+
+Each stage entry point builds a :class:`StageMetrics`, times its hot
+paths, and writes the result as a small JSON artifact
+(``--metrics-output``).  The post-review step loads the per-stage
+artifacts, aggregates them into one ``review-metrics.json``, and
+appends a compact timing table to the review summary body.
+
+The collector is deliberately lightweight: recording a timing is a
+list append under a lock, so instrumenting worker threads (clang
+tool fan-out, parallel API calls) costs nothing measurable.
+"""
+
+from __future__ import annotations
+
+import json
+import sys
+import threading
+import time
+from contextlib import contextmanager
+from pathlib import Path
+from typing import Any, Dict, Iterable, Iterator, List, Union
+
+
+def percentile(values: List[float], q: float) -> float:
+    """Return the *q*-th percentile (0-100) by nearest-rank.
+
+    Args:
+        values: Samples (need not be sorted; must be non-empty).
+        q: Percentile in [0, 100].
+
+    Returns:
+        The sample at the nearest rank.
+    """
+    ordered = sorted(values)
+    if not ordered:
+        raise ValueError("percentile() requires at least one sample")
+    rank = max(0, min(len(ordered) - 1, round(q / 100.0 * (len(ordered) - 1))))
+    return ordered[rank]
+
+
+class StageMetrics:
+    """Thread-safe timing/counter collector for one pipeline stage.
+
+    Usage::
+
+        metrics = StageMetrics("stage1-pattern")
+        with metrics.timer("regex_scan"):
+            findings = check_diff(diff_data, patterns)
+        metrics.incr("findings", len(findings))
+        metrics.save("metrics-stage1-pattern.json")
+    """
+
+    def __init__(self, stage: str) -> None:
+        self.stage = stage
+        self._start = time.perf_counter()
+        self._lock = threading.Lock()
+        self._timings: Dict[str, List[float]] = {}
+        self._counters: Dict[str, int] = {}
+        self._info: Dict[str, Any] = {}
+
+    @contextmanager
+    def timer(self, name: str) -> Iterator[None]:
+        """Time the enclosed block and record it under *name*."""
+        start = time.perf_counter()
+        try:
+            yield
+        finally:
+            self.add_timing(name, time.perf_counter() - start)
+
+    def add_timing(self, name: str, seconds: float) -> None:
+        """Record one duration sample under *name*."""
+        with self._lock:
+            self._timings.setdefault(name, []).append(seconds)
+
+    def incr(self, name: str, amount: int = 1) -> None:
+        """Add *amount* to the counter *name*."""
+        with self._lock:
+            self._counters[name] = self._counters.get(name, 0) + amount
+
+    def set_info(self, name: str, value: Any) -> None:
+        """Attach an arbitrary JSON-serializable value (e.g. a budget
+        summary dict) to the metrics under *name*."""
+        with self._lock:
+            self._info[name] = value
+
+    def finish(self) -> Dict[str, Any]:
+        """Return the metrics as a JSON-ready dict.
+
+        Timings are summarized per name (count/total/mean/p50/p95/max)
+        so the artifact stays small even with thousands of samples.
+        """
+        with self._lock:
+            timings = {
+                name: {
+                    "count": len(samples),
+                    "total_s": round(sum(samples), 6),
+                    "mean_s": round(sum(samples) / len(samples), 6),
+                    "p50_s": round(percentile(samples, 50), 6),
+                    "p95_s": round(percentile(samples, 95), 6),
+                    "max_s": round(max(samples), 6),
+                }
+                for name, samples in self._timings.items()
+                if samples
+            }
+            result: Dict[str, Any] = {
+                "stage": self.stage,
+                "wall_time_s": round(time.perf_counter() - self._start, 6),
+                "counters": dict(self._counters),
+                "timings": timings,
+            }
+            if self._info:
+                result["info"] = dict(self._info)
+            return result
+
+    def save(self, path: Union[str, Path]) -> None:
+        """Write :meth:`finish` output as JSON to *path*."""
+        Path(path).write_text(
+            json.dumps(self.finish(), ensure_ascii=False, indent=2) + "\n",
+            encoding="utf-8",
+        )
+
+
+def load_stage_metrics(paths: Iterable[Union[str, Path]]) -> List[Dict[str, Any]]:
+    """Load per-stage metrics artifacts, tolerating absent/corrupt files.
+
+    Stages are optional (Stage 2/3 may not run), so a missing artifact
+    is only a warning — metrics must never fail the pipeline.
+
+    Args:
+        paths: Paths to JSON files written by :meth:`StageMetrics.save`.
+
+    Returns:
+        List of metrics dicts in input order.
+    """
+    loaded: List[Dict[str, Any]] = []
+    for path in paths:
+        p = Path(path)
+        if not p.exists():
+            print(
+                f"Warning: Metrics file not found, skipping: {path}",
+                file=sys.stderr,
+            )
+            continue
+        try:
+            data = json.loads(p.read_text(encoding="utf-8"))
+        except (OSError, json.JSONDecodeError) as e:
+            print(
+                f"Warning: Could not read metrics file {path}: {e}",
+                file=sys.stderr,
+            )
+            continue
+        if isinstance(data, dict) and "stage" in data:
+            loaded.append(data)
+        else:
+            print(
+                f"Warning: Unrecognized metrics format, skipping: {path}",
+                file=sys.stderr,
+            )
+    return loaded
+
+
+def _format_duration(seconds: float) -> str:
+    """Format a duration compactly (ms below one second)."""
+    if seconds < 1.0:
+        return f"{seconds * 1000:.0f}ms"
+    return f"{seconds:.2f}s"
+
+
+def format_metrics_table(metrics_list: List[Dict[str, Any]]) -> str:
+    """Render stage metrics as a compact markdown table.
+
+    Args:
+        metrics_list: Metrics dicts from :func:`load_stage_metrics`.
+
+    Returns:
+        Markdown table text, or an empty string when there is nothing
+        to show.
+    """
+    if not metrics_list:
+        return ""
+
+    lines = [
+        "### 처리 시간",
+        "",
+        "| 단계 | 소요 시간 | 세부 |",
+        "|---|---|---|",
+    ]
+    for m in metrics_list:
+        stage = m.get("stage", "?")
+        wall = _format_duration(float(m.get("wall_time_s", 0.0)))
+        parts: List[str] = []
+        for name, value in sorted(m.get("counters", {}).items()):
+            parts.append(f"{name}={value}")
+        for name, stats in sorted(m.get("timings", {}).items()):
+            detail = (
+                f"{name} {_format_duration(stats.get('total_s', 0.0))}"
+                f" (n={stats.get('count', 0)}"
+                f", p95={_format_duration(stats.get('p95_s', 0.0))})"
+            )
+            parts.append(detail)
+        lines.append(f"| {stage} | {wall} | {', '.join(parts) or '-'} |")
+    return "\n".join(lines)
@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""Persistent review cache for Stage 3 LLM reviewer.
+
+On ``synchronize`` pushes most files in a PR are unchanged since the
+previous run, but Stage 3 re-pays the full API latency and token cost
+for every file.  This cache stores validated findings per file, keyed
+on a content hash of everything that influences the review:
+
+    (file path, file diff text, full source, system prompt, model)
+
+The system prompt participates in the key, so checklist / prompt
+changes automatically invalidate prior entries.  Entries are plain
+JSON files in a cache directory, which in CI is persisted via the
+Actions cache (or any workspace directory on self-hosted runners).
+
+Only *complete* reviews are cached — budget-skipped or errored files
+must be retried on the next run, so callers only ``put()`` after a
+fully successful review.
+"""
+
+from __future__ import annotations
+
+import hashlib
+import json
+import logging
+from pathlib import Path
+from typing import Any, Dict, List, Optional
+
+logger = logging.getLogger(__name__)
+
+# Bumped when the cached entry schema changes — old entries are ignored.
+CACHE_SCHEMA_VERSION = 1
+
+
+def make_cache_key(
+    file_path: str,
+    diff_text: str,
+    system_prompt: str,
+    model: str,
+    full_source: Optional[str] = None,
+) -> str:
+    """Build the content-hash cache key for a single file review.
+
+    Args:
+        file_path: Path of the file being reviewed.
+        diff_text: Unified diff text for this file.
+        system_prompt: Full system prompt (covers checklist version).
+        model: Model ID used for the review.
+        full_source: Optional full file source sent as context.
+
+    Returns:
+        Hex digest string usable as a filename.
+    """
+    h = hashlib.sha256()
+    for part in (file_path, diff_text, system_prompt, model, full_source or ""):
+        h.update(part.encode("utf-8", errors="replace"))
+        h.update(b"\x00")  # unambiguous field separator
+    return h.hexdigest()
+
+
+class ReviewCache:
+    """File-backed findings cache keyed on content hashes.
+
+    Usage:
+        cache = ReviewCache("review-cache")
+        key = make_cache_key(path, diff, prompt, model)
+        cached = cache.get(key)
+        if cached is None:
+            findings = ...  # call the API
+            cache.put(key, file_path, findings)
+    """
+
+    def __init__(self, cache_dir: str) -> None:
+        self.cache_dir = Path(cache_dir)
+        self.hits = 0
+        self.misses = 0
+
+    def get(self, key: str) -> Optional[List[Dict[str, Any]]]:
+        """Look up cached findings for *key*.
+
+        Returns:
+            The cached findings list, or None on a miss (including
+            unreadable or schema-mismatched entries).
+        """
+        entry_path = self.cache_dir / f"{key}.json"
+        if not entry_path.exists():
+            self.misses += 1
+            return None
+        try:
+            entry = json.loads(
+                entry_path.read_text(encoding="utf-8", errors="replace")
+            )
+        except (json.JSONDecodeError, OSError) as e:
+            logger.warning("Failed to read cache entry %s: %s", entry_path, e)
+            self.misses += 1
+            return None
+
+        if (
+            not isinstance(entry, dict)
+            or entry.get("version") != CACHE_SCHEMA_VERSION
+            or not isinstance(entry.get("findings"), list)
+        ):
+            self.misses += 1
+            return None
+
+        self.hits += 1
+        return entry["findings"]
+
+    def put(
+        self,
+        key: str,
+        file_path: str,
+        findings: List[Dict[str, Any]],
+    ) -> None:
+        """Store findings for *key*.
+
+        Write failures are logged and swallowed — the cache is an
+        optimization and must never fail the review.
+
+        Args:
+            key: Cache key from make_cache_key().
+            file_path: File path (stored for debugging/inspection).
+            findings: Validated finding dicts for this file.
+        """
+        entry = {
+            "version": CACHE_SCHEMA_VERSION,
+            "file": file_path,
+            "findings": findings,
+        }
+        try:
+            self.cache_dir.mkdir(parents=True, exist_ok=True)
+            entry_path = self.cache_dir / f"{key}.json"
+            entry_path.write_text(
+                json.dumps(entry, ensure_ascii=False) + "\n",
+                encoding="utf-8",
+            )
+        except OSError as e:
+            logger.warning("Failed to write cache entry for %s: %s", file_path, e)
+
+    def summary(self) -> dict:
+        """Return hit/miss counters for logging."""
+        return {"cache_hits": self.hits, "cache_misses": self.misses}
@@ -0,0 +1,178 @@
+#!/usr/bin/env python3
+"""Incremental result cache for the Stage 2 clang-tidy orchestrator.
+
+UE5 translation units take 30-90 s each under clang-tidy, but between
+pushes most files are re-analyzed with identical inputs.  This cache
+stores the exported fixes YAML per file, keyed on everything that can
+change the diagnostics:
+
+    (file content hash, compile_commands.json entry hash, .clang-tidy hash)
+
+A hit replays the stored YAML without invoking clang-tidy — ccache-style.
+Entries are plain JSON files in a cache directory persisted via the
+Actions cache (or any workspace directory on self-hosted runners).
+
+Only clean completions are cached; timeouts and launch errors must be
+retried on the next run.  An *empty* fixes YAML is a valid, cacheable
+result — it means clang-tidy found nothing.
+"""
+
+from __future__ import annotations
+
+import hashlib
+import json
+import logging
+from pathlib import Path
+from typing import Any, Dict, Optional
+
+logger = logging.getLogger(__name__)
+
+# Bumped when the cached entry schema changes — old entries are ignored.
+CACHE_SCHEMA_VERSION = 1
+
+
+def load_compile_commands_index(build_dir: str) -> Dict[str, str]:
+    """Index compile_commands.json entries by resolved source path.
+
+    Args:
+        build_dir: Directory containing compile_commands.json.
+
+    Returns:
+        Mapping of resolved absolute file path to the entry's canonical
+        JSON text (used for hashing).  Empty dict when the database is
+        missing or unreadable.
+    """
+    db_path = Path(build_dir) / "compile_commands.json"
+    if not db_path.is_file():
+        return {}
+
+    try:
+        entries = json.loads(
+            db_path.read_text(encoding="utf-8", errors="replace")
+        )
+    except (json.JSONDecodeError, OSError) as e:
+        logger.warning("Failed to read %s: %s", db_path, e)
+        return {}
+
+    if not isinstance(entries, list):
+        return {}
+
+    index: Dict[str, str] = {}
+    for entry in entries:
+        if not isinstance(entry, dict):
+            continue
+        file_field = entry.get("file", "")
+        if not file_field:
+            continue
+        p = Path(file_field)
+        if not p.is_absolute():
+            p = Path(entry.get("directory", ".")) / p
+        try:
+            resolved = str(p.resolve())
+        except OSError:
+            resolved = str(p)
+        # Canonical JSON so hash is stable across key ordering.
+        index[resolved] = json.dumps(entry, sort_keys=True)
+    return index
+
+
+def make_tidy_cache_key(
+    file_content: str,
+    compile_entry: str,
+    config_text: str,
+) -> str:
+    """Build the cache key for one clang-tidy invocation.
+
+    Args:
+        file_content: Full source file content.
+        compile_entry: Canonical compile_commands.json entry text for
+            the file ("" when no entry exists).
+        config_text: Content of the .clang-tidy config file.
+
+    Returns:
+        Hex digest string usable as a filename.
+    """
+    h = hashlib.sha256()
+    for part in (file_content, compile_entry, config_text):
+        h.update(part.encode("utf-8", errors="replace"))
+        h.update(b"\x00")  # unambiguous field separator
+    return h.hexdigest()
+
+
+class TidyCache:
+    """File-backed clang-tidy fixes cache keyed on content hashes.
+
+    Usage:
+        cache = TidyCache("tidy-cache")
+        key = make_tidy_cache_key(source, entry, config)
+        cached = cache.get(key)
+        if cached is None:
+            fixes_yaml = ...  # run clang-tidy
+            cache.put(key, file_path, fixes_yaml)
+    """
+
+    def __init__(self, cache_dir: str) -> None:
+        self.cache_dir = Path(cache_dir)
+        self.hits = 0
+        self.misses = 0
+
+    def get(self, key: str) -> Optional[str]:
+        """Look up cached fixes YAML for *key*.
+
+        Returns:
+            The cached YAML text ("" for a clean file), or None on a
+            miss (including unreadable or schema-mismatched entries).
+        """
+        entry_path = self.cache_dir / f"{key}.json"
+        if not entry_path.exists():
+            self.misses += 1
+            return None
+        try:
+            entry = json.loads(
+                entry_path.read_text(encoding="utf-8", errors="replace")
+            )
+        except (json.JSONDecodeError, OSError) as e:
+            logger.warning("Failed to read cache entry %s: %s", entry_path, e)
+            self.misses += 1
+            return None
+
+        if (
+            not isinstance(entry, dict)
+            or entry.get("version") != CACHE_SCHEMA_VERSION
+            or not isinstance(entry.get("fixes_yaml"), str)
+        ):
+            self.misses += 1
+            return None
+
+        self.hits += 1
+        return entry["fixes_yaml"]
+
+    def put(self, key: str, file_path: str, fixes_yaml: str) -> None:
+        """Store fixes YAML for *key*.
+
+        Write failures are logged and swallowed — the cache is an
+        optimization and must never fail the analysis.
+
+        Args:
+            key: Cache key from make_tidy_cache_key().
+            file_path: Source path (stored for debugging/inspection).
+            fixes_yaml: Exported fixes YAML text ("" for a clean file).
+        """
+        entry: Dict[str, Any] = {
+            "version": CACHE_SCHEMA_VERSION,
+            "file": file_path,
+            "fixes_yaml": fixes_yaml,
+        }
+        try:
+            self.cache_dir.mkdir(parents=True, exist_ok=True)
+            entry_path = self.cache_dir / f"{key}.json"
+            entry_path.write_text(
+                json.dumps(entry, ensure_ascii=False) + "\n",
+                encoding="utf-8",
+            )
+        except OSError as e:
+            logger.warning("Failed to write cache entry for %s: %s", file_path, e)
+
+    def summary(self) -> dict:
+        """Return hit/miss counters for logging."""
+        return {"cache_hits": self.hits, "cache_misses": self.misses}
@@ -3,7 +3,9 @@
 
 Controls per-PR and per-file token budgets to prevent excessive API costs.
 Provides utilities for estimating token usage and chunking diffs by hunk
-boundaries.
+boundaries.  Oversized hunks are split at C++ function/class boundaries
+(lightweight brace-depth scanning) so the LLM never sees a function cut
+mid-body, with raw line splitting as the fallback when no boundary exists.
 
 Budget constants:
     BUDGET_PER_PR  = 100_000 input tokens
@@ -13,8 +15,10 @@ Budget constants:
 
 from __future__ import annotations
 
+import hashlib
 import re
-from typing import List
+import threading
+from typing import Any, Dict, List, Optional, Tuple
 
 # ---------------------------------------------------------------------------
 # Budget constants
@@ -24,10 +28,19 @@ BUDGET_PER_PR: int = 100_000  # max input tokens per PR
 BUDGET_PER_FILE: int = 20_000  # max input tokens per file
 COST_LIMIT_PER_PR: float = 2.00  # max USD per PR
 
+# Files whose whole user message (diff + optional full source) stays under
+# this many tokens are eligible for multi-file batched review in Stage 3.
+# Larger files are reviewed individually so the chunking path still applies.
+BATCH_FILE_MAX_TOKENS: int = 4_000
+
 # Approximate input token cost for claude-sonnet-4-5 ($3 per 1M input tokens).
 _INPUT_COST_PER_TOKEN: float = 3.0 / 1_000_000
 # Approximate output token cost ($15 per 1M output tokens).
 _OUTPUT_COST_PER_TOKEN: float = 15.0 / 1_000_000
+# Prompt-cache pricing relative to normal input: reads are 0.1x,
+# writes (cache creation) are 1.25x.
+_CACHE_READ_COST_PER_TOKEN: float = _INPUT_COST_PER_TOKEN * 0.1
+_CACHE_WRITE_COST_PER_TOKEN: float = _INPUT_COST_PER_TOKEN * 1.25
 # Assumed average output tokens per file review call.
 _ESTIMATED_OUTPUT_PER_FILE: int = 1_000
 # Worst-case output tokens (matches DEFAULT_MAX_TOKENS in stage3_llm_reviewer).
@@ -44,11 +57,50 @@ _SKIP_PATTERNS = [
 _SKIP_RE = [re.compile(p, re.IGNORECASE) for p in _SKIP_PATTERNS]
 
 
+# Segments that roughly correspond to BPE merge units: identifier/word
+# runs, digit runs, punctuation runs, and whitespace runs.
+_TOKEN_SEGMENT_RE = re.compile(r"[A-Za-z_]+|\d+|\s+|[^\w\s]+")
+
+# Texts at least this long are memoized by content hash — review_file()
+# re-estimates the same diff text several times per review.
+_MEMO_MIN_CHARS = 1024
+_MEMO_MAX_ENTRIES = 1024
+_memo_cache: Dict[str, int] = {}
+
+
+def _count_tokens(text: str) -> int:
+    """Count tokens by BPE-style segmentation of the text.
+
+    Identifier runs tokenize at roughly 6 characters per subword piece,
+    digit runs at ~3 digits per token, punctuation runs at ~2 characters
+    per merge, and a whitespace run (e.g. indentation) collapses to a
+    single token.  This tracks real code tokenization far closer than
+    the old ``len(text) // 3``, which counted every indentation space
+    as a third of a token.
+    """
+    count = 0
+    for m in _TOKEN_SEGMENT_RE.finditer(text):
+        seg = m.group()
+        ch = seg[0]
+        if ch.isspace():
+            count += 1
+        elif ch.isdigit():
+            count += (len(seg) + 2) // 3
+        elif ch.isalpha() or ch == "_":
+            count += (len(seg) + 5) // 6
+        else:
+            count += (len(seg) + 1) // 2
+    return count
+
+
 def estimate_tokens(text: str) -> int:
-    """Conservatively estimate token count for a text string.
+    """Estimate token count for a text string.
 
-    Uses ~3 characters per token as a conservative estimate (actual ratio
-    is typically 3.5-4 for code).
+    Counts BPE-style segments (see :func:`_count_tokens`) instead of a
+    flat characters-per-token ratio, so heavily indented code no longer
+    over-counts and fewer files hit artificial budget skips or chunk
+    boundaries.  Long texts are memoized by content hash, making
+    repeated estimates of the same diff free.
 
     Args:
         text: Input text to estimate.
@@ -56,7 +108,25 @@ def estimate_tokens(text: str) -> int:
     Returns:
         Estimated token count.
     """
-    return len(text) // 3
+    if not text:
+        return 0
+
+    key = None
+    if len(text) >= _MEMO_MIN_CHARS:
+        key = hashlib.sha1(
+            text.encode("utf-8", errors="replace")
+        ).hexdigest()
+        cached = _memo_cache.get(key)
+        if cached is not None:
+            return cached
+
+    count = _count_tokens(text)
+
+    if key is not None:
+        if len(_memo_cache) >= _MEMO_MAX_ENTRIES:
+            _memo_cache.clear()
+        _memo_cache[key] = count
+    return count
 
 
 def estimate_cost(input_tokens: int, output_tokens: int = _ESTIMATED_OUTPUT_PER_FILE) -> float:
@@ -94,7 +164,9 @@ def chunk_diff(file_diff: str, max_tokens: int = BUDGET_PER_FILE) -> List[str]:
     """Split a file diff into chunks that fit within token budget.
 
     Splits on @@ hunk headers first.  If a single hunk exceeds
-    ``max_tokens``, it is further split into smaller line-based chunks.
+    ``max_tokens``, it is further split at C++ function/class boundaries
+    (brace-depth scanning of the new-file side), falling back to raw
+    line-based splitting when the hunk contains no such boundaries.
 
     Args:
         file_diff: Full unified diff text for a single file.
@@ -157,7 +229,7 @@ def chunk_diff(file_diff: str, max_tokens: int = BUDGET_PER_FILE) -> List[str]:
                 sample_prefix = header + hunk_hdr_line + "\n"
                 prefix_tokens = estimate_tokens(sample_prefix)
                 body_budget = max(max_tokens - prefix_tokens, 100)
-                sub_chunks = _split_by_lines(hunk_body, body_budget)
+                sub_chunks = _split_by_code_units(hunk_body, body_budget)
 
                 # Rewrite @@ header per sub-chunk with correct line ranges.
                 for sc in sub_chunks:
@@ -275,6 +347,149 @@ def _split_by_lines(text: str, max_tokens: int) -> List[str]:
     return chunks
 
 
+def _line_brace_delta(code: str, in_block_comment: bool) -> Tuple[int, bool]:
+    """Net ``{``/``}`` depth change for one line of C++ source.
+
+    Braces inside string literals, character literals, ``//`` comments
+    and ``/* */`` comments are ignored.  Block comment state is carried
+    across lines via *in_block_comment*.
+
+    Args:
+        code: Source line content (diff prefix already stripped).
+        in_block_comment: True if the line starts inside a ``/* */``.
+
+    Returns:
+        Tuple of (net brace delta, whether a block comment is still
+        open at the end of the line).
+    """
+    delta = 0
+    i = 0
+    n = len(code)
+    while i < n:
+        if in_block_comment:
+            end = code.find("*/", i)
+            if end == -1:
+                return delta, True
+            in_block_comment = False
+            i = end + 2
+            continue
+        ch = code[i]
+        if ch == "/" and i + 1 < n:
+            nxt = code[i + 1]
+            if nxt == "/":
+                break  # rest of line is a comment
+            if nxt == "*":
+                in_block_comment = True
+                i += 2
+                continue
+        if ch in ('"', "'"):
+            quote = ch
+            i += 1
+            while i < n and code[i] != quote:
+                if code[i] == "\\":
+                    i += 1  # skip the escaped character too
+                i += 1
+            i += 1
+            continue
+        if ch == "{":
+            delta += 1
+        elif ch == "}":
+            delta -= 1
+        i += 1
+    return delta, in_block_comment
+
+
+def _split_into_code_units(text: str) -> List[List[str]]:
+    """Group diff hunk lines into C++ semantic units.
+
+    Tracks brace depth over the new-file side of the hunk (added and
+    context lines; deletion-only lines belong to the surrounding unit
+    but do not affect depth).  A unit ends when depth returns to zero —
+    the close of a function, class, or namespace body — or at a blank
+    line between top-level declarations.
+
+    No full parser: brace-depth scanning is enough here because a chunk
+    boundary only needs to avoid landing *inside* a body, and unmatched
+    braces simply degrade to fewer boundaries (never wrong content).
+
+    Args:
+        text: Hunk body text (diff lines, no @@ header).
+
+    Returns:
+        List of units, each a list of consecutive diff lines.
+    """
+    units: List[List[str]] = []
+    current: List[str] = []
+    depth = 0
+    in_block_comment = False
+
+    for line in text.split("\n"):
+        current.append(line)
+        if _is_diff_meta_line(line) or line.startswith("-"):
+            continue
+        code = line[1:] if line[:1] in ("+", " ") else line
+        prev_depth = depth
+        delta, in_block_comment = _line_brace_delta(code, in_block_comment)
+        depth = max(depth + delta, 0)
+        if depth == 0 and not in_block_comment:
+            if (prev_depth > 0 and delta < 0) or not code.strip():
+                units.append(current)
+                current = []
+
+    if current:
+        units.append(current)
+    return units
+
+
+def _split_by_code_units(text: str, max_tokens: int) -> List[str]:
+    """Split hunk body text at function/class boundaries within budget.
+
+    Whole semantic units (see ``_split_into_code_units``) are packed
+    greedily up to ``max_tokens``, so each resulting chunk holds only
+    complete functions/classes whenever the hunk has such boundaries.
+    A single unit that alone exceeds the budget — one giant function —
+    falls back to ``_split_by_lines``, as does a hunk with no
+    boundaries at all.
+
+    Args:
+        text: Hunk body text (diff lines, no @@ header).
+        max_tokens: Maximum tokens per chunk.
+
+    Returns:
+        List of diff text chunks.
+    """
+    units = _split_into_code_units(text)
+    if len(units) <= 1:
+        return _split_by_lines(text, max_tokens)
+
+    chunks: List[str] = []
+    current_lines: List[str] = []
+    current_tokens = 0
+
+    for unit in units:
+        unit_text = "\n".join(unit)
+        # +1 for the newline joining this unit to the previous one.
+        unit_tokens = max(estimate_tokens(unit_text), 1) + 1
+        if unit_tokens > max_tokens:
+            if current_lines:
+                chunks.append("\n".join(current_lines))
+                current_lines = []
+                current_tokens = 0
+            chunks.extend(_split_by_lines(unit_text, max_tokens))
+            continue
+        if current_tokens + unit_tokens > max_tokens and current_lines:
+            chunks.append("\n".join(current_lines))
+            current_lines = []
+            current_tokens = 0
+        current_lines.extend(unit)
+        current_tokens += unit_tokens
+
+    if current_lines:
+        chunks.append("\n".join(current_lines))
+
+    return chunks
+
+
 class BudgetTracker:
     """Tracks cumulative token usage and cost across a PR review session.
 
@@ -294,11 +509,21 @@ class BudgetTracker:
     ) -> None:
         self.max_tokens = max_tokens
         self.max_cost = max_cost
+        self._lock = threading.Lock()
+        self.reserved_tokens = 0
+        self.reserved_cost = 0.0
         self.total_input_tokens = 0
         self.total_output_tokens = 0
+        self.total_cache_read_tokens = 0
+        self.total_cache_creation_tokens = 0
         self.total_cost = 0.0
         self.files_reviewed = 0
         self.files_skipped_budget = 0
+        # Per-model usage: model ID -> api_calls / token / cost counters.
+        # Populated only when callers pass ``model=`` to the record
+        # methods (complexity-based routing sends files to different
+        # models; the summary must show where the budget went).
+        self.per_model: Dict[str, Dict[str, Any]] = {}
 
     def can_review_file(self, estimated_input_tokens: int) -> bool:
         """Check if there is enough budget remaining to review a file.
@@ -313,58 +538,226 @@ class BudgetTracker:
         Returns:
             True if the file can be reviewed within budget.
         """
-        if self.total_input_tokens + estimated_input_tokens > self.max_tokens:
+        with self._lock:
+            return self._has_headroom(estimated_input_tokens)
+
+    def _has_headroom(self, estimated_input_tokens: int) -> bool:
+        """Check token and cost headroom, counting open reservations.
+
+        Caller must hold ``self._lock``.
+        """
+        committed = self.total_input_tokens + self.reserved_tokens
+        if committed + estimated_input_tokens > self.max_tokens:
             return False
-        estimated_cost = self.total_cost + estimate_cost(
-            estimated_input_tokens, _MAX_OUTPUT_PER_CALL
+        estimated_cost = (
+            self.total_cost
+            + self.reserved_cost
+            + estimate_cost(estimated_input_tokens, _MAX_OUTPUT_PER_CALL)
         )
         if estimated_cost > self.max_cost:
             return False
         return True
 
-    def record_usage(self, input_tokens: int, output_tokens: int) -> None:
+    def reserve(self, estimated_input_tokens: int) -> bool:
+        """Atomically reserve budget for an API call about to be made.
+
+        The check-then-record window of ``can_review_file()`` +
+        ``record_usage()`` spans a whole API round-trip, so parallel
+        workers could collectively overshoot the PR budget by the
+        requests in flight.  Reservations close that window: a worker
+        reserves its estimate up front, makes the call, then either
+        :meth:`settle`\ s with actual usage or :meth:`release`\ s on
+        failure.
+
+        Args:
+            estimated_input_tokens: Estimated input tokens to reserve.
+
+        Returns:
+            True if the reservation was granted; False when it would
+            exceed the token or cost budget (nothing is reserved).
+        """
+        with self._lock:
+            if not self._has_headroom(estimated_input_tokens):
+                return False
+            self.reserved_tokens += estimated_input_tokens
+            self.reserved_cost += estimate_cost(
+                estimated_input_tokens, _MAX_OUTPUT_PER_CALL
+            )
+            return True
+
+    def settle(
+        self,
+        reserved_input_tokens: int,
+        input_tokens: int,
+        output_tokens: int,
+        cache_read_tokens: int = 0,
+        cache_creation_tokens: int = 0,
+        model: Optional[str] = None,
+    ) -> None:
+        """Release a reservation and record the call's actual usage.
+
+        Args:
+            reserved_input_tokens: The amount passed to :meth:`reserve`.
+            input_tokens: Actual (uncached) input tokens used.
+            output_tokens: Actual output tokens used.
+            cache_read_tokens: Prompt-cache read tokens, if any.
+            cache_creation_tokens: Prompt-cache write tokens, if any.
+            model: Model ID that served the call, for per-model
+                accounting.
+        """
+        with self._lock:
+            self._release_locked(reserved_input_tokens)
+            self._record_locked(
+                input_tokens,
+                output_tokens,
+                cache_read_tokens,
+                cache_creation_tokens,
+                model=model,
+            )
+
+    def release(self, reserved_input_tokens: int) -> None:
+        """Release a reservation without recording usage (call failed).
+
+        Args:
+            reserved_input_tokens: The amount passed to :meth:`reserve`.
+        """
+        with self._lock:
+            self._release_locked(reserved_input_tokens)
+
+    def _release_locked(self, reserved_input_tokens: int) -> None:
+        """Drop a reservation.  Caller must hold ``self._lock``."""
+        self.reserved_tokens = max(
+            0, self.reserved_tokens - reserved_input_tokens
+        )
+        self.reserved_cost = max(
+            0.0,
+            self.reserved_cost
+            - estimate_cost(reserved_input_tokens, _MAX_OUTPUT_PER_CALL),
+        )
+
+    def record_usage(
+        self,
+        input_tokens: int,
+        output_tokens: int,
+        cache_read_tokens: int = 0,
+        cache_creation_tokens: int = 0,
+        model: Optional[str] = None,
+    ) -> None:
         """Record actual token usage after an API call.
 
         Also increments ``files_reviewed`` — use for single-call file reviews.
         For chunked reviews, use :meth:`record_chunk_usage` per chunk and
         :meth:`record_file_reviewed` once after all chunks.
 
+        With prompt caching, the API reports cached prefix tokens
+        separately from ``input_tokens``.  They are tracked (and priced
+        at cache-read/-write rates) in their own counters; the token
+        budget keeps applying to uncached input only, since cached
+        reads are an order of magnitude cheaper.
+
         Args:
-            input_tokens: Actual input tokens used.
+            input_tokens: Actual (uncached) input tokens used.
             output_tokens: Actual output tokens used.
+            cache_read_tokens: Prompt-cache read tokens, if any.
+            cache_creation_tokens: Prompt-cache write tokens, if any.
         """
-        self.total_input_tokens += input_tokens
-        self.total_output_tokens += output_tokens
-        self.total_cost += estimate_cost(input_tokens, output_tokens)
-        self.files_reviewed += 1
+        self.record_chunk_usage(
+            input_tokens,
+            output_tokens,
+            cache_read_tokens=cache_read_tokens,
+            cache_creation_tokens=cache_creation_tokens,
+            model=model,
+        )
+        self.record_file_reviewed()
 
-    def record_chunk_usage(self, input_tokens: int, output_tokens: int) -> None:
+    def record_chunk_usage(
+        self,
+        input_tokens: int,
+        output_tokens: int,
+        cache_read_tokens: int = 0,
+        cache_creation_tokens: int = 0,
+        model: Optional[str] = None,
+    ) -> None:
         """Record token usage for a single chunk without incrementing file count.
 
         Args:
-            input_tokens: Actual input tokens used.
+            input_tokens: Actual (uncached) input tokens used.
             output_tokens: Actual output tokens used.
+            cache_read_tokens: Prompt-cache read tokens, if any.
+            cache_creation_tokens: Prompt-cache write tokens, if any.
+            model: Model ID that served the call, for per-model
+                accounting.
         """
+        with self._lock:
+            self._record_locked(
+                input_tokens,
+                output_tokens,
+                cache_read_tokens,
+                cache_creation_tokens,
+                model=model,
+            )
+
+    def _record_locked(
+        self,
+        input_tokens: int,
+        output_tokens: int,
+        cache_read_tokens: int,
+        cache_creation_tokens: int,
+        model: Optional[str] = None,
+    ) -> None:
+        """Add actual usage to the totals.  Caller must hold ``self._lock``."""
         self.total_input_tokens += input_tokens
         self.total_output_tokens += output_tokens
-        self.total_cost += estimate_cost(input_tokens, output_tokens)
+        self.total_cache_read_tokens += cache_read_tokens
+        self.total_cache_creation_tokens += cache_creation_tokens
+        call_cost = estimate_cost(input_tokens, output_tokens)
+        call_cost += cache_read_tokens * _CACHE_READ_COST_PER_TOKEN
+        call_cost += cache_creation_tokens * _CACHE_WRITE_COST_PER_TOKEN
+        self.total_cost += call_cost
+        if model is not None:
+            entry = self.per_model.setdefault(
+                model,
+                {
+                    "api_calls": 0,
+                    "input_tokens": 0,
+                    "output_tokens": 0,
+                    "cost_usd": 0.0,
+                },
+            )
+            entry["api_calls"] += 1
+            entry["input_tokens"] += input_tokens
+            entry["output_tokens"] += output_tokens
+            entry["cost_usd"] += call_cost
 
     def record_file_reviewed(self) -> None:
         """Increment the file-reviewed counter by one."""
-        self.files_reviewed += 1
+        with self._lock:
+            self.files_reviewed += 1
 
     def record_skip(self) -> None:
         """Record that a file was skipped due to budget exhaustion."""
-        self.files_skipped_budget += 1
+        with self._lock:
+            self.files_skipped_budget += 1
 
     def summary(self) -> dict:
         """Return a summary dict of budget usage."""
-        return {
-            "total_input_tokens": self.total_input_tokens,
-            "total_output_tokens": self.total_output_tokens,
-            "total_cost_usd": round(self.total_cost, 4),
-            "files_reviewed": self.files_reviewed,
-            "files_skipped_budget": self.files_skipped_budget,
-            "budget_remaining_tokens": self.max_tokens - self.total_input_tokens,
-            "budget_remaining_usd": round(self.max_cost - self.total_cost, 4),
-        }
+        with self._lock:
+            return {
+                "total_input_tokens": self.total_input_tokens,
+                "total_output_tokens": self.total_output_tokens,
+                "cache_read_input_tokens": self.total_cache_read_tokens,
+                "cache_creation_input_tokens": self.total_cache_creation_tokens,
+                "total_cost_usd": round(self.total_cost, 4),
+                "files_reviewed": self.files_reviewed,
+                "files_skipped_budget": self.files_skipped_budget,
+                "budget_remaining_tokens": (
+                    self.max_tokens - self.total_input_tokens
+                ),
+                "budget_remaining_usd": round(
+                    self.max_cost - self.total_cost, 4
+                ),
+                "per_model": {
+                    name: {**entry, "cost_usd": round(entry["cost_usd"], 4)}
+                    for name, entry in self.per_model.items()
+                },
+            }
@@ -0,0 +1,111 @@
+"""Benchmark harness with JSON baselines and regression thresholds.
+
+Each benchmark runs a warm-up pass, then *repeats* timed passes, and
+keeps the best (minimum) wall time — the least noisy estimate of a
+function's cost.  Results are compared against per-machine baselines
+stored in ``tests/perf/baselines.json``:
+
+- No baseline for a benchmark yet → the measurement is recorded and
+  the check passes (first run seeds the file).
+- Baseline present → the check fails when the measurement exceeds
+  ``baseline * REGRESSION_FACTOR``.
+- ``PERF_UPDATE_BASELINE=1`` → baselines are rewritten with the
+  current measurements (use after an intentional change).
+
+Baselines are machine-specific timings, so the JSON file is a local
+artifact and is not meant to be committed.
+"""
+
+from __future__ import annotations
+
+import json
+import os
+import time
+from pathlib import Path
+from typing import Any, Callable, Dict
+
+BASELINE_PATH = Path(__file__).resolve().parent / "baselines.json"
+
+# A regression must be this many times slower than baseline to fail.
+# Generous on purpose: shared runners jitter, and the suite should only
+# catch real algorithmic regressions (the ones we have been bitten by
+# were 10x+), not scheduler noise.
+REGRESSION_FACTOR = 3.0
+
+DEFAULT_WARMUP = 1
+DEFAULT_REPEATS = 3
+
+
+def run_benchmark(
+    func: Callable[[], Any],
+    warmup: int = DEFAULT_WARMUP,
+    repeats: int = DEFAULT_REPEATS,
+) -> float:
+    """Time *func* and return the best wall time in seconds.
+
+    Args:
+        func: Zero-argument callable to benchmark.
+        warmup: Untimed warm-up invocations (JIT-free Python still
+            benefits: memo caches fill, imports settle).
+        repeats: Timed invocations; the minimum is returned.
+
+    Returns:
+        Best observed duration in seconds.
+    """
+    for _ in range(warmup):
+        func()
+    best = float("inf")
+    for _ in range(repeats):
+        start = time.perf_counter()
+        func()
+        best = min(best, time.perf_counter() - start)
+    return best
+
+
+def _load_baselines() -> Dict[str, float]:
+    """Load the baseline file, tolerating absence or corruption."""
+    try:
+        data = json.loads(BASELINE_PATH.read_text(encoding="utf-8"))
+        if isinstance(data, dict):
+            return {k: float(v) for k, v in data.items()}
+    except (OSError, ValueError):
+        pass
+    return {}
+
+
+def _save_baselines(baselines: Dict[str, float]) -> None:
+    BASELINE_PATH.write_text(
+        json.dumps(baselines, indent=2, sort_keys=True) + "\n",
+        encoding="utf-8",
+    )
+
+
+def check_regression(name: str, seconds: float) -> None:
+    """Assert *seconds* does not regress past the recorded baseline.
+
+    Seeds the baseline on first sight of *name*; rewrites it when
+    ``PERF_UPDATE_BASELINE=1`` is set.
+
+    Args:
+        name: Stable benchmark identifier (e.g. ``parse_diff/100x100``).
+        seconds: Measured best time from :func:`run_benchmark`.
+
+    Raises:
+        AssertionError: When the measurement exceeds the regression
+            threshold.
+    """
+    baselines = _load_baselines()
+    update = os.environ.get("PERF_UPDATE_BASELINE") == "1"
+
+    if name not in baselines or update:
+        baselines[name] = seconds
+        _save_baselines(baselines)
+        return
+
+    limit = baselines[name] * REGRESSION_FACTOR
+    assert seconds <= limit, (
+        f"Performance regression in {name}: {seconds * 1000:.1f} ms "
+        f"vs baseline {baselines[name] * 1000:.1f} ms "
+        f"(limit {limit * 1000:.1f} ms). If this slowdown is intended, "
+        f"rerun with PERF_UPDATE_BASELINE=1."
+    )
@@ -0,0 +1,105 @@
+"""Synthetic PR fixtures for the performance benchmark suite.
+
+Generates unified diffs and finding lists at controlled scales so hot
+paths can be benchmarked without checking large fixture files into the
+repo.  Generation is deterministic (seeded) — the same scale always
+produces byte-identical input, keeping timings comparable across runs.
+"""
+
+from __future__ import annotations
+
+import random
+from typing import Any, Dict, List
+
+# A small pool of realistic UE5-flavoured added lines.  Some lines
+# intentionally trip Tier 1 patterns so check_diff() does real work.
+_LINE_POOL = [
+    "    Super::BeginPlay();",
+    "    PrimaryActorTick.bCanEverTick = true;",
+    '    UE_LOG(LogTemp, Warning, TEXT("State changed: %d"), Value);',
+    "    auto Result = ComputeSomething(Input);",
+    "    if (!bInitialized)",
+    "    if (false == bReady)",
+    "    for (const FItemData& Item : Items)",
+    "    TArray<int32> Values;",
+    "    Values.Add(NewValue);",
+    "    UPROPERTY(EditAnywhere, Category = \"Combat\")",
+    "    void HandleDamage(float DamageAmount, AActor* Instigator);",
+    "    const FVector Location = GetActorLocation();",
+    "    // 외부 수식: 감쇠 공식 적용",
+    "    float Falloff = FMath::Pow(Distance, -2.0f);",
+    "    check(OwnerCharacter != nullptr);",
+    "    OnHealthChanged.Broadcast(CurrentHealth);",
+]
+
+
+def make_synthetic_diff(num_files: int, lines_per_file: int) -> str:
+    """Build a unified diff with *num_files* files of added lines.
+
+    Each file gets hunks of ~40 added lines with context lines between
+    them, mimicking the shape of real PR diffs (multiple hunks per
+    file, mixed context and additions).
+
+    Args:
+        num_files: Number of files in the diff.
+        lines_per_file: Added lines per file.
+
+    Returns:
+        Unified diff text.
+    """
+    rng = random.Random(1234)
+    parts: List[str] = []
+    for i in range(num_files):
+        path = f"Source/Game/Module{i % 20}/File{i}.cpp"
+        parts.append(f"diff --git a/{path} b/{path}")
+        parts.append("index 1111111..2222222 100644")
+        parts.append(f"--- a/{path}")
+        parts.append(f"+++ b/{path}")
+        remaining = lines_per_file
+        old_line = 1
+        new_line = 1
+        while remaining > 0:
+            added = min(40, remaining)
+            context = 3
+            parts.append(
+                f"@@ -{old_line},{context} +{new_line},{added + context} @@"
+            )
+            parts.append(" {")
+            for _ in range(added):
+                parts.append("+" + rng.choice(_LINE_POOL))
+            parts.append(" }")
+            parts.append(" ")
+            old_line += context + 20
+            new_line += added + context + 20
+            remaining -= added
+    parts.append("")
+    return "\n".join(parts)
+
+
+def make_synthetic_findings(count: int, duplicate_ratio: float = 0.3) -> List[Dict[str, Any]]:
+    """Build a finding list with a controlled share of duplicates.
+
+    Args:
+        count: Total number of findings.
+        duplicate_ratio: Fraction of findings that duplicate an earlier
+            (file, line, rule_id) key — the work deduplicate_findings()
+            actually has to do.
+
+    Returns:
+        List of finding dicts in the shared stage format.
+    """
+    rng = random.Random(5678)
+    unique = max(1, int(count * (1.0 - duplicate_ratio)))
+    findings: List[Dict[str, Any]] = []
+    for i in range(count):
+        key = i if i < unique else rng.randrange(unique)
+        findings.append(
+            {
+                "file": f"Source/Game/File{key % 200}.cpp",
+                "line": (key * 7) % 1000 + 1,
+                "rule_id": f"rule_{key % 12}",
+                "severity": rng.choice(["warning", "error", "suggestion"]),
+                "message": f"지적 사항 {key}: 수정이 필요합니다.",
+            }
+        )
+    return findings
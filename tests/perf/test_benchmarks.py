@@ -0,0 +1,112 @@
+"""Performance benchmarks for the review pipeline's hot paths.
+
+Times parse_diff(), check_diff(), chunk_diff(), _compute_diff_regions(),
+and deduplicate_findings() against synthetic PRs at three scales and fails
+when a function regresses past its recorded baseline (see bench.py for
+the baseline/threshold mechanics).
+
+Scales (files x added lines per file):
+  small:  10 x 100   (~1k added lines)
+  medium: 100 x 100  (~10k added lines)
+  large:  1000 x 100 (~100k added lines, parse only — parsing is the
+          only hot path that must swallow engine-merge PRs whole; the
+          gate caps what later stages see)
+"""
+
+from __future__ import annotations
+
+import sys
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent.parent))
+
+from scripts.post_review import deduplicate_findings
+from scripts.stage1_format_diff import _compute_diff_regions
+from scripts.stage1_pattern_checker import check_diff, load_tier1_patterns
+from scripts.utils.diff_parser import parse_diff
+from scripts.utils.token_budget import chunk_diff
+from tests.perf.bench import check_regression, run_benchmark
+from tests.perf.synthetic import make_synthetic_diff, make_synthetic_findings
+
+CHECKLIST_PATH = (
+    Path(__file__).resolve().parent.parent.parent / "configs" / "checklist.yml"
+)
+
+# Generated once per session — generation cost must not pollute timings.
+_SMALL_DIFF = make_synthetic_diff(10, 100)
+_MEDIUM_DIFF = make_synthetic_diff(100, 100)
+_LARGE_DIFF = make_synthetic_diff(1000, 100)
+
+
+class TestParseDiffBenchmarks:
+    def test_parse_diff_small(self):
+        check_regression(
+            "parse_diff/10x100",
+            run_benchmark(lambda: parse_diff(_SMALL_DIFF)),
+        )
+
+    def test_parse_diff_medium(self):
+        check_regression(
+            "parse_diff/100x100",
+            run_benchmark(lambda: parse_diff(_MEDIUM_DIFF)),
+        )
+
+    def test_parse_diff_large(self):
+        check_regression(
+            "parse_diff/1000x100",
+            run_benchmark(lambda: parse_diff(_LARGE_DIFF)),
+        )
+
+
+class TestCheckDiffBenchmarks:
+    def test_check_diff_small(self):
+        patterns = load_tier1_patterns(str(CHECKLIST_PATH))
+        diff_data = parse_diff(_SMALL_DIFF)
+        check_regression(
+            "check_diff/10x100",
+            run_benchmark(lambda: check_diff(diff_data, patterns)),
+        )
+
+    def test_check_diff_medium(self):
+        patterns = load_tier1_patterns(str(CHECKLIST_PATH))
+        diff_data = parse_diff(_MEDIUM_DIFF)
+        check_regression(
+            "check_diff/100x100",
+            run_benchmark(lambda: check_diff(diff_data, patterns)),
+        )
+
+
+class TestChunkDiffBenchmarks:
+    def test_chunk_diff_single_large_file(self):
+        # One 20k-line file diff forced through hunk splitting — large
+        # enough to exercise the re-estimation loop, small enough to
+        # keep the whole perf suite in single-digit seconds.
+        file_diff = make_synthetic_diff(1, 20_000)
+        check_regression(
+            "chunk_diff/1x20000",
+            run_benchmark(lambda: chunk_diff(file_diff, max_tokens=8_000)),
+        )
+
+
+class TestDeduplicateFindingsBenchmarks:
+    def test_deduplicate_10k_findings(self):
+        findings = make_synthetic_findings(10_000)
+        check_regression(
+            "deduplicate_findings/10000",
+            run_benchmark(lambda: deduplicate_findings(findings)),
+        )
+
+
+class TestComputeDiffRegionsBenchmarks:
+    def test_local_change_in_large_file(self):
+        # A 5k-line file where clang-format touched one line — the
+        # common case prefix/suffix anchoring is meant to make cheap.
+        original = [f"int Value{i} = {i};\n" for i in range(5000)]
+        formatted = list(original)
+        formatted[2500] = "int Value2500      = 2500;\n"
+        check_regression(
+            "compute_diff_regions/5000x1",
+            run_benchmark(
+                lambda: _compute_diff_regions(original, formatted)
+            ),
+        )
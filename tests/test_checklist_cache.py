@@ -0,0 +1,229 @@
+"""Tests for scripts/utils/checklist_cache.py — precompiled checklist cache.
+
+Covers:
+  - Rule extraction and validation from checklist.yml
+  - Cache artifact build, reuse (mtime fast path + hash fallback), and
+    staleness detection
+  - Graceful fallback on corrupt or mismatched artifacts
+  - CLI build step and load_tier1_patterns equivalence
+"""
+
+from __future__ import annotations
+
+import json
+import os
+import subprocess
+import sys
+import textwrap
+from pathlib import Path
+
+import pytest
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
+
+from scripts.stage1_pattern_checker import load_tier1_patterns
+from scripts.utils.checklist_cache import (
+    CACHE_SCHEMA_VERSION,
+    compile_rules,
+    extract_tier1_rules,
+    load_tier1_rules,
+)
+
+CHECKLIST_PATH = (
+    Path(__file__).resolve().parent.parent / "configs" / "checklist.yml"
+)
+
+SAMPLE_CHECKLIST = textwrap.dedent("""\
+    version: "1.0"
+    categories:
+      - name: logging
+        items:
+          - id: logtemp
+            tier: 1
+            pattern: "LogTemp"
+            severity: warning
+            summary: "LogTemp 사용"
+          - id: llm_only
+            tier: 3
+            summary: "No pattern here"
+""")
+
+
+def _write_checklist(tmp_path, content=SAMPLE_CHECKLIST):
+    path = tmp_path / "checklist.yml"
+    path.write_text(content, encoding="utf-8")
+    return path
+
+
+class TestExtractTier1Rules:
+    def test_extracts_only_tier1_with_pattern(self, tmp_path):
+        import yaml
+
+        checklist = yaml.safe_load(SAMPLE_CHECKLIST)
+        rules = extract_tier1_rules(checklist, "checklist.yml")
+        assert [r["id"] for r in rules] == ["logtemp"]
+        assert rules[0]["pattern"] == "LogTemp"
+
+    def test_rules_are_json_serializable(self):
+        import yaml
+
+        checklist = yaml.safe_load(SAMPLE_CHECKLIST)
+        rules = extract_tier1_rules(checklist, "checklist.yml")
+        assert json.loads(json.dumps(rules)) == rules
+
+    def test_invalid_regex_raises(self):
+        checklist = {
+            "categories": [
+                {"items": [{"id": "bad", "tier": 1, "pattern": "("}]}
+            ]
+        }
+        with pytest.raises(ValueError, match="bad"):
+            extract_tier1_rules(checklist, "checklist.yml")
+
+    def test_non_mapping_raises(self):
+        with pytest.raises(ValueError, match="not a YAML mapping"):
+            extract_tier1_rules(None, "checklist.yml")
+
+
+class TestLoadTier1Rules:
+    def test_missing_checklist_raises(self, tmp_path):
+        with pytest.raises(FileNotFoundError):
+            load_tier1_rules(str(tmp_path / "nope.yml"))
+
+    def test_builds_cache_artifact(self, tmp_path):
+        checklist = _write_checklist(tmp_path)
+        cache = tmp_path / "cache.json"
+        rules = load_tier1_rules(str(checklist), cache_path=str(cache))
+        assert [r["id"] for r in rules] == ["logtemp"]
+        data = json.loads(cache.read_text(encoding="utf-8"))
+        assert data["schema_version"] == CACHE_SCHEMA_VERSION
+        assert data["rules"] == rules
+
+    def test_valid_cache_skips_yaml_parse(self, tmp_path):
+        checklist = _write_checklist(tmp_path)
+        cache = tmp_path / "cache.json"
+        load_tier1_rules(str(checklist), cache_path=str(cache))
+
+        # Corrupt the YAML but keep its size and restore its mtime — a
+        # cache hit on the fast path proves the parse was skipped.
+        stat = checklist.stat()
+        checklist.write_text("{" * stat.st_size, encoding="utf-8")
+        os.utime(checklist, ns=(stat.st_atime_ns, stat.st_mtime_ns))
+
+        rules = load_tier1_rules(str(checklist), cache_path=str(cache))
+        assert [r["id"] for r in rules] == ["logtemp"]
+
+    def test_hash_fallback_on_fresh_checkout_mtime(self, tmp_path):
+        checklist = _write_checklist(tmp_path)
+        cache = tmp_path / "cache.json"
+        load_tier1_rules(str(checklist), cache_path=str(cache))
+
+        # Same content, new mtime (e.g. a fresh checkout in another job)
+        os.utime(checklist)
+        before = cache.read_text(encoding="utf-8")
+        rules = load_tier1_rules(str(checklist), cache_path=str(cache))
+        assert [r["id"] for r in rules] == ["logtemp"]
+        assert cache.read_text(encoding="utf-8") == before
+
+    def test_stale_cache_is_rebuilt(self, tmp_path):
+        checklist = _write_checklist(tmp_path)
+        cache = tmp_path / "cache.json"
+        load_tier1_rules(str(checklist), cache_path=str(cache))
+
+        _write_checklist(
+            tmp_path,
+            SAMPLE_CHECKLIST.replace("id: logtemp", "id: renamed"),
+        )
+        rules = load_tier1_rules(str(checklist), cache_path=str(cache))
+        assert [r["id"] for r in rules] == ["renamed"]
+        data = json.loads(cache.read_text(encoding="utf-8"))
+        assert [r["id"] for r in data["rules"]] == ["renamed"]
+
+    def test_corrupt_cache_warns_and_rebuilds(self, tmp_path, capsys):
+        checklist = _write_checklist(tmp_path)
+        cache = tmp_path / "cache.json"
+        cache.write_text("{not json", encoding="utf-8")
+
+        rules = load_tier1_rules(str(checklist), cache_path=str(cache))
+        assert [r["id"] for r in rules] == ["logtemp"]
+        assert "Could not read" in capsys.readouterr().err
+
+    def test_schema_version_mismatch_rebuilds(self, tmp_path):
+        checklist = _write_checklist(tmp_path)
+        cache = tmp_path / "cache.json"
+        load_tier1_rules(str(checklist), cache_path=str(cache))
+
+        data = json.loads(cache.read_text(encoding="utf-8"))
+        data["schema_version"] = CACHE_SCHEMA_VERSION + 1
+        data["rules"] = [{"id": "poisoned", "pattern": "x"}]
+        cache.write_text(json.dumps(data), encoding="utf-8")
+
+        rules = load_tier1_rules(str(checklist), cache_path=str(cache))
+        assert [r["id"] for r in rules] == ["logtemp"]
+
+
+class TestCompileRules:
+    def test_matches_direct_yaml_load(self):
+        """Cached-and-recompiled patterns equal the direct YAML load."""
+        direct = load_tier1_patterns(str(CHECKLIST_PATH))
+        rules = load_tier1_rules(str(CHECKLIST_PATH))
+        recompiled = compile_rules(rules)
+
+        assert len(recompiled) == len(direct)
+        for a, b in zip(recompiled, direct):
+            assert a["id"] == b["id"]
+            assert a["compiled"].pattern == b["compiled"].pattern
+            assert a["severity"] == b["severity"]
+            assert a["summary"] == b["summary"]
+            assert a["auto_fixable"] == b["auto_fixable"]
+            prev_a = a["prev_compiled"].pattern if a["prev_compiled"] else None
+            prev_b = b["prev_compiled"].pattern if b["prev_compiled"] else None
+            assert prev_a == prev_b
+
+
+class TestCLI:
+    SCRIPT = (
+        Path(__file__).resolve().parent.parent
+        / "scripts" / "utils" / "checklist_cache.py"
+    )
+
+    def test_build_step_writes_artifact(self, tmp_path):
+        cache = tmp_path / "checklist-cache.json"
+        result = subprocess.run(
+            [
+                sys.executable, str(self.SCRIPT),
+                "--checklist", str(CHECKLIST_PATH),
+                "--cache", str(cache),
+            ],
+            capture_output=True, text=True,
+        )
+        assert result.returncode == 0, f"CLI failed: {result.stderr}"
+        assert cache.exists()
+
+        # The artifact drives load_tier1_patterns to the same result
+        via_cache = load_tier1_patterns(
+            str(CHECKLIST_PATH), cache_path=str(cache)
+        )
+        direct = load_tier1_patterns(str(CHECKLIST_PATH))
+        assert [p["id"] for p in via_cache] == [p["id"] for p in direct]
+
+    def test_build_step_fails_on_invalid_checklist(self, tmp_path):
+        bad = tmp_path / "checklist.yml"
+        bad.write_text(
+            "categories:\n"
+            "  - items:\n"
+            "      - id: broken\n"
+            "        tier: 1\n"
+            "        pattern: '('\n",
+            encoding="utf-8",
+        )
+        result = subprocess.run(
+            [
+                sys.executable, str(self.SCRIPT),
+                "--checklist", str(bad),
+                "--cache", str(tmp_path / "cache.json"),
+            ],
+            capture_output=True, text=True,
+        )
+        assert result.returncode == 1
+        assert "broken" in result.stderr
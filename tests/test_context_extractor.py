@@ -0,0 +1,276 @@
+"""Tests for scripts/utils/context_extractor.py — function-scope context.
+
+Covers:
+  - Brace-block tree construction (nesting, headers, comment/string
+    brace immunity, unbalanced-brace degradation)
+  - Line selection: enclosing function bodies, outer-scope signatures,
+    preamble/UE-macro retention, oversized-block fallback radius
+  - extract_review_context end-to-end: small-file and no-savings
+    passthrough, elision markers, changed-line retention
+  - review_pr integration: large sources are reduced before reaching
+    the API message
+"""
+
+from __future__ import annotations
+
+import sys
+import textwrap
+from pathlib import Path
+from unittest.mock import patch
+
+import pytest
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
+
+from scripts.utils.context_extractor import (
+    FALLBACK_RADIUS,
+    MAX_BLOCK_LINES,
+    MIN_EXTRACT_LINES,
+    _build_block_tree,
+    _scan_line_events,
+    extract_review_context,
+)
+
+
+# ---------------------------------------------------------------------------
+# Sample sources
+# ---------------------------------------------------------------------------
+
+
+def _make_source(num_functions: int, body_lines: int = 30) -> str:
+    """Source with includes, a UCLASS declaration, and N functions."""
+    parts = [
+        "#include \"MyActor.h\"",
+        "#include \"Engine/World.h\"",
+        "",
+        "UCLASS(Blueprintable)",
+        "class AMyActor : public AActor;",
+        "",
+    ]
+    for i in range(num_functions):
+        parts.append(f"void AMyActor::Func{i}()")
+        parts.append("{")
+        for j in range(body_lines):
+            parts.append(f"    DoWork{i}({j});")
+        parts.append("}")
+        parts.append("")
+    return "\n".join(parts)
+
+
+# ---------------------------------------------------------------------------
+# Scanner
+# ---------------------------------------------------------------------------
+
+
+class TestScanLineEvents:
+    """Tests for _scan_line_events."""
+
+    def test_plain_braces(self):
+        events, in_comment = _scan_line_events("if (x) { y(); }", False)
+        assert events == ["{", "}"]
+        assert in_comment is False
+
+    def test_braces_in_string_ignored(self):
+        events, _ = _scan_line_events('Log(TEXT("{ not a brace }"));', False)
+        assert events == []
+
+    def test_braces_in_line_comment_ignored(self):
+        events, _ = _scan_line_events("x(); // { opens nothing", False)
+        assert events == []
+
+    def test_block_comment_state_carries(self):
+        events, in_comment = _scan_line_events("/* start {", False)
+        assert events == []
+        assert in_comment is True
+        events, in_comment = _scan_line_events("} still */ {", True)
+        assert events == ["{"]
+        assert in_comment is False
+
+    def test_escaped_quote_in_string(self):
+        events, _ = _scan_line_events('s = "a\\"{"; f();', False)
+        assert events == []
+
+
+class TestBuildBlockTree:
+    """Tests for _build_block_tree."""
+
+    def test_sibling_functions(self):
+        lines = [
+            "void A()",
+            "{",
+            "    x();",
+            "}",
+            "void B()",
+            "{",
+            "    y();",
+            "}",
+        ]
+        roots = _build_block_tree(lines)
+        assert len(roots) == 2
+        assert roots[0].header_start == 0
+        assert roots[0].close_line == 3
+        assert roots[1].header_start == 4
+        assert roots[1].close_line == 7
+
+    def test_nested_blocks(self):
+        lines = [
+            "class AFoo",
+            "{",
+            "    void Bar()",
+            "    {",
+            "        z();",
+            "    }",
+            "};",
+        ]
+        roots = _build_block_tree(lines)
+        assert len(roots) == 1
+        assert len(roots[0].children) == 1
+        inner = roots[0].children[0]
+        assert inner.header_start == 2
+        assert inner.close_line == 5
+
+    def test_unclosed_block_extends_to_eof(self):
+        lines = ["void A()", "{", "    x();"]
+        roots = _build_block_tree(lines)
+        assert roots[0].close_line == 2
+
+    def test_header_attaches_macro_and_comment(self):
+        lines = [
+            "",
+            "// Spawns the thing",
+            "UFUNCTION(BlueprintCallable)",
+            "void Spawn()",
+            "{",
+            "}",
+        ]
+        roots = _build_block_tree(lines)
+        assert roots[0].header_start == 1
+
+
+# ---------------------------------------------------------------------------
+# extract_review_context
+# ---------------------------------------------------------------------------
+
+
+class TestExtractReviewContext:
+    """Tests for extract_review_context."""
+
+    def test_small_file_returned_unchanged(self):
+        source = _make_source(2)
+        assert len(source.split("\n")) <= MIN_EXTRACT_LINES
+        assert extract_review_context(source, [10]) == source
+
+    def test_no_changed_lines_returned_unchanged(self):
+        source = _make_source(20)
+        assert extract_review_context(source, []) == source
+
+    def test_keeps_enclosing_function_only(self):
+        source = _make_source(20)
+        lines = source.split("\n")
+        # A line inside Func3's body.
+        target = lines.index("    DoWork3(5);") + 1
+        result = extract_review_context(source, [target])
+        assert "DoWork3(5);" in result
+        assert "void AMyActor::Func3()" in result
+        assert "DoWork10(5);" not in result
+        assert len(result.split("\n")) < len(lines)
+
+    def test_keeps_includes_and_uclass_declaration(self):
+        source = _make_source(20)
+        lines = source.split("\n")
+        target = lines.index("    DoWork3(5);") + 1
+        result = extract_review_context(source, [target])
+        assert '#include "MyActor.h"' in result
+        assert "UCLASS(Blueprintable)" in result
+        assert "class AMyActor : public AActor;" in result
+
+    def test_elision_markers_mark_gaps(self):
+        source = _make_source(20)
+        lines = source.split("\n")
+        target = lines.index("    DoWork3(5);") + 1
+        result = extract_review_context(source, [target])
+        assert "생략" in result
+
+    def test_method_in_large_class_descends_to_method(self):
+        body = ["class AMyActor", "{"]
+        for i in range(20):
+            body.append(f"    void Func{i}()")
+            body.append("    {")
+            body.extend(f"        Step{i}({j});" for j in range(15))
+            body.append("    }")
+        body.append("};")
+        source = "\n".join(body)
+        lines = source.split("\n")
+        assert len(lines) > MAX_BLOCK_LINES
+        target = lines.index("        Step5(3);") + 1
+        result = extract_review_context(source, [target])
+        assert "Step5(3);" in result
+        assert "void Func5()" in result
+        # The enclosing class signature and closer are kept.
+        assert "class AMyActor" in result
+        assert "};" in result
+        # Untouched sibling methods are elided.
+        assert "Step12(3);" not in result
+
+    def test_oversized_innermost_block_uses_radius(self):
+        body = ["void Giant()", "{"]
+        body.extend(f"    Line{i}();" for i in range(MAX_BLOCK_LINES + 100))
+        body.append("}")
+        source = "\n".join(body)
+        target = source.split("\n").index("    Line150();") + 1
+        result = extract_review_context(source, [target])
+        assert "Line150();" in result
+        assert f"Line{150 - FALLBACK_RADIUS + 1}();" in result
+        assert "Line10();" not in result
+        # The function signature is kept as outer-scope context.
+        assert "void Giant()" in result
+
+    def test_multiple_changed_lines_keep_all_scopes(self):
+        source = _make_source(20)
+        lines = source.split("\n")
+        targets = [
+            lines.index("    DoWork2(1);") + 1,
+            lines.index("    DoWork15(8);") + 1,
+        ]
+        result = extract_review_context(source, targets)
+        assert "DoWork2(1);" in result
+        assert "DoWork15(8);" in result
+        assert "DoWork9(1);" not in result
+
+    def test_out_of_range_lines_ignored(self):
+        source = _make_source(20)
+        result = extract_review_context(source, [0, 99999])
+        assert result == source
+
+
+class TestReviewPrContextIntegration:
+    """review_pr reduces large sources before building the message."""
+
+    @patch("scripts.stage3_llm_reviewer.call_anthropic_api")
+    def test_large_source_is_reduced(self, mock_api, tmp_path):
+        from scripts.stage3_llm_reviewer import review_pr
+
+        mock_api.return_value = ("[]", 500, 200)
+        source_file = tmp_path / "Source" / "MyActor.cpp"
+        source_file.parent.mkdir(parents=True)
+        source_file.write_text(_make_source(30), encoding="utf-8")
+        line = _make_source(30).split("\n").index("    DoWork3(5);") + 1
+        diff = textwrap.dedent(f"""\
+            diff --git a/Source/MyActor.cpp b/Source/MyActor.cpp
+            --- a/Source/MyActor.cpp
+            +++ b/Source/MyActor.cpp
+            @@ -{line - 1},2 +{line - 1},3 @@
+                 DoWork3(4);
+            +    DoWork3(5);
+                 DoWork3(6);
+        """)
+        review_pr(diff, source_dir=str(tmp_path))
+        user_message = mock_api.call_args.args[1]
+        text = (
+            user_message
+            if isinstance(user_message, str)
+            else "".join(block["text"] for block in user_message)
+        )
+        assert "DoWork3(5);" in text
+        assert "생략" in text
+        assert "DoWork20(5);" not in text
@@ -8,6 +8,7 @@ Test cases from STEP3_STAGE1.md:
 
 from __future__ import annotations
 
+import json
 import sys
 from pathlib import Path
 
@@ -18,10 +19,15 @@ sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
 
 from scripts.stage1_format_diff import (
     MAX_SUGGESTION_LINES,
+    _common_affix_lengths,
     _compute_diff_regions,
+    _intern_lines,
     _split_into_chunks,
+    added_lines_to_ranges,
     generate_format_suggestions,
     find_clang_format,
+    process_file,
+    run_clang_format,
 )
 
 
@@ -134,6 +140,83 @@ class TestComputeDiffRegions:
         assert regions[0]["original"] == ["old\n"]
         assert regions[0]["formatted"] == ["new\n"]
 
+    def test_local_change_in_large_file(self):
+        """Prefix/suffix anchoring keeps line numbers exact on big files."""
+        original = [f"line {i}\n" for i in range(5000)]
+        formatted = list(original)
+        formatted[2500] = "reformatted\n"
+        regions = _compute_diff_regions(original, formatted)
+        assert len(regions) == 1
+        assert regions[0]["start_line"] == 2501
+        assert regions[0]["end_line"] == 2501
+        assert regions[0]["original"] == ["line 2500\n"]
+        assert regions[0]["formatted"] == ["reformatted\n"]
+
+    def test_change_at_last_line(self):
+        original = [f"line {i}\n" for i in range(100)]
+        formatted = original[:-1] + ["changed\n"]
+        regions = _compute_diff_regions(original, formatted)
+        assert len(regions) == 1
+        assert regions[0]["start_line"] == 100
+        assert regions[0]["end_line"] == 100
+
+    def test_change_at_first_line(self):
+        original = [f"line {i}\n" for i in range(100)]
+        formatted = ["changed\n"] + original[1:]
+        regions = _compute_diff_regions(original, formatted)
+        assert len(regions) == 1
+        assert regions[0]["start_line"] == 1
+        assert regions[0]["end_line"] == 1
+
+
+# ============================================================================
+# _common_affix_lengths / _intern_lines tests
+# ============================================================================
+
+
+class TestCommonAffixLengths:
+    def test_identical_lists_are_all_prefix(self):
+        lines = ["a\n", "b\n", "c\n"]
+        assert _common_affix_lengths(lines, lines) == (3, 0)
+
+    def test_disjoint_lists(self):
+        assert _common_affix_lengths(["a\n"], ["b\n"]) == (0, 0)
+
+    def test_middle_change(self):
+        original = ["a\n", "x\n", "c\n"]
+        formatted = ["a\n", "y\n", "c\n"]
+        assert _common_affix_lengths(original, formatted) == (1, 1)
+
+    def test_suffix_does_not_overlap_prefix(self):
+        """Repeated lines must not be double-counted by both scans."""
+        original = ["x\n", "x\n"]
+        formatted = ["x\n", "x\n", "x\n"]
+        prefix, suffix = _common_affix_lengths(original, formatted)
+        assert prefix + suffix <= len(original)
+
+    def test_empty_inputs(self):
+        assert _common_affix_lengths([], []) == (0, 0)
+        assert _common_affix_lengths([], ["a\n"]) == (0, 0)
+
+
+class TestInternLines:
+    def test_identical_lines_share_ids(self):
+        ids_a, ids_b = _intern_lines(["x\n", "y\n"], ["y\n", "x\n"])
+        assert ids_a == [0, 1]
+        assert ids_b == [1, 0]
+
+    def test_mapping_preserves_equality(self):
+        original = ["a\n", "b\n", "a\n"]
+        formatted = ["b\n", "a\n", "c\n"]
+        ids_a, ids_b = _intern_lines(original, formatted)
+        flat_lines = original + formatted
+        flat_ids = ids_a + ids_b
+        for i in range(len(flat_lines)):
+            for j in range(len(flat_lines)):
+                assert (flat_lines[i] == flat_lines[j]) == (
+                    flat_ids[i] == flat_ids[j]
+                )
+
 
 # ============================================================================
 # _split_into_chunks tests
@@ -527,3 +610,154 @@ class TestMainGracefulDegradation:
             mod.main()
         captured = capsys.readouterr()
         assert "[]" in captured.out
+
+
+# ============================================================================
+# Range-limited clang-format tests
+# ============================================================================
+
+
+class TestAddedLinesToRanges:
+    """Tests for collapsing added line sets into --lines ranges."""
+
+    def test_empty_set_returns_no_ranges(self):
+        assert added_lines_to_ranges(set()) == []
+
+    def test_single_line(self):
+        assert added_lines_to_ranges({42}) == [(42, 42)]
+
+    def test_contiguous_lines_merge_into_one_range(self):
+        assert added_lines_to_ranges({3, 4, 5, 6}) == [(3, 6)]
+
+    def test_small_gap_is_merged(self):
+        # Gap of 2 untouched lines (7, 8) is within RANGE_MERGE_GAP
+        assert added_lines_to_ranges({5, 6, 9}) == [(5, 9)]
+
+    def test_large_gap_splits_ranges(self):
+        assert added_lines_to_ranges({5, 6, 20, 21}) == [(5, 6), (20, 21)]
+
+    def test_ranges_are_sorted(self):
+        assert added_lines_to_ranges({100, 1, 2}) == [(1, 2), (100, 100)]
+
+
+class TestRunClangFormatLineRanges:
+    """Tests for passing --lines restrictions to clang-format."""
+
+    def _capture_cmd(self, monkeypatch):
+        captured = {}
+
+        class FakeResult:
+            returncode = 0
+            stdout = "formatted\n"
+            stderr = ""
+
+        def fake_run(cmd, **kwargs):
+            captured["cmd"] = cmd
+            return FakeResult()
+
+        import scripts.stage1_format_diff as mod
+
+        monkeypatch.setattr(mod.subprocess, "run", fake_run)
+        return captured
+
+    def test_line_ranges_become_lines_args(self, monkeypatch):
+        captured = self._capture_cmd(monkeypatch)
+        run_clang_format(
+            "test.cpp",
+            clang_format_bin="clang-format",
+            line_ranges=[(3, 7), (20, 20)],
+        )
+        assert "--lines=3:7" in captured["cmd"]
+        assert "--lines=20:20" in captured["cmd"]
+        # File path stays last, after the --lines arguments
+        assert captured["cmd"][-1] == "test.cpp"
+
+    def test_no_ranges_means_no_lines_args(self, monkeypatch):
+        captured = self._capture_cmd(monkeypatch)
+        run_clang_format("test.cpp", clang_format_bin="clang-format")
+        assert not any(
+            arg.startswith("--lines") for arg in captured["cmd"]
+        )
+
+
+class TestProcessFileRangeLimited:
+    """Tests for process_file driving clang-format with line ranges."""
+
+    def test_ranges_derived_from_added_lines(self, monkeypatch, tmp_path):
+        src = tmp_path / "test.cpp"
+        src.write_text("int a;\nint b;\nint c;\nint d;\n", encoding="utf-8")
+
+        captured = {}
+
+        def fake_run_clang_format(
+            file_path, config_path=None, clang_format_bin=None,
+            line_ranges=None,
+        ):
+            captured["line_ranges"] = line_ranges
+            return src.read_text(encoding="utf-8")
+
+        import scripts.stage1_format_diff as mod
+
+        monkeypatch.setattr(mod, "run_clang_format", fake_run_clang_format)
+        process_file(str(src), {2, 3}, clang_format_bin="clang-format")
+        assert captured["line_ranges"] == [(2, 3)]
+
+    def test_empty_added_lines_skips_clang_format(
+        self, monkeypatch, tmp_path
+    ):
+        src = tmp_path / "test.cpp"
+        src.write_text("int a;\n", encoding="utf-8")
+
+        def fail_run(*args, **kwargs):
+            raise AssertionError("clang-format should not run")
+
+        import scripts.stage1_format_diff as mod
+
+        monkeypatch.setattr(mod, "run_clang_format", fail_run)
+        assert process_file(str(src), set()) == []
+
+
+class TestMainParallel:
+    """Tests for the parallel per-file fan-out in main()."""
+
+    def test_output_order_matches_input_order(
+        self, monkeypatch, tmp_path, capsys
+    ):
+        files = []
+        for name in ("a.cpp", "b.cpp", "c.cpp"):
+            src = tmp_path / name
+            src.write_text("int  x ;\n", encoding="utf-8")
+            files.append(str(src))
+
+        import scripts.stage1_format_diff as mod
+
+        def fake_process_file(file_path, added, **kwargs):
+            return [
+                {
+                    "file": file_path,
+                    "line": 1,
+                    "end_line": 1,
+                    "rule_id": "clang_format",
+                    "severity": "info",
+                    "message": "test",
+                    "suggestion": None,
+                }
+            ]
+
+        monkeypatch.setattr(mod, "find_clang_format", lambda: "clang-format")
+        monkeypatch.setattr(mod, "process_file", fake_process_file)
+        monkeypatch.setattr(
+            "sys.argv",
+            [
+                "stage1_format_diff.py",
+                "--files", json.dumps(files),
+                "--jobs", "3",
+            ],
+        )
+        with pytest.raises(SystemExit) as exc_info:
+            mod.main()
+        assert exc_info.value.code == 0
+
+        captured = capsys.readouterr()
+        suggestions = json.loads(captured.out)
+        assert [s["file"] for s in suggestions] == files
@@ -25,12 +25,20 @@ import sys
 sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
 
 from scripts.gate_checker import (
+    _compile_skip_patterns,
     classify_pr,
+    compute_delta_files,
+    compute_stage3_shards,
     determine_allowed_stages,
+    estimate_file_weights,
     filter_files,
+    get_changed_files_from_git,
     load_config,
     parse_diff_files,
+    partition_files_by_weight,
+    read_last_reviewed_sha,
     run_gate_check,
+    write_last_reviewed_sha,
 )
 
 # ---------------------------------------------------------------------------
@@ -565,6 +573,8 @@ class TestRunGateCheck:
             "reviewable_count",
             "skipped_files",
             "skipped_count",
+            "stage3_shards",
+            "stage3_shard_count",
         }
         assert set(result.keys()) == required_keys
 
@@ -700,3 +710,427 @@ class TestCLI:
         data = json.loads(output_file.read_text())
         assert data["reviewable_count"] == 1
         assert "Source/Actor.cpp" in data["reviewable_files"]
+
+    def test_cli_writes_parsed_diff_artifact(self, tmp_path):
+        """--parsed-diff-output should produce a loadable artifact."""
+        output_file = tmp_path / "result.json"
+        artifact_file = tmp_path / "pr-diff.json"
+        script = Path(__file__).resolve().parent.parent / "scripts" / "gate_checker.py"
+        diff_file = FIXTURES_DIR / "sample_diff.patch"
+
+        import subprocess
+
+        result = subprocess.run(
+            [
+                sys.executable,
+                str(script),
+                "--diff", str(diff_file),
+                "--config", str(CONFIG_PATH),
+                "--output", str(output_file),
+                "--parsed-diff-output", str(artifact_file),
+            ],
+            capture_output=True,
+            text=True,
+        )
+
+        assert result.returncode == 0, f"CLI failed: {result.stderr}"
+        assert artifact_file.exists()
+
+        from scripts.utils.diff_parser import load_parsed_diff, parse_diff
+
+        loaded = load_parsed_diff(artifact_file)
+        direct = parse_diff(
+            diff_file.read_text(encoding="utf-8", errors="replace")
+        )
+        assert loaded.keys() == direct.keys()
+        for path, fd in direct.items():
+            assert loaded[path].added_lines == fd.added_lines
+
+
+# ---------------------------------------------------------------------------
+# Combined skip-pattern matcher tests
+# ---------------------------------------------------------------------------
+
+
+class TestCompileSkipPatterns:
+    SAMPLE_PATHS = [
+        "Source/MyActor.cpp",
+        "Source/MyActor.h",
+        "ThirdParty/lib/foo.cpp",
+        "Plugins/Fancy/ThirdParty/bar.h",
+        "Source/MyActor.generated.h",
+        "Intermediate/Build/gen.cpp",
+        "Content/Map.umap",
+        "Binaries/Win64/game.dll",
+        "Docs/readme.md",
+    ]
+
+    def test_combined_agrees_with_per_pattern(self):
+        """The merged alternation accepts exactly the paths some
+        individual pattern accepts."""
+        config = yaml.safe_load(CONFIG_PATH.read_text(encoding="utf-8"))
+        compiled, combined = _compile_skip_patterns(config["skip_patterns"])
+        assert combined is not None
+
+        for path in self.SAMPLE_PATHS:
+            individual = any(p.search(path) for _, p in compiled)
+            assert bool(combined.search(path)) == individual, path
+
+    def test_filter_files_reason_names_first_matching_pattern(self):
+        """The skip reason still names the first pattern in config order."""
+        config = yaml.safe_load(CONFIG_PATH.read_text(encoding="utf-8"))
+        patterns = config["skip_patterns"]
+        _, skipped = filter_files(["ThirdParty/lib/foo.cpp"], patterns)
+        assert len(skipped) == 1
+        assert "ThirdParty/" in skipped[0]["reason"]
+
+    def test_invalid_pattern_falls_back_gracefully(self, capsys):
+        """A broken pattern is warned about and the rest still apply."""
+        patterns = ["[invalid(", "ThirdParty/"]
+        reviewable, skipped = filter_files(
+            ["ThirdParty/foo.cpp", "Source/A.cpp"], patterns
+        )
+        assert reviewable == ["Source/A.cpp"]
+        assert len(skipped) == 1
+        captured = capsys.readouterr()
+        assert "Invalid skip pattern" in captured.err
+
+    def test_empty_patterns(self):
+        compiled, combined = _compile_skip_patterns([])
+        assert compiled == []
+        assert combined is None
+        reviewable, skipped = filter_files(["Source/A.cpp"], [])
+        assert reviewable == ["Source/A.cpp"]
+        assert skipped == []
+
+
+# ---------------------------------------------------------------------------
+# Git plumbing mode tests
+# ---------------------------------------------------------------------------
+
+
+class TestGetChangedFilesFromGit:
+
+    def _mock_run(self, monkeypatch, stdout, returncode=0, stderr=""):
+        calls = []
+
+        class FakeResult:
+            pass
+
+        def fake_run(cmd, **kwargs):
+            calls.append(cmd)
+            r = FakeResult()
+            r.returncode = returncode
+            r.stdout = stdout
+            r.stderr = stderr
+            return r
+
+        import scripts.gate_checker as mod
+
+        monkeypatch.setattr(mod.subprocess, "run", fake_run)
+        return calls
+
+    def test_parses_nul_separated_records(self, monkeypatch):
+        stdout = (
+            "M\0Source/A.cpp\0"
+            "A\0Source/B.h\0"
+            "D\0Source/Gone.cpp\0"
+            "T\0Source/TypeChange.inl\0"
+        )
+        calls = self._mock_run(monkeypatch, stdout)
+        files = get_changed_files_from_git("origin/main")
+        assert files == ["Source/A.cpp", "Source/B.h", "Source/TypeChange.inl"]
+        assert calls[0][:5] == [
+            "git", "diff", "--name-status", "-z", "--no-renames"
+        ]
+        assert calls[0][-1] == "origin/main...HEAD"
+
+    def test_deduplicates_paths(self, monkeypatch):
+        stdout = "M\0Source/A.cpp\0M\0Source/A.cpp\0"
+        self._mock_run(monkeypatch, stdout)
+        assert get_changed_files_from_git("origin/main") == ["Source/A.cpp"]
+
+    def test_git_failure_raises(self, monkeypatch):
+        self._mock_run(monkeypatch, "", returncode=128, stderr="bad ref")
+        with pytest.raises(RuntimeError, match="bad ref"):
+            get_changed_files_from_git("origin/missing")
+
+    def test_run_gate_check_accepts_precomputed_files(self):
+        """changed_files bypasses textual diff parsing entirely."""
+        config = yaml.safe_load(CONFIG_PATH.read_text(encoding="utf-8"))
+        files = [
+            "Source/A.cpp",
+            "Source/B.h",
+            "ThirdParty/skip.cpp",
+            "Docs/readme.md",
+        ]
+        result = run_gate_check("", config, [], changed_files=files)
+        assert result["total_changed_files"] == 4
+        assert result["reviewable_files"] == ["Source/A.cpp", "Source/B.h"]
+        assert result["skipped_count"] == 2
+
+
+# ---------------------------------------------------------------------------
+# Delta review tests
+# ---------------------------------------------------------------------------
+
+
+class TestDeltaMarker:
+
+    def test_marker_roundtrip(self, tmp_path):
+        marker = tmp_path / "marker.json"
+        write_last_reviewed_sha(str(marker), "abc123")
+        assert read_last_reviewed_sha(str(marker)) == "abc123"
+
+    def test_missing_marker_returns_none(self, tmp_path):
+        assert read_last_reviewed_sha(str(tmp_path / "nope.json")) is None
+
+    def test_corrupt_marker_warns_and_returns_none(self, tmp_path, capsys):
+        marker = tmp_path / "marker.json"
+        marker.write_text("{not json", encoding="utf-8")
+        assert read_last_reviewed_sha(str(marker)) is None
+        assert "Could not read" in capsys.readouterr().err
+
+    def test_non_mapping_marker_warns_and_returns_none(self, tmp_path, capsys):
+        marker = tmp_path / "marker.json"
+        marker.write_text(json.dumps(["abc123"]), encoding="utf-8")
+        assert read_last_reviewed_sha(str(marker)) is None
+        assert "Unrecognized" in capsys.readouterr().err
+
+    def test_empty_sha_returns_none(self, tmp_path):
+        marker = tmp_path / "marker.json"
+        marker.write_text(json.dumps({"last_reviewed_sha": ""}), encoding="utf-8")
+        assert read_last_reviewed_sha(str(marker)) is None
+
+
+class TestComputeDeltaFiles:
+
+    def _mock_run(self, monkeypatch, stdout, returncode=0, stderr=""):
+        calls = []
+
+        class FakeResult:
+            pass
+
+        def fake_run(cmd, **kwargs):
+            calls.append(cmd)
+            r = FakeResult()
+            r.returncode = returncode
+            r.stdout = stdout
+            r.stderr = stderr
+            return r
+
+        import scripts.gate_checker as mod
+
+        monkeypatch.setattr(mod.subprocess, "run", fake_run)
+        return calls
+
+    def test_returns_changed_files(self, monkeypatch):
+        calls = self._mock_run(monkeypatch, "M\0Source/A.cpp\0")
+        files = compute_delta_files("oldsha", "newsha")
+        assert files == ["Source/A.cpp"]
+        assert calls[0][-1] == "oldsha...newsha"
+
+    def test_git_failure_falls_back_to_none(self, monkeypatch, capsys):
+        """Force-pushed-away SHAs must not abort the review."""
+        self._mock_run(monkeypatch, "", returncode=128, stderr="bad object")
+        assert compute_delta_files("gone", "newsha") is None
+        assert "falling back to full review" in capsys.readouterr().err
+
+
+class TestDeltaReviewCLI:
+    """End-to-end delta review against a real throwaway git repo."""
+
+    def _init_repo(self, tmp_path):
+        """Create a repo with two commits; the second touches only A.cpp."""
+        import subprocess
+
+        def git(*args):
+            result = subprocess.run(
+                ["git", "-c", "user.name=t", "-c", "user.email=t@t"]
+                + list(args),
+                cwd=tmp_path, capture_output=True, text=True,
+            )
+            assert result.returncode == 0, result.stderr
+            return result.stdout.strip()
+
+        git("init", "-q")
+        (tmp_path / "Source").mkdir()
+        (tmp_path / "Source" / "A.cpp").write_text("int a;\n")
+        (tmp_path / "Source" / "B.cpp").write_text("int b;\n")
+        git("add", ".")
+        git("commit", "-q", "-m", "first")
+        sha1 = git("rev-parse", "HEAD")
+
+        (tmp_path / "Source" / "A.cpp").write_text("int a;\nint a2;\n")
+        git("add", ".")
+        git("commit", "-q", "-m", "second")
+        sha2 = git("rev-parse", "HEAD")
+        return sha1, sha2
+
+    def _run_gate(self, tmp_path, diff_file, head_sha, artifact=None):
+        import subprocess
+
+        script = (
+            Path(__file__).resolve().parent.parent / "scripts" / "gate_checker.py"
+        )
+        output_file = tmp_path / f"result-{head_sha[:8]}.json"
+        cmd = [
+            sys.executable,
+            str(script),
+            "--diff", str(diff_file),
+            "--config", str(CONFIG_PATH),
+            "--output", str(output_file),
+            "--delta-marker", str(tmp_path / "marker.json"),
+            "--head-sha", head_sha,
+        ]
+        if artifact:
+            cmd += ["--parsed-diff-output", str(artifact)]
+        result = subprocess.run(
+            cmd, cwd=tmp_path, capture_output=True, text=True
+        )
+        assert result.returncode == 0, f"CLI failed: {result.stderr}"
+        return json.loads(output_file.read_text())
+
+    def test_second_run_reviews_only_the_delta(self, tmp_path):
+        sha1, sha2 = self._init_repo(tmp_path)
+        diff_file = tmp_path / "pr.diff"
+        diff_file.write_text(_make_diff(["Source/A.cpp", "Source/B.cpp"]))
+
+        # First run: no marker yet → full review, marker advances to sha1
+        first = self._run_gate(tmp_path, diff_file, sha1)
+        assert first["is_delta_review"] is False
+        assert first["review_files"] == ["Source/A.cpp", "Source/B.cpp"]
+
+        # Second run: only A.cpp changed between sha1 and sha2
+        artifact = tmp_path / "pr-diff.json"
+        second = self._run_gate(tmp_path, diff_file, sha2, artifact=artifact)
+        assert second["is_delta_review"] is True
+        assert second["delta_base_sha"] == sha1
+        assert second["review_files"] == ["Source/A.cpp"]
+        # reviewable_files keeps the full filtered list for reference
+        assert second["reviewable_files"] == ["Source/A.cpp", "Source/B.cpp"]
+
+        # Parsed-diff artifact is narrowed to the delta set
+        from scripts.utils.diff_parser import load_parsed_diff
+
+        assert list(load_parsed_diff(artifact).keys()) == ["Source/A.cpp"]
+
+    def test_rerun_on_same_sha_is_full_review(self, tmp_path):
+        sha1, sha2 = self._init_repo(tmp_path)
+        diff_file = tmp_path / "pr.diff"
+        diff_file.write_text(_make_diff(["Source/A.cpp", "Source/B.cpp"]))
+
+        self._run_gate(tmp_path, diff_file, sha2)
+        rerun = self._run_gate(tmp_path, diff_file, sha2)
+        assert rerun["is_delta_review"] is False
+        assert rerun["review_files"] == ["Source/A.cpp", "Source/B.cpp"]
+
+
+# ---------------------------------------------------------------------------
+# Stage 3 sharding tests
+# ---------------------------------------------------------------------------
+
+
+class TestPartitionFilesByWeight:
+
+    def test_empty_and_single(self):
+        assert partition_files_by_weight([], {}, 4) == []
+        assert partition_files_by_weight(["Source/A.cpp"], {}, 4) == [
+            ["Source/A.cpp"]
+        ]
+
+    def test_single_shard_passthrough(self):
+        files = ["Source/A.cpp", "Source/B.cpp"]
+        assert partition_files_by_weight(files, {}, 1) == [files]
+
+    def test_shards_are_disjoint_and_complete(self):
+        files = [f"Source/F{i}.cpp" for i in range(10)]
+        weights = {f: i + 1 for i, f in enumerate(files)}
+        shards = partition_files_by_weight(files, weights, 3)
+        assert len(shards) == 3
+        flat = [f for shard in shards for f in shard]
+        assert sorted(flat) == sorted(files)
+        assert len(set(flat)) == len(files)
+
+    def test_balances_by_weight_not_count(self):
+        # One heavy file should sit alone; the light ones share a shard
+        files = ["Source/Heavy.cpp", "Source/L1.cpp", "Source/L2.cpp",
+                 "Source/L3.cpp"]
+        weights = {"Source/Heavy.cpp": 1000, "Source/L1.cpp": 10,
+                   "Source/L2.cpp": 10, "Source/L3.cpp": 10}
+        shards = partition_files_by_weight(files, weights, 2)
+        assert ["Source/Heavy.cpp"] in shards
+        assert ["Source/L1.cpp", "Source/L2.cpp", "Source/L3.cpp"] in shards
+
+    def test_preserves_input_order_within_shard(self):
+        files = [f"Source/F{i}.cpp" for i in range(8)]
+        shards = partition_files_by_weight(files, {}, 2)
+        order = {f: i for i, f in enumerate(files)}
+        for shard in shards:
+            assert shard == sorted(shard, key=lambda f: order[f])
+
+    def test_more_shards_than_files(self):
+        files = ["Source/A.cpp", "Source/B.cpp"]
+        shards = partition_files_by_weight(files, {}, 5)
+        assert len(shards) == 2
+        assert all(len(s) == 1 for s in shards)
+
+
+class TestEstimateFileWeights:
+
+    def test_bigger_diff_section_weighs_more(self):
+        big = "Source/Big.cpp"
+        small = "Source/Small.cpp"
+        diff = "\n".join(
+            [f"diff --git a/{big} b/{big}",
+             f"--- a/{big}", f"+++ b/{big}", "@@ -1,1 +1,50 @@"]
+            + [f"+void Function{i}() {{ DoWork{i}(); }}" for i in range(50)]
+            + [f"diff --git a/{small} b/{small}",
+               f"--- a/{small}", f"+++ b/{small}", "@@ -1,1 +1,2 @@",
+               "+int x;"]
+        )
+        weights = estimate_file_weights(diff, [big, small])
+        assert weights[big] > weights[small] >= 1
+
+    def test_file_missing_from_diff_defaults_to_one(self):
+        weights = estimate_file_weights("", ["Source/A.cpp"])
+        assert weights == {"Source/A.cpp": 1}
+
+
+class TestStage3Sharding:
+
+    def _large_diff(self, count):
+        return _make_diff([f"Source/File{i:03d}.cpp" for i in range(count)])
+
+    def test_default_config_keeps_hard_cutoff(self):
+        config = _load_test_config()
+        result = run_gate_check(self._large_diff(60), config, [])
+        assert result["is_large_pr"] is True
+        assert result["allowed_stages"] == [1, 2]
+        # A single shard is still emitted for uniform consumers
+        assert result["stage3_shard_count"] == 1
+
+    def test_sharded_large_pr_keeps_stage3(self):
+        config = _load_test_config()
+        config["stage3_shard_count"] = 4
+        result = run_gate_check(self._large_diff(60), config, [])
+        assert result["is_large_pr"] is True
+        assert result["allowed_stages"] == [1, 2, 3]
+        assert result["stage3_shard_count"] == 4
+        flat = [f for shard in result["stage3_shards"] for f in shard]
+        assert sorted(flat) == sorted(result["reviewable_files"])
+
+    def test_normal_pr_is_single_shard_even_when_configured(self):
+        config = _load_test_config()
+        config["stage3_shard_count"] = 4
+        result = run_gate_check(self._large_diff(5), config, [])
+        assert result["is_large_pr"] is False
+        assert result["allowed_stages"] == [1, 2, 3]
+        assert result["stage3_shards"] == [result["reviewable_files"]]
+
+    def test_determine_allowed_stages_sharded(self):
+        assert determine_allowed_stages(True)[0] == [1, 2]
+        assert determine_allowed_stages(True, stage3_sharded=True)[0] == [
+            1, 2, 3
+        ]
+        assert determine_allowed_stages(False)[0] == [1, 2, 3]
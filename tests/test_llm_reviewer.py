@@ -23,16 +23,24 @@ import pytest
 sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
 
 from scripts.stage3_llm_reviewer import (
+    attribute_batch_findings,
+    build_batch_user_message,
     build_system_prompt,
     build_user_message,
+    exclusion_keys,
     filter_excluded,
     load_exclude_findings,
     parse_llm_response,
+    plan_review_batches,
+    review_batch,
     review_file,
     review_pr,
     validate_finding,
+    _match_batch_file,
     _reconstruct_file_diff,
+    DEFAULT_COMPLEXITY_THRESHOLD,
     DEFAULT_MODEL,
+    ModelRouter,
 )
 from scripts.utils.token_budget import (
     BUDGET_PER_FILE,
@@ -139,17 +147,53 @@ class TestEstimateTokens:
 
     def test_short_string(self):
         result = estimate_tokens("hello")
-        assert result == 1  # 5 // 3 = 1
+        assert result == 1  # one identifier piece
 
     def test_code_string(self):
         code = "void AMyActor::BeginPlay() { Super::BeginPlay(); }"
         result = estimate_tokens(code)
         assert result > 0
-        assert result == len(code) // 3
+        # Segmentation counts identifier/punctuation pieces — in the
+        # same ballpark as the old len // 3 ratio for dense code.
+        assert len(code) // 6 <= result <= len(code) // 2
+
+    def test_indentation_not_overcounted(self):
+        """A long indentation run is one token, not len // 3 tokens."""
+        indented = " " * 32 + "x = 1;"
+        plain = "x = 1;"
+        assert estimate_tokens(indented) == estimate_tokens(plain) + 1
 
     def test_large_string(self):
+        """One long identifier run tokenizes at ~6 chars per piece."""
         text = "a" * 30000
-        assert estimate_tokens(text) == 10000
+        assert estimate_tokens(text) == 5000
+
+    def test_memoized_by_content_hash(self):
+        """Long texts are counted once and replayed from the memo cache."""
+        import scripts.utils.token_budget as tb
+
+        text = ("int value = 42;\n" * 200) + "// unique-memo-test\n"
+        assert len(text) >= tb._MEMO_MIN_CHARS
+
+        calls = []
+        real_count = tb._count_tokens
+
+        def counting(t):
+            calls.append(1)
+            return real_count(t)
+
+        tb._memo_cache.clear()
+        original = tb._count_tokens
+        tb._count_tokens = counting
+        try:
+            first = tb.estimate_tokens(text)
+            second = tb.estimate_tokens(text)
+        finally:
+            tb._count_tokens = original
+            tb._memo_cache.clear()
+
+        assert first == second
+        assert len(calls) == 1
 
 
 class TestEstimateCost:
@@ -681,11 +725,15 @@ class TestReviewFile:
             full_source="void Foo() {}",
         )
 
-        # Verify user message included full source
+        # Verify user content included full source — with prompt
+        # caching, full-source messages are sent as content blocks.
         call_args = mock_api.call_args
         user_msg = call_args[0][1]  # second positional arg
-        assert "전체 소스" in user_msg
-        assert "void Foo() {}" in user_msg
+        assert isinstance(user_msg, list)
+        assert user_msg[0]["cache_control"] == {"type": "ephemeral"}
+        flat = "".join(block["text"] for block in user_msg)
+        assert "전체 소스" in flat
+        assert "void Foo() {}" in flat
 
 
 # ---------------------------------------------------------------------------
@@ -823,6 +871,40 @@ class TestReviewPr:
         # One file errored but pipeline continues
         assert summary["files_reviewed"] == 1  # Only the second succeeded
 
+    @patch("scripts.stage3_llm_reviewer.call_anthropic_api")
+    def test_include_files_restricts_to_shard(self, mock_api):
+        mock_api.return_value = ("[]", 300, 50)
+
+        findings, summary = review_pr(
+            SAMPLE_DIFF_MULTI,
+            include_files=["Source/MyWidget.h"],
+        )
+
+        # MyActor.cpp is in the diff but outside this shard
+        assert summary["files_reviewed"] == 1
+        assert mock_api.call_count == 1
+
+    @patch("scripts.stage3_llm_reviewer.call_anthropic_api")
+    def test_empty_include_list_reviews_nothing(self, mock_api):
+        findings, summary = review_pr(SAMPLE_DIFF_MULTI, include_files=[])
+
+        mock_api.assert_not_called()
+        assert findings == []
+
+    @patch("scripts.stage3_llm_reviewer.call_anthropic_api")
+    def test_budget_override_skips_when_exhausted(self, mock_api):
+        mock_api.return_value = ("[]", 300, 50)
+
+        findings, summary = review_pr(
+            SAMPLE_DIFF_MULTI,
+            max_budget_tokens=1,
+        )
+
+        # Shard budget of 1 token cannot fit any file
+        assert summary["files_reviewed"] == 0
+        assert summary["files_skipped_budget"] > 0
+        mock_api.assert_not_called()
+
     @patch("scripts.stage3_llm_reviewer.call_anthropic_api")
     def test_source_dir_provides_context(self, mock_api, tmp_path):
         mock_api.return_value = ("[]", 1000, 50)
@@ -839,7 +921,12 @@ class TestReviewPr:
 
         call_args = mock_api.call_args
         user_msg = call_args[0][1]
-        assert "전체 소스" in user_msg
+        flat = (
+            "".join(block["text"] for block in user_msg)
+            if isinstance(user_msg, list)
+            else user_msg
+        )
+        assert "전체 소스" in flat
 
 
 # ---------------------------------------------------------------------------
@@ -2175,3 +2262,1258 @@ class TestDiffMetaLineExclusion:
         assert not _is_diff_meta_line("-removed")
         assert not _is_diff_meta_line(" context")
         assert not _is_diff_meta_line("")
+
+
+# ---------------------------------------------------------------------------
+# Tests: concurrent review_pr
+# ---------------------------------------------------------------------------
+
+
+class TestConcurrentReview:
+    """Tests for the worker-pool execution path of review_pr."""
+
+    @patch("scripts.stage3_llm_reviewer.call_anthropic_api")
+    def test_findings_order_is_deterministic(self, mock_api):
+        """Findings are concatenated in sorted file order regardless of
+        which worker finishes first."""
+
+        def respond(system_prompt, user_msg, **kwargs):
+            # Return a finding attributed to whichever file is in the message.
+            if "MyActor.cpp" in user_msg:
+                path, line = "Source/MyActor.cpp", 12
+            else:
+                path, line = "Source/MyWidget.h", 6
+            return (
+                json.dumps([
+                    {"file": path, "line": line, "severity": "warning",
+                     "category": "convention", "message": "issue"},
+                ]),
+                300,
+                50,
+            )
+
+        mock_api.side_effect = respond
+
+        findings, summary = review_pr(SAMPLE_DIFF_MULTI, concurrency=4)
+
+        assert summary["files_reviewed"] == 2
+        assert [f["file"] for f in findings] == [
+            "Source/MyActor.cpp",
+            "Source/MyWidget.h",
+        ]
+
+    @patch("scripts.stage3_llm_reviewer.call_anthropic_api")
+    def test_budget_counters_consistent_under_concurrency(self, mock_api):
+        mock_api.return_value = ("[]", 300, 50)
+
+        findings, summary = review_pr(SAMPLE_DIFF_MULTI, concurrency=8)
+
+        assert summary["files_reviewed"] == 2
+        assert summary["total_input_tokens"] == 600
+        assert summary["total_output_tokens"] == 100
+
+    @patch("scripts.stage3_llm_reviewer.call_anthropic_api")
+    def test_concurrency_one_stays_sequential(self, mock_api):
+        mock_api.return_value = ("[]", 300, 50)
+
+        findings, summary = review_pr(SAMPLE_DIFF_MULTI, concurrency=1)
+
+        assert summary["files_reviewed"] == 2
+        assert mock_api.call_count == 2
+
+    @patch("scripts.stage3_llm_reviewer.call_anthropic_api")
+    def test_api_error_in_one_worker_continues(self, mock_api):
+        def respond(system_prompt, user_msg, **kwargs):
+            if "MyActor.cpp" in user_msg:
+                raise RuntimeError("API error 500")
+            return ("[]", 300, 50)
+
+        mock_api.side_effect = respond
+
+        findings, summary = review_pr(SAMPLE_DIFF_MULTI, concurrency=4)
+
+        assert summary["files_reviewed"] == 1
+
+    def test_rate_limit_gate_holds_and_releases(self):
+        from scripts.stage3_llm_reviewer import _RateLimitGate
+
+        gate = _RateLimitGate()
+        gate.wait()  # no hold — returns immediately
+
+        gate.hold(0.05)
+        import time as _time
+
+        start = _time.monotonic()
+        gate.wait()
+        assert _time.monotonic() - start >= 0.04
+
+
+# ---------------------------------------------------------------------------
+# Tests: persistent review cache
+# ---------------------------------------------------------------------------
+
+
+class TestReviewCache:
+    """Tests for the content-hash review cache (scripts.utils.review_cache)."""
+
+    def test_make_cache_key_sensitivity(self):
+        from scripts.utils.review_cache import make_cache_key
+
+        base = make_cache_key("a.cpp", "diff", "prompt", "model-x")
+        assert base == make_cache_key("a.cpp", "diff", "prompt", "model-x")
+        assert base != make_cache_key("b.cpp", "diff", "prompt", "model-x")
+        assert base != make_cache_key("a.cpp", "diff2", "prompt", "model-x")
+        assert base != make_cache_key("a.cpp", "diff", "prompt2", "model-x")
+        assert base != make_cache_key("a.cpp", "diff", "prompt", "model-y")
+        assert base != make_cache_key("a.cpp", "diff", "prompt", "model-x", "src")
+
+    def test_put_get_roundtrip(self, tmp_path):
+        from scripts.utils.review_cache import ReviewCache
+
+        cache = ReviewCache(str(tmp_path / "cache"))
+        findings = [{"file": "a.cpp", "line": 3, "message": "issue"}]
+        cache.put("k1", "a.cpp", findings)
+
+        assert cache.get("k1") == findings
+        assert cache.get("missing") is None
+        assert cache.summary() == {"cache_hits": 1, "cache_misses": 1}
+
+    def test_corrupt_entry_is_a_miss(self, tmp_path):
+        from scripts.utils.review_cache import ReviewCache
+
+        cache_dir = tmp_path / "cache"
+        cache_dir.mkdir()
+        (cache_dir / "bad.json").write_text("not json", encoding="utf-8")
+
+        cache = ReviewCache(str(cache_dir))
+        assert cache.get("bad") is None
+
+    @patch("scripts.stage3_llm_reviewer.call_anthropic_api")
+    def test_second_run_skips_api(self, mock_api, tmp_path):
+        mock_api.return_value = (SAMPLE_LLM_RESPONSE, 500, 200)
+        cache_dir = str(tmp_path / "cache")
+
+        findings1, summary1 = review_pr(SAMPLE_DIFF, cache_dir=cache_dir)
+        assert summary1["cache_misses"] == 1
+        first_calls = mock_api.call_count
+
+        findings2, summary2 = review_pr(SAMPLE_DIFF, cache_dir=cache_dir)
+        assert mock_api.call_count == first_calls  # no new API calls
+        assert summary2["cache_hits"] == 1
+        assert summary2["files_reviewed"] == 1
+        assert findings2 == findings1
+
+    @patch("scripts.stage3_llm_reviewer.call_anthropic_api")
+    def test_api_error_not_cached(self, mock_api, tmp_path):
+        cache_dir = str(tmp_path / "cache")
+
+        mock_api.side_effect = RuntimeError("API error 500")
+        findings1, summary1 = review_pr(SAMPLE_DIFF, cache_dir=cache_dir)
+        assert findings1 == []
+
+        # Next run must retry the API, not replay the failed attempt.
+        mock_api.side_effect = None
+        mock_api.return_value = (SAMPLE_LLM_RESPONSE, 500, 200)
+        findings2, summary2 = review_pr(SAMPLE_DIFF, cache_dir=cache_dir)
+        assert len(findings2) == 2
+
+    @patch("scripts.stage3_llm_reviewer.call_anthropic_api")
+    def test_exclusions_applied_on_replay(self, mock_api, tmp_path):
+        """Cached findings must respect the current run's exclusion set."""
+        mock_api.return_value = (SAMPLE_LLM_RESPONSE, 500, 200)
+        cache_dir = str(tmp_path / "cache")
+
+        findings1, _ = review_pr(SAMPLE_DIFF, cache_dir=cache_dir)
+        assert len(findings1) == 2
+
+        exclude_file = tmp_path / "stage1.json"
+        exclude_file.write_text(json.dumps([
+            {"file": "Source/MyActor.cpp", "line": 12, "rule_id": "x"},
+        ]))
+
+        findings2, summary2 = review_pr(
+            SAMPLE_DIFF,
+            cache_dir=cache_dir,
+            exclude_files=[str(exclude_file)],
+        )
+        assert summary2["cache_hits"] == 1
+        assert len(findings2) == 1
+        assert findings2[0]["line"] == 13
+
+
+# ---------------------------------------------------------------------------
+# Tests: batched multi-file review
+# ---------------------------------------------------------------------------
+
+
+SAMPLE_BATCH_RESPONSE = json.dumps([
+    {"file": "Source/A.cpp", "line": 12, "severity": "warning",
+     "category": "convention", "message": "auto 사용 금지"},
+    {"file": "b/Source/B.cpp", "line": 7, "severity": "warning",
+     "category": "gc_safety", "message": "UPROPERTY 누락"},
+], ensure_ascii=False)
+
+
+def _small_diff(path: str) -> str:
+    return textwrap.dedent(f"""\
+        diff --git a/{path} b/{path}
+        --- a/{path}
+        +++ b/{path}
+        @@ -1,2 +1,3 @@
+         void Foo() {{}}
+        +void Bar() {{}}
+    """)
+
+
+class TestPlanReviewBatches:
+    """Tests for plan_review_batches."""
+
+    def test_small_files_packed_into_one_unit(self):
+        items = [
+            ("Source/A.cpp", _small_diff("Source/A.cpp"), None),
+            ("Source/B.cpp", _small_diff("Source/B.cpp"), None),
+            ("Source/C.cpp", _small_diff("Source/C.cpp"), None),
+        ]
+        units = plan_review_batches(items, "prompt")
+        assert len(units) == 1
+        assert [fp for fp, _, _ in units[0]] == [
+            "Source/A.cpp", "Source/B.cpp", "Source/C.cpp",
+        ]
+
+    def test_large_file_gets_singleton_unit(self):
+        from scripts.utils.token_budget import BATCH_FILE_MAX_TOKENS
+
+        big_diff = "+x\n" * (BATCH_FILE_MAX_TOKENS * 3)  # well over threshold
+        items = [
+            ("Source/A.cpp", _small_diff("Source/A.cpp"), None),
+            ("Source/Big.cpp", big_diff, None),
+            ("Source/C.cpp", _small_diff("Source/C.cpp"), None),
+        ]
+        units = plan_review_batches(items, "prompt")
+        assert [len(u) for u in units] == [1, 2]
+        assert units[0][0][0] == "Source/Big.cpp"
+
+    def test_batch_splits_at_per_file_budget(self):
+        # Each item ~3000 tokens (18000-char identifier run at ~6 chars
+        # per token); BUDGET_PER_FILE is 20000, so at most 6 such items
+        # fit per batch.
+        diff = "+" + "x" * 18000
+        items = [(f"Source/F{i}.cpp", diff, None) for i in range(8)]
+        units = plan_review_batches(items, "prompt")
+        assert len(units) >= 2
+        assert sum(len(u) for u in units) == 8
+
+    def test_empty_items(self):
+        assert plan_review_batches([], "prompt") == []
+
+
+class TestBatchAttribution:
+    """Tests for _match_batch_file / attribute_batch_findings."""
+
+    def test_exact_match(self):
+        assert _match_batch_file("Source/A.cpp", ["Source/A.cpp"]) == "Source/A.cpp"
+
+    def test_diff_prefix_stripped(self):
+        files = ["Source/A.cpp", "Source/B.cpp"]
+        assert _match_batch_file("b/Source/A.cpp", files) == "Source/A.cpp"
+        assert _match_batch_file("a/Source/B.cpp", files) == "Source/B.cpp"
+        assert _match_batch_file("./Source/A.cpp", files) == "Source/A.cpp"
+
+    def test_basename_match_when_unambiguous(self):
+        files = ["Source/A.cpp", "Source/B.cpp"]
+        assert _match_batch_file("A.cpp", files) == "Source/A.cpp"
+
+    def test_ambiguous_basename_rejected(self):
+        files = ["Source/X/A.cpp", "Source/Y/A.cpp"]
+        assert _match_batch_file("A.cpp", files) is None
+
+    def test_unknown_file_rejected(self):
+        assert _match_batch_file("Source/Other.cpp", ["Source/A.cpp"]) is None
+        assert _match_batch_file(None, ["Source/A.cpp"]) is None
+        assert _match_batch_file("", ["Source/A.cpp"]) is None
+
+    def test_attribution_normalizes_and_drops_unknown(self):
+        raw = [
+            {"file": "b/Source/A.cpp", "line": 3, "severity": "warning",
+             "category": "convention", "message": "m1"},
+            {"file": "Source/Unknown.cpp", "line": 9, "severity": "warning",
+             "category": "convention", "message": "dropped"},
+            "not-a-dict",
+        ]
+        per_file = attribute_batch_findings(raw, ["Source/A.cpp", "Source/B.cpp"])
+
+        assert set(per_file.keys()) == {"Source/A.cpp", "Source/B.cpp"}
+        assert len(per_file["Source/A.cpp"]) == 1
+        assert per_file["Source/A.cpp"][0]["file"] == "Source/A.cpp"
+        assert per_file["Source/A.cpp"][0]["stage"] == "stage3"
+        assert per_file["Source/B.cpp"] == []
+
+
+class TestBuildBatchUserMessage:
+    """Tests for build_batch_user_message."""
+
+    def test_all_files_listed(self):
+        msg = build_batch_user_message([
+            ("Source/A.cpp", "+a", None),
+            ("Source/B.cpp", "+b", "void B();"),
+        ])
+        assert "## 파일: `Source/A.cpp`" in msg
+        assert "## 파일: `Source/B.cpp`" in msg
+        assert "전체 소스" in msg
+        assert "void B();" in msg
+        assert '"file"' in msg  # attribution instruction
+
+    def test_file_count_in_instruction(self):
+        msg = build_batch_user_message([
+            ("Source/A.cpp", "+a", None),
+            ("Source/B.cpp", "+b", None),
+            ("Source/C.cpp", "+c", None),
+        ])
+        assert "3개 파일" in msg
+
+
+class TestBatchedReview:
+    """Tests for review_batch and review_pr(batch_small_files=True)."""
+
+    BATCH_DIFF = (
+        _small_diff("Source/A.cpp")
+        + _small_diff("Source/B.cpp")
+        + _small_diff("Source/C.cpp")
+    )
+
+    @patch("scripts.stage3_llm_reviewer.call_anthropic_api")
+    def test_single_api_call_for_small_files(self, mock_api):
+        mock_api.return_value = (SAMPLE_BATCH_RESPONSE, 500, 200)
+
+        findings, summary = review_pr(
+            self.BATCH_DIFF, batch_small_files=True, concurrency=1
+        )
+
+        assert mock_api.call_count == 1
+        assert summary["files_reviewed"] == 3
+        assert {f["file"] for f in findings} == {"Source/A.cpp", "Source/B.cpp"}
+
+    @patch("scripts.stage3_llm_reviewer.call_anthropic_api")
+    def test_batching_off_by_default(self, mock_api):
+        mock_api.return_value = ("[]", 300, 50)
+
+        review_pr(self.BATCH_DIFF, concurrency=1)
+
+        assert mock_api.call_count == 3
+
+    @patch("scripts.stage3_llm_reviewer.call_anthropic_api")
+    def test_budget_exhausted_skips_whole_batch(self, mock_api):
+        items = [
+            ("Source/A.cpp", _small_diff("Source/A.cpp"), None),
+            ("Source/B.cpp", _small_diff("Source/B.cpp"), None),
+        ]
+        budget = BudgetTracker(max_tokens=1)
+
+        findings = review_batch(items, "prompt", set(), budget)
+
+        mock_api.assert_not_called()
+        assert findings == []
+        assert budget.files_skipped_budget == 2
+
+    @patch("scripts.stage3_llm_reviewer.call_anthropic_api")
+    def test_api_error_returns_empty(self, mock_api):
+        mock_api.side_effect = RuntimeError("boom")
+        items = [
+            ("Source/A.cpp", _small_diff("Source/A.cpp"), None),
+            ("Source/B.cpp", _small_diff("Source/B.cpp"), None),
+        ]
+        budget = BudgetTracker()
+
+        findings = review_batch(items, "prompt", set(), budget)
+
+        assert findings == []
+        assert budget.files_reviewed == 0
+
+    @patch("scripts.stage3_llm_reviewer.call_anthropic_api")
+    def test_exclusions_applied_to_batch(self, mock_api):
+        mock_api.return_value = (SAMPLE_BATCH_RESPONSE, 500, 200)
+        items = [
+            ("Source/A.cpp", _small_diff("Source/A.cpp"), None),
+            ("Source/B.cpp", _small_diff("Source/B.cpp"), None),
+        ]
+        budget = BudgetTracker()
+        excluded = {("Source/A.cpp", 12)}
+
+        findings = review_batch(items, "prompt", excluded, budget)
+
+        assert len(findings) == 1
+        assert findings[0]["file"] == "Source/B.cpp"
+
+    @patch("scripts.stage3_llm_reviewer.call_anthropic_api")
+    def test_batch_members_cached_individually(self, mock_api, tmp_path):
+        mock_api.return_value = (SAMPLE_BATCH_RESPONSE, 500, 200)
+        cache_dir = str(tmp_path / "cache")
+
+        findings1, summary1 = review_pr(
+            self.BATCH_DIFF,
+            batch_small_files=True,
+            concurrency=1,
+            cache_dir=cache_dir,
+        )
+        assert mock_api.call_count == 1
+
+        findings2, summary2 = review_pr(
+            self.BATCH_DIFF,
+            batch_small_files=True,
+            concurrency=1,
+            cache_dir=cache_dir,
+        )
+        # All three members (including the clean Source/C.cpp) replay
+        # from their own cache entries — no second API call.
+        assert mock_api.call_count == 1
+        assert summary2["cache_hits"] == 3
+        assert findings2 == findings1
+
+    @patch("scripts.stage3_llm_reviewer.call_anthropic_api")
+    def test_lone_cache_miss_uses_per_file_path(self, mock_api, tmp_path):
+        """A batch with one remaining miss falls back to review_file."""
+        mock_api.return_value = ("[]", 300, 50)
+        cache_dir = str(tmp_path / "cache")
+        two_file_diff = _small_diff("Source/A.cpp") + _small_diff("Source/B.cpp")
+
+        review_pr(
+            two_file_diff, batch_small_files=True,
+            concurrency=1, cache_dir=cache_dir,
+        )
+        assert mock_api.call_count == 1
+
+        three_file_diff = two_file_diff + _small_diff("Source/C.cpp")
+        findings, summary = review_pr(
+            three_file_diff, batch_small_files=True,
+            concurrency=1, cache_dir=cache_dir,
+        )
+        # A and B replay from cache; only C triggers an API call.
+        assert mock_api.call_count == 2
+        assert summary["cache_hits"] == 2
+        assert summary["files_reviewed"] == 3
+
+
+# ---------------------------------------------------------------------------
+# Tests: streaming API responses and incremental parsing
+# ---------------------------------------------------------------------------
+
+
+from scripts.stage3_llm_reviewer import StreamingFindingsParser
+
+
+class _FakeSSEResponse:
+    """Minimal SSE response double: context manager + byte-line iterator."""
+
+    def __init__(self, lines):
+        self._lines = [line.encode("utf-8") for line in lines]
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        return False
+
+    def __iter__(self):
+        return iter(self._lines)
+
+
+def _sse_lines(text_pieces, input_tokens=500, output_tokens=200):
+    lines = [
+        "event: message_start",
+        "data: " + json.dumps({
+            "type": "message_start",
+            "message": {"usage": {"input_tokens": input_tokens}},
+        }),
+    ]
+    for piece in text_pieces:
+        lines.append("event: content_block_delta")
+        lines.append("data: " + json.dumps({
+            "type": "content_block_delta",
+            "index": 0,
+            "delta": {"type": "text_delta", "text": piece},
+        }))
+    lines.append("event: message_delta")
+    lines.append("data: " + json.dumps({
+        "type": "message_delta",
+        "delta": {},
+        "usage": {"output_tokens": output_tokens},
+    }))
+    lines.append("event: message_stop")
+    lines.append('data: {"type": "message_stop"}')
+    return lines
+
+
+class TestStreamingApi:
+    """Tests for call_anthropic_api(stream=True)."""
+
+    def test_stream_assembles_text_and_usage(self):
+        from scripts.stage3_llm_reviewer import call_anthropic_api
+
+        pieces = ["[{\"line\": 1, ", "\"message\": \"m\"}]"]
+        resp = _FakeSSEResponse(_sse_lines(pieces, 123, 45))
+
+        with patch("urllib.request.urlopen", return_value=resp):
+            text, inp, out = call_anthropic_api(
+                "system", "user", api_key="test-key", stream=True
+            )
+
+        assert text == '[{"line": 1, "message": "m"}]'
+        assert inp == 123
+        assert out == 45
+
+    def test_stream_feeds_parser_incrementally(self):
+        from scripts.stage3_llm_reviewer import call_anthropic_api
+
+        pieces = ['[{"line": 1, "message": "a"},', ' {"line": 2, "message": "b"}]']
+        resp = _FakeSSEResponse(_sse_lines(pieces))
+        parser = StreamingFindingsParser()
+
+        with patch("urllib.request.urlopen", return_value=resp):
+            call_anthropic_api(
+                "system", "user", api_key="test-key",
+                stream=True, stream_parser=parser,
+            )
+
+        assert [f["line"] for f in parser.emitted] == [1, 2]
+        assert parser.finish() == []
+
+    def test_stream_error_event_raises(self):
+        from scripts.stage3_llm_reviewer import call_anthropic_api
+
+        lines = [
+            "event: error",
+            'data: {"type": "error", "error": {"type": "overloaded_error"}}',
+        ]
+        resp = _FakeSSEResponse(lines)
+
+        with patch("urllib.request.urlopen", return_value=resp):
+            with pytest.raises(RuntimeError, match="stream error"):
+                call_anthropic_api(
+                    "system", "user", api_key="test-key", stream=True
+                )
+
+    def test_stream_payload_sets_stream_flag(self):
+        from scripts.stage3_llm_reviewer import call_anthropic_api
+
+        captured = {}
+
+        def fake_urlopen(req, timeout=None):
+            captured["payload"] = json.loads(req.data.decode("utf-8"))
+            return _FakeSSEResponse(_sse_lines(["[]"]))
+
+        with patch("urllib.request.urlopen", side_effect=fake_urlopen):
+            call_anthropic_api("system", "user", api_key="test-key", stream=True)
+
+        assert captured["payload"]["stream"] is True
+
+
+class TestStreamingFindingsParser:
+    """Tests for the incremental findings parser."""
+
+    def test_findings_emitted_as_objects_complete(self):
+        parser = StreamingFindingsParser()
+
+        assert parser.feed('[{"line": 1, "mess') == []
+        first = parser.feed('age": "a"}, {"line"')
+        assert len(first) == 1
+        assert first[0]["line"] == 1
+        second = parser.feed(': 2, "message": "b"}]')
+        assert len(second) == 1
+        assert second[0]["line"] == 2
+        assert parser.finish() == []
+
+    def test_prose_and_fences_ignored(self):
+        parser = StreamingFindingsParser()
+        parser.feed("리뷰 결과입니다:\n```json\n[\n")
+        emitted = parser.feed('{"line": 3, "message": "m"}\n]\n```')
+        assert len(emitted) == 1
+        assert parser.finish() == []
+
+    def test_empty_array_response(self):
+        parser = StreamingFindingsParser()
+        assert parser.feed("[]") == []
+        assert parser.finish() == []
+
+    def test_finish_agrees_with_full_parse(self):
+        # Drip-feed a full sample response char by char; emitted +
+        # finish() must equal the non-streaming parse.
+        parser = StreamingFindingsParser()
+        collected = []
+        for ch in SAMPLE_LLM_RESPONSE:
+            collected.extend(parser.feed(ch))
+        collected.extend(parser.finish())
+
+        assert collected == parse_llm_response(SAMPLE_LLM_RESPONSE)
+
+    def test_non_finding_objects_skipped(self):
+        parser = StreamingFindingsParser()
+        emitted = parser.feed('[{"note": "not a finding"}, {"line": 1, "message": "m"}]')
+        assert len(emitted) == 1
+        assert emitted[0]["line"] == 1
+
+    def test_reset_discards_partial_stream(self):
+        parser = StreamingFindingsParser()
+        parser.feed('[{"line": 1, "message": "from aborted attempt"}')
+        parser.reset()
+        emitted = parser.feed('[{"line": 2, "message": "retry"}]')
+        assert [f["line"] for f in emitted] == [2]
+        assert parser.finish() == []
+
+
+class TestReviewStreamingIntegration:
+    """Streaming mode through review_file / review_pr."""
+
+    def test_review_file_stream_matches_non_stream(self):
+        from scripts.stage3_llm_reviewer import call_anthropic_api  # noqa: F401
+
+        resp = _FakeSSEResponse(_sse_lines([SAMPLE_LLM_RESPONSE]))
+        budget = BudgetTracker()
+
+        with patch("urllib.request.urlopen", return_value=resp):
+            findings = review_file(
+                "Source/MyActor.cpp",
+                SAMPLE_DIFF,
+                "system",
+                set(),
+                budget,
+                api_key="test-key",
+                stream=True,
+            )
+
+        assert len(findings) == 2
+        assert all(f["stage"] == "stage3" for f in findings)
+        assert budget.files_reviewed == 1
+
+    @patch("scripts.stage3_llm_reviewer.call_anthropic_api")
+    def test_on_findings_called_per_unit(self, mock_api):
+        mock_api.return_value = ("[]", 300, 50)
+        handed_off = []
+
+        findings, summary = review_pr(
+            SAMPLE_DIFF_MULTI,
+            concurrency=1,
+            on_findings=handed_off.append,
+        )
+
+        # Two C++ units (MyActor.cpp, MyWidget.h); README.md skipped.
+        assert len(handed_off) == 2
+        assert findings == [f for batch in handed_off for f in batch]
+
+    @patch("scripts.stage3_llm_reviewer.call_anthropic_api")
+    def test_on_findings_parallel_keeps_output_order(self, mock_api):
+        mock_api.side_effect = lambda sys_p, user_msg, **kw: (
+            SAMPLE_LLM_RESPONSE if "MyActor" in user_msg else "[]",
+            300, 50,
+        )
+        handed_off = []
+
+        findings, _ = review_pr(
+            SAMPLE_DIFF_MULTI,
+            concurrency=4,
+            on_findings=handed_off.append,
+        )
+
+        assert len(handed_off) == 2
+        # Returned list is in sorted file order regardless of
+        # completion order.
+        assert [f["file"] for f in findings] == [
+            "Source/MyActor.cpp", "Source/MyActor.cpp",
+        ]
+
+
+# ---------------------------------------------------------------------------
+# exclusion_keys — in-memory exclusion set (single-job pipeline mode)
+# ---------------------------------------------------------------------------
+
+
+class TestExclusionKeys:
+    def test_builds_file_line_keys(self):
+        findings = [
+            {"file": "Source/A.cpp", "line": 10, "rule_id": "x"},
+            {"file": "Source/B.h", "line": "7", "rule_id": "y"},
+        ]
+        assert exclusion_keys(findings) == {
+            ("Source/A.cpp", 10),
+            ("Source/B.h", 7),
+        }
+
+    def test_invalid_entries_skipped(self):
+        findings = [
+            "not a dict",
+            {"file": "", "line": 5},
+            {"file": "Source/A.cpp", "line": "abc"},
+            {"file": "Source/A.cpp", "line": 0},
+            {"file": 42, "line": 3},
+        ]
+        assert exclusion_keys(findings) == set()
+
+    def test_matches_load_exclude_findings(self, tmp_path):
+        """In-memory keys agree with the JSON-file loader."""
+        findings = [
+            {"file": "Source/A.cpp", "line": 10, "rule_id": "x"},
+            {"file": "Source/B.h", "line": 20, "rule_id": "y"},
+        ]
+        f = tmp_path / "findings.json"
+        f.write_text(json.dumps(findings), encoding="utf-8")
+        assert exclusion_keys(findings) == load_exclude_findings([str(f)])
+
+
+# ---------------------------------------------------------------------------
+# Prompt caching — cache_control breakpoints and cache-token accounting
+# ---------------------------------------------------------------------------
+
+
+class TestBuildUserContent:
+    def test_plain_string_without_source(self):
+        from scripts.stage3_llm_reviewer import build_user_content
+
+        content = build_user_content("Source/A.cpp", "+int x;")
+        assert content == build_user_message("Source/A.cpp", "+int x;")
+
+    def test_blocks_concat_matches_user_message(self):
+        """Block text joins back to the exact single-string message."""
+        from scripts.stage3_llm_reviewer import build_user_content
+
+        content = build_user_content(
+            "Source/A.cpp", "+int x;", full_source="void Foo() {}"
+        )
+        assert isinstance(content, list)
+        assert len(content) == 2
+        joined = "".join(block["text"] for block in content)
+        assert joined == build_user_message(
+            "Source/A.cpp", "+int x;", "void Foo() {}"
+        )
+
+    def test_cache_control_on_source_block_only(self):
+        from scripts.stage3_llm_reviewer import build_user_content
+
+        content = build_user_content(
+            "Source/A.cpp", "+int x;", full_source="void Foo() {}"
+        )
+        assert content[0]["cache_control"] == {"type": "ephemeral"}
+        assert "전체 소스" in content[0]["text"]
+        assert "cache_control" not in content[1]
+
+
+class TestPromptCachingApiPayload:
+    def _fake_response(self, usage):
+        body = json.dumps(
+            {
+                "content": [{"type": "text", "text": "[]"}],
+                "usage": usage,
+            }
+        ).encode("utf-8")
+        resp = MagicMock()
+        resp.read.return_value = body
+        resp.__enter__ = MagicMock(return_value=resp)
+        resp.__exit__ = MagicMock(return_value=False)
+        return resp
+
+    def test_system_prompt_sent_with_cache_control(self):
+        from scripts.stage3_llm_reviewer import call_anthropic_api
+
+        captured = {}
+
+        def fake_urlopen(req, timeout=None):
+            captured["payload"] = json.loads(req.data.decode("utf-8"))
+            return self._fake_response({"input_tokens": 10, "output_tokens": 5})
+
+        with patch("urllib.request.urlopen", side_effect=fake_urlopen):
+            call_anthropic_api("system text", "user text", api_key="test-key")
+
+        system = captured["payload"]["system"]
+        assert isinstance(system, list)
+        assert system[0]["text"] == "system text"
+        assert system[0]["cache_control"] == {"type": "ephemeral"}
+
+    def test_usage_out_surfaces_cache_tokens(self):
+        from scripts.stage3_llm_reviewer import call_anthropic_api
+
+        usage = {
+            "input_tokens": 10,
+            "output_tokens": 5,
+            "cache_read_input_tokens": 900,
+            "cache_creation_input_tokens": 100,
+        }
+        usage_out = {}
+        with patch(
+            "urllib.request.urlopen",
+            return_value=self._fake_response(usage),
+        ):
+            text, inp, out = call_anthropic_api(
+                "system", "user", api_key="test-key", usage_out=usage_out
+            )
+        assert (inp, out) == (10, 5)
+        assert usage_out["cache_read_input_tokens"] == 900
+        assert usage_out["cache_creation_input_tokens"] == 100
+
+
+class TestBudgetTrackerCacheTokens:
+    def test_record_usage_tracks_cache_counters(self):
+        budget = BudgetTracker()
+        budget.record_usage(
+            1000, 500, cache_read_tokens=9000, cache_creation_tokens=2000
+        )
+        assert budget.total_input_tokens == 1000
+        assert budget.total_cache_read_tokens == 9000
+        assert budget.total_cache_creation_tokens == 2000
+        summary = budget.summary()
+        assert summary["cache_read_input_tokens"] == 9000
+        assert summary["cache_creation_input_tokens"] == 2000
+
+    def test_cache_tokens_priced_below_input(self):
+        """Cache reads cost 0.1x input; writes cost 1.25x."""
+        plain = BudgetTracker()
+        plain.record_usage(10_000, 0)
+        cached = BudgetTracker()
+        cached.record_usage(0, 0, cache_read_tokens=10_000)
+        assert cached.total_cost < plain.total_cost
+        written = BudgetTracker()
+        written.record_usage(0, 0, cache_creation_tokens=10_000)
+        assert written.total_cost > plain.total_cost
+
+    def test_defaults_unchanged(self):
+        budget = BudgetTracker()
+        budget.record_usage(1000, 2000)
+        assert budget.total_input_tokens == 1000
+        assert budget.total_output_tokens == 2000
+        assert budget.total_cache_read_tokens == 0
+        assert budget.total_cache_creation_tokens == 0
+
+
+# ---------------------------------------------------------------------------
+# BudgetTracker reservations — thread-safe parallel budget enforcement
+# ---------------------------------------------------------------------------
+
+
+class TestBudgetTrackerReservations:
+    def test_reserve_then_settle(self):
+        bt = BudgetTracker(max_tokens=10_000)
+        assert bt.reserve(6_000) is True
+        # Reservation counts against headroom until settled.
+        assert bt.reserve(6_000) is False
+        bt.settle(6_000, 5_500, 100)
+        assert bt.reserved_tokens == 0
+        assert bt.total_input_tokens == 5_500
+        # Remaining headroom reflects actuals, not the old estimate.
+        assert bt.reserve(4_000) is True
+
+    def test_release_on_failure_restores_headroom(self):
+        bt = BudgetTracker(max_tokens=10_000)
+        assert bt.reserve(8_000) is True
+        bt.release(8_000)
+        assert bt.reserved_tokens == 0
+        assert bt.total_input_tokens == 0
+        assert bt.reserve(8_000) is True
+
+    def test_reserve_respects_cost_cap(self):
+        bt = BudgetTracker(max_tokens=10_000_000, max_cost=0.01)
+        # Worst-case output cost alone blows a 1-cent cap.
+        assert bt.reserve(100_000) is False
+        assert bt.reserved_tokens == 0
+
+    def test_can_review_file_counts_reservations(self):
+        bt = BudgetTracker(max_tokens=10_000)
+        bt.reserve(7_000)
+        assert bt.can_review_file(5_000) is False
+        assert bt.can_review_file(2_000) is True
+
+    def test_settle_records_cache_tokens(self):
+        bt = BudgetTracker()
+        bt.settle(1_000, 800, 50, cache_read_tokens=300, cache_creation_tokens=40)
+        assert bt.total_cache_read_tokens == 300
+        assert bt.total_cache_creation_tokens == 40
+
+    def test_parallel_workers_cannot_overshoot(self):
+        """Concurrent reserve() calls never exceed the token budget."""
+        import threading
+
+        bt = BudgetTracker(max_tokens=50_000, max_cost=1_000.0)
+        granted = []
+        lock = threading.Lock()
+
+        def worker():
+            if bt.reserve(10_000):
+                with lock:
+                    granted.append(10_000)
+
+        threads = [threading.Thread(target=worker) for _ in range(20)]
+        for th in threads:
+            th.start()
+        for th in threads:
+            th.join()
+        assert sum(granted) <= 50_000
+        assert bt.reserved_tokens == sum(granted)
+
+    def test_review_file_releases_reservation_on_api_error(self):
+        with patch(
+            "scripts.stage3_llm_reviewer.call_anthropic_api",
+            side_effect=RuntimeError("boom"),
+        ):
+            bt = BudgetTracker()
+            findings = review_file(
+                "Source/MyActor.cpp",
+                SAMPLE_DIFF,
+                build_system_prompt(True),
+                set(),
+                bt,
+            )
+        assert findings == []
+        assert bt.reserved_tokens == 0
+        assert bt.total_input_tokens == 0
+
+
+# ---------------------------------------------------------------------------
+# Tests: function-boundary-aware hunk splitting
+# ---------------------------------------------------------------------------
+
+def _make_function_lines(name, body_lines):
+    """Build added-lines for one complete C++ function."""
+    lines = [f"+void {name}()", "+{"]
+    for i in range(body_lines):
+        lines.append(f"+    DoWork_{name}({i});")
+    lines.append("+}")
+    return lines
+
+
+class TestLineBraceDelta:
+    """Tests for _line_brace_delta."""
+
+    def test_plain_braces(self):
+        from scripts.utils.token_budget import _line_brace_delta
+
+        assert _line_brace_delta("{", False) == (1, False)
+        assert _line_brace_delta("}", False) == (-1, False)
+        assert _line_brace_delta("if (x) { y(); }", False) == (0, False)
+
+    def test_braces_in_string_literal_ignored(self):
+        from scripts.utils.token_budget import _line_brace_delta
+
+        line = 'UE_LOG(LogTemp, Warning, TEXT("brace } here"));'
+        assert _line_brace_delta(line, False) == (0, False)
+
+    def test_escaped_quote_in_string(self):
+        from scripts.utils.token_budget import _line_brace_delta
+
+        line = 'const char* s = "say \\"hi\\" {";'
+        assert _line_brace_delta(line, False) == (0, False)
+
+    def test_char_literal_brace_ignored(self):
+        from scripts.utils.token_budget import _line_brace_delta
+
+        assert _line_brace_delta("char c = '}';", False) == (0, False)
+
+    def test_line_comment_ignored(self):
+        from scripts.utils.token_budget import _line_brace_delta
+
+        assert _line_brace_delta("x(); // closes scope }", False) == (0, False)
+
+    def test_block_comment_state_carries_across_lines(self):
+        from scripts.utils.token_budget import _line_brace_delta
+
+        delta, in_comment = _line_brace_delta("/* start {", False)
+        assert (delta, in_comment) == (0, True)
+        delta, in_comment = _line_brace_delta("still } inside", in_comment)
+        assert (delta, in_comment) == (0, True)
+        delta, in_comment = _line_brace_delta("end */ {", in_comment)
+        assert (delta, in_comment) == (1, False)
+
+
+class TestSplitIntoCodeUnits:
+    """Tests for _split_into_code_units."""
+
+    def test_splits_at_function_close(self):
+        from scripts.utils.token_budget import _split_into_code_units
+
+        lines = _make_function_lines("Alpha", 3) + _make_function_lines(
+            "Beta", 3
+        )
+        units = _split_into_code_units("\n".join(lines))
+        assert len(units) == 2
+        assert units[0][-1] == "+}"
+        assert units[1][0] == "+void Beta()"
+
+    def test_deletion_lines_do_not_affect_depth(self):
+        from scripts.utils.token_budget import _split_into_code_units
+
+        lines = ["+void F()", "+{", "-    OldCall(); }", "+    NewCall();", "+}"]
+        units = _split_into_code_units("\n".join(lines))
+        assert len(units) == 1
+
+    def test_blank_line_between_declarations_is_boundary(self):
+        from scripts.utils.token_budget import _split_into_code_units
+
+        lines = ["+int A = 1;", "+", "+int B = 2;"]
+        units = _split_into_code_units("\n".join(lines))
+        assert len(units) == 2
+
+    def test_no_boundary_inside_body(self):
+        from scripts.utils.token_budget import _split_into_code_units
+
+        lines = _make_function_lines("Gamma", 10)
+        units = _split_into_code_units("\n".join(lines))
+        assert len(units) == 1
+
+
+class TestChunkDiffFunctionBoundaries:
+    """chunk_diff must not cut a function mid-body when boundaries exist."""
+
+    @staticmethod
+    def _build_diff(num_functions, body_lines):
+        header = "--- a/f.cpp\n+++ b/f.cpp\n"
+        lines = []
+        for i in range(num_functions):
+            lines.extend(_make_function_lines(f"Func{i}", body_lines))
+        total = len(lines)
+        hunk = f"@@ -1,0 +1,{total} @@\n" + "\n".join(lines)
+        return header + hunk
+
+    def test_chunks_end_at_function_boundaries(self):
+        from scripts.utils.token_budget import chunk_diff, estimate_tokens
+
+        diff = self._build_diff(num_functions=8, body_lines=20)
+        assert estimate_tokens(diff) > 400
+        chunks = chunk_diff(diff, max_tokens=400)
+        assert len(chunks) > 1
+        # Every chunk's last content line closes a function — no chunk
+        # leaves a body dangling for the next one.
+        for chunk in chunks:
+            content = [
+                ln for ln in chunk.split("\n")
+                if ln.startswith("+") and ln != "+++ b/f.cpp"
+            ]
+            assert content[-1] == "+}", (
+                f"Chunk cut mid-function, ends with: {content[-1]!r}"
+            )
+            assert content[0].startswith("+void Func"), (
+                f"Chunk starts mid-function: {content[0]!r}"
+            )
+
+    def test_string_braces_do_not_desync_boundaries(self):
+        from scripts.utils.token_budget import chunk_diff
+
+        header = "--- a/f.cpp\n+++ b/f.cpp\n"
+        lines = []
+        for i in range(6):
+            lines.extend([
+                f"+void Log{i}()",
+                "+{",
+                '+    UE_LOG(LogTemp, Warning, TEXT("odd } brace %d"), '
+                f"{i});",
+            ] + [f"+    Work({j});" for j in range(15)] + ["+}"])
+        hunk = f"@@ -1,0 +1,{len(lines)} @@\n" + "\n".join(lines)
+        chunks = chunk_diff(header + hunk, max_tokens=350)
+        assert len(chunks) > 1
+        for chunk in chunks:
+            content = [ln for ln in chunk.split("\n") if ln.startswith("+")]
+            assert content[-1] == "+}"
+
+    def test_single_giant_function_falls_back_to_lines(self):
+        from scripts.utils.token_budget import chunk_diff
+
+        diff = self._build_diff(num_functions=1, body_lines=200)
+        chunks = chunk_diff(diff, max_tokens=300)
+        assert len(chunks) > 1
+
+    def test_content_preserved_across_chunks(self):
+        from scripts.utils.token_budget import chunk_diff
+
+        diff = self._build_diff(num_functions=8, body_lines=20)
+        chunks = chunk_diff(diff, max_tokens=400)
+        original_adds = [
+            ln for ln in diff.split("\n") if ln.startswith("+") and ln != "+++ b/f.cpp"
+        ]
+        chunk_adds = []
+        for chunk in chunks:
+            chunk_adds.extend(
+                ln for ln in chunk.split("\n")
+                if ln.startswith("+") and ln != "+++ b/f.cpp"
+            )
+        assert chunk_adds == original_adds
+
+    def test_headers_still_recalculated(self):
+        import re
+        from scripts.utils.token_budget import chunk_diff
+
+        diff = self._build_diff(num_functions=8, body_lines=20)
+        chunks = chunk_diff(diff, max_tokens=400)
+        total_new = 0
+        for chunk in chunks:
+            m = re.search(r"@@\s+-(\d+),(\d+)\s+\+(\d+),(\d+)\s+@@", chunk)
+            assert m
+            total_new += int(m.group(4))
+        # 8 functions x (20 body + 3 scaffold lines) added lines in total.
+        assert total_new == 8 * 23
+
+
+class TestModelRouter:
+    """Tests for complexity-based model routing."""
+
+    TRIVIAL_DIFF = "--- a/f.cpp\n+++ b/f.cpp\n@@ -1,2 +1,3 @@\n int x;\n+int y;\n"
+
+    def _big_diff(self, lines: int = 200) -> str:
+        body = "\n".join(f"+    DoSomethingLong(Argument{i});" for i in range(lines))
+        return f"--- a/f.cpp\n+++ b/f.cpp\n@@ -1,2 +1,{lines + 2} @@\n int x;\n{body}\n"
+
+    def test_score_scales_with_added_lines(self):
+        router = ModelRouter("strong-model", "fast-model")
+        small = router.score_file("f.cpp", self.TRIVIAL_DIFF)
+        big = router.score_file("f.cpp", self._big_diff())
+        assert big > small
+
+    def test_checklist_hit_raises_score(self):
+        import re as re_mod
+
+        diff = self.TRIVIAL_DIFF.replace("+int y;", "+auto y = Get();")
+        plain = ModelRouter("strong-model", "fast-model")
+        weighted = ModelRouter(
+            "strong-model",
+            "fast-model",
+            checklist_rules=[{"compiled": re_mod.compile(r"\bauto\b")}],
+        )
+        delta = weighted.score_file("f.cpp", diff) - plain.score_file("f.cpp", diff)
+        assert abs(delta - 5.0) < 1e-9
+
+    def test_high_risk_path_forces_strong_model(self):
+        router = ModelRouter(
+            "strong-model",
+            "fast-model",
+            threshold=1_000_000.0,
+            high_risk_patterns=[r"Replication"],
+        )
+        unit = [("Source/ReplicationGraph.cpp", self.TRIVIAL_DIFF, None)]
+        assert router.model_for_unit(unit) == "strong-model"
+
+    def test_invalid_high_risk_pattern_ignored(self, capsys):
+        router = ModelRouter(
+            "strong-model", "fast-model", high_risk_patterns=["(unclosed"]
+        )
+        assert not router.is_high_risk("Source/unclosed.cpp")
+        assert "Invalid high-risk path pattern" in capsys.readouterr().err
+
+    def test_simple_unit_uses_fast_model(self):
+        router = ModelRouter(
+            "strong-model", "fast-model", threshold=1_000_000.0
+        )
+        unit = [("Source/MyActor.cpp", self.TRIVIAL_DIFF, None)]
+        assert router.model_for_unit(unit) == "fast-model"
+
+    def test_any_complex_member_upgrades_batch(self):
+        router = ModelRouter("strong-model", "fast-model", threshold=0.0)
+        unit = [
+            ("Source/A.cpp", self.TRIVIAL_DIFF, None),
+            ("Source/B.cpp", self.TRIVIAL_DIFF, None),
+        ]
+        assert router.model_for_unit(unit) == "strong-model"
+
+    def test_from_configs_disabled_by_empty_fast_model(self, tmp_path):
+        config = tmp_path / "gate_config.yml"
+        config.write_text('stage3_fast_model: ""\n', encoding="utf-8")
+        assert ModelRouter.from_configs("strong-model", str(config)) is None
+
+    def test_from_configs_missing_file_warns_and_disables(self, capsys):
+        router = ModelRouter.from_configs("strong-model", "/nonexistent/gate.yml")
+        assert router is None
+        assert "model routing disabled" in capsys.readouterr().err
+
+    def test_from_configs_reads_settings(self, tmp_path):
+        config = tmp_path / "gate_config.yml"
+        config.write_text(
+            "stage3_fast_model: fast-model\n"
+            "stage3_complexity_threshold: 10\n"
+            "stage3_strong_model_paths:\n"
+            '  - "Replication"\n',
+            encoding="utf-8",
+        )
+        router = ModelRouter.from_configs("strong-model", str(config))
+        assert router is not None
+        assert router.fast_model == "fast-model"
+        assert router.strong_model == "strong-model"
+        assert router.threshold == 10.0
+        assert router.is_high_risk("Source/ReplicationGraph.cpp")
+
+    def test_from_configs_default_threshold(self, tmp_path):
+        config = tmp_path / "gate_config.yml"
+        config.write_text("stage3_fast_model: fast-model\n", encoding="utf-8")
+        router = ModelRouter.from_configs("strong-model", str(config))
+        assert router.threshold == DEFAULT_COMPLEXITY_THRESHOLD
+
+    def test_from_configs_missing_checklist_warns(self, tmp_path, capsys):
+        config = tmp_path / "gate_config.yml"
+        config.write_text("stage3_fast_model: fast-model\n", encoding="utf-8")
+        router = ModelRouter.from_configs(
+            "strong-model", str(config), checklist_path="/nonexistent/checklist.yml"
+        )
+        assert router is not None
+        assert "Tier-1" in capsys.readouterr().err
+
+
+class TestBudgetTrackerPerModel:
+    """Tests for per-model usage accounting."""
+
+    def test_record_usage_accumulates_per_model(self):
+        bt = BudgetTracker()
+        bt.record_usage(1000, 200, model="fast-model")
+        bt.record_usage(500, 100, model="fast-model")
+        bt.record_usage(2000, 400, model="strong-model")
+        fast = bt.per_model["fast-model"]
+        assert fast["api_calls"] == 2
+        assert fast["input_tokens"] == 1500
+        assert fast["output_tokens"] == 300
+        assert fast["cost_usd"] > 0
+        assert bt.per_model["strong-model"]["api_calls"] == 1
+
+    def test_settle_accumulates_per_model(self):
+        bt = BudgetTracker()
+        assert bt.reserve(1000)
+        bt.settle(1000, 800, 100, model="strong-model")
+        entry = bt.per_model["strong-model"]
+        assert entry["api_calls"] == 1
+        assert entry["input_tokens"] == 800
+
+    def test_no_model_keeps_per_model_empty(self):
+        bt = BudgetTracker()
+        bt.record_usage(1000, 200)
+        assert bt.per_model == {}
+
+    def test_summary_includes_per_model(self):
+        bt = BudgetTracker()
+        bt.record_usage(1000, 200, model="fast-model")
+        summary = bt.summary()
+        assert "per_model" in summary
+        entry = summary["per_model"]["fast-model"]
+        assert entry["api_calls"] == 1
+        assert entry["cost_usd"] == round(entry["cost_usd"], 4)
+
+
+class TestReviewPrModelRouting:
+    """Tests for review_pr with a ModelRouter."""
+
+    @patch("scripts.stage3_llm_reviewer.call_anthropic_api")
+    def test_simple_files_route_to_fast_model(self, mock_api):
+        mock_api.return_value = (SAMPLE_LLM_RESPONSE, 500, 200)
+        router = ModelRouter(
+            DEFAULT_MODEL, "fast-model", threshold=1_000_000.0
+        )
+        findings, summary = review_pr(SAMPLE_DIFF_MULTI, router=router)
+        assert mock_api.call_count == 2
+        for call in mock_api.call_args_list:
+            assert call.kwargs["model"] == "fast-model"
+        assert set(summary["per_model"]) == {"fast-model"}
+        assert summary["per_model"]["fast-model"]["api_calls"] == 2
+
+    @patch("scripts.stage3_llm_reviewer.call_anthropic_api")
+    def test_complex_files_keep_strong_model(self, mock_api):
+        mock_api.return_value = (SAMPLE_LLM_RESPONSE, 500, 200)
+        router = ModelRouter(DEFAULT_MODEL, "fast-model", threshold=0.0)
+        findings, summary = review_pr(SAMPLE_DIFF, router=router)
+        assert mock_api.call_count == 1
+        assert mock_api.call_args.kwargs["model"] == DEFAULT_MODEL
+        assert set(summary["per_model"]) == {DEFAULT_MODEL}
+
+    @patch("scripts.stage3_llm_reviewer.call_anthropic_api")
+    def test_no_router_uses_default_model(self, mock_api):
+        mock_api.return_value = (SAMPLE_LLM_RESPONSE, 500, 200)
+        findings, summary = review_pr(SAMPLE_DIFF)
+        assert mock_api.call_args.kwargs["model"] == DEFAULT_MODEL
+        assert set(summary["per_model"]) == {DEFAULT_MODEL}
@@ -0,0 +1,167 @@
+"""Tests for scripts/utils/metrics.py — per-stage timing metrics.
+
+Covers:
+  - Percentile computation (nearest-rank)
+  - StageMetrics timers, counters, and info attachments
+  - finish() summary shape and save()/load roundtrip
+  - load_stage_metrics tolerance for missing/corrupt files
+  - format_metrics_table markdown rendering
+"""
+
+from __future__ import annotations
+
+import json
+import sys
+from pathlib import Path
+
+import pytest
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
+
+from scripts.utils.metrics import (
+    StageMetrics,
+    format_metrics_table,
+    load_stage_metrics,
+    percentile,
+)
+
+
+class TestPercentile:
+    def test_single_sample(self):
+        assert percentile([0.5], 95) == 0.5
+
+    def test_median_of_odd_count(self):
+        assert percentile([3.0, 1.0, 2.0], 50) == 2.0
+
+    def test_p95_picks_near_top(self):
+        samples = [float(i) for i in range(1, 101)]
+        assert percentile(samples, 95) == 95.0
+
+    def test_p0_and_p100_are_extremes(self):
+        samples = [5.0, 1.0, 3.0]
+        assert percentile(samples, 0) == 1.0
+        assert percentile(samples, 100) == 5.0
+
+    def test_empty_raises(self):
+        with pytest.raises(ValueError):
+            percentile([], 50)
+
+
+class TestStageMetrics:
+    def test_timer_records_sample(self):
+        metrics = StageMetrics("gate")
+        with metrics.timer("gate_check"):
+            pass
+        result = metrics.finish()
+        assert result["stage"] == "gate"
+        assert result["timings"]["gate_check"]["count"] == 1
+        assert result["timings"]["gate_check"]["total_s"] >= 0
+
+    def test_timer_records_on_exception(self):
+        metrics = StageMetrics("gate")
+        with pytest.raises(RuntimeError):
+            with metrics.timer("gate_check"):
+                raise RuntimeError("boom")
+        assert metrics.finish()["timings"]["gate_check"]["count"] == 1
+
+    def test_counters_accumulate(self):
+        metrics = StageMetrics("stage1-pattern")
+        metrics.incr("findings", 3)
+        metrics.incr("findings", 2)
+        metrics.incr("files_checked")
+        counters = metrics.finish()["counters"]
+        assert counters["findings"] == 5
+        assert counters["files_checked"] == 1
+
+    def test_timing_summary_stats(self):
+        metrics = StageMetrics("stage3-llm")
+        for seconds in [0.1, 0.2, 0.3, 0.4]:
+            metrics.add_timing("api_call", seconds)
+        stats = metrics.finish()["timings"]["api_call"]
+        assert stats["count"] == 4
+        assert round(stats["total_s"], 6) == 1.0
+        assert round(stats["mean_s"], 6) == 0.25
+        assert round(stats["max_s"], 6) == 0.4
+        assert round(stats["p50_s"], 6) in (0.2, 0.3)
+
+    def test_wall_time_present(self):
+        result = StageMetrics("gate").finish()
+        assert result["wall_time_s"] >= 0
+
+    def test_set_info_attached(self):
+        metrics = StageMetrics("stage3-llm")
+        metrics.set_info("budget", {"total_cost_usd": 0.12})
+        result = metrics.finish()
+        assert result["info"]["budget"]["total_cost_usd"] == 0.12
+
+    def test_info_absent_when_unused(self):
+        assert "info" not in StageMetrics("gate").finish()
+
+    def test_save_and_load_roundtrip(self, tmp_path):
+        metrics = StageMetrics("stage2-tidy")
+        metrics.incr("status_ok", 2)
+        metrics.add_timing("clang_tidy_file", 1.5)
+        path = tmp_path / "metrics.json"
+        metrics.save(path)
+
+        loaded = load_stage_metrics([path])
+        assert len(loaded) == 1
+        assert loaded[0]["stage"] == "stage2-tidy"
+        assert loaded[0]["counters"]["status_ok"] == 2
+
+
+class TestLoadStageMetrics:
+    def test_missing_file_warns_and_skips(self, tmp_path, capsys):
+        loaded = load_stage_metrics([tmp_path / "nope.json"])
+        assert loaded == []
+        assert "not found" in capsys.readouterr().err
+
+    def test_corrupt_file_warns_and_skips(self, tmp_path, capsys):
+        bad = tmp_path / "bad.json"
+        bad.write_text("{not json", encoding="utf-8")
+        assert load_stage_metrics([bad]) == []
+        assert "Could not read" in capsys.readouterr().err
+
+    def test_unrecognized_format_skipped(self, tmp_path, capsys):
+        odd = tmp_path / "odd.json"
+        odd.write_text(json.dumps([1, 2, 3]), encoding="utf-8")
+        assert load_stage_metrics([odd]) == []
+        assert "Unrecognized" in capsys.readouterr().err
+
+    def test_preserves_input_order(self, tmp_path):
+        for name in ["a", "b"]:
+            m = StageMetrics(name)
+            m.save(tmp_path / f"{name}.json")
+        loaded = load_stage_metrics([tmp_path / "b.json", tmp_path / "a.json"])
+        assert [m["stage"] for m in loaded] == ["b", "a"]
+
+
+class TestFormatMetricsTable:
+    def test_empty_list_renders_nothing(self):
+        assert format_metrics_table([]) == ""
+
+    def test_table_contains_stages_and_header(self):
+        metrics_a = StageMetrics("gate")
+        metrics_a.incr("files_total", 12)
+        metrics_b = StageMetrics("stage1-pattern")
+        metrics_b.add_timing("regex_scan", 0.05)
+
+        table = format_metrics_table([metrics_a.finish(), metrics_b.finish()])
+        assert "### 처리 시간" in table
+        assert "| gate |" in table
+        assert "| stage1-pattern |" in table
+        assert "files_total=12" in table
+        assert "regex_scan" in table
+
+    def test_duration_formats_ms_and_seconds(self):
+        metrics = StageMetrics("stage3-llm")
+        metrics.add_timing("api_call", 0.5)
+        metrics.add_timing("api_call", 2.5)
+        table = format_metrics_table([metrics.finish()])
+        # total 3.0s formats in seconds, p95 2.5s likewise
+        assert "api_call 3.00s" in table
+
+    def test_stage_without_data_shows_placeholder(self):
+        table = format_metrics_table([StageMetrics("gate").finish()])
+        assert "| gate |" in table
+        assert "| - |" in table
@@ -28,7 +28,13 @@ from scripts.stage1_pattern_checker import (
     _split_code_comment,
     _strip_comments,
 )
-from scripts.utils.diff_parser import FileDiff, parse_diff
+from scripts.utils.diff_parser import (
+    FileDiff,
+    iter_parse_diff,
+    load_parsed_diff,
+    parse_diff,
+    save_parsed_diff,
+)
 
 # --- Fixtures ---
 
@@ -1300,3 +1306,426 @@ class TestGetDiffFromGit:
         # Should NOT have pathspec (no "--" separator or file paths)
         assert "--" not in captured_cmd
         assert "Source/A.cpp" not in captured_cmd
+
+
+# ---------------------------------------------------------------------------
+# Combined scan engine
+# ---------------------------------------------------------------------------
+
+
+class TestCombinedPatternScanner:
+    """Tests for the merged-alternation scan engine."""
+
+    # Lines covering every rule, overlap cases, and non-matching code.
+    SAMPLE_LINES = [
+        'UE_LOG(LogTemp, Warning, TEXT("hi"))',  # logtemp + macro_no_semicolon
+        'UE_LOG(LogMyGame, Warning, TEXT("hi"));',
+        '#pragma optimize("", off)',
+        'ConstructorHelpers::FObjectFinder<UStaticMesh> Mesh(TEXT("/Game/Meshes/Cube"));',
+        "UPROPERTY(EditAnywhere);",
+        "check(Value++)",
+        "LoadObject<UTexture2D>(nullptr, *Path);",
+        "    check(bFlag)",
+        "int32 Count = 0;",
+        "void AMyActor::BeginPlay()",
+        "",
+        "    Super::BeginPlay();",
+    ]
+
+    def test_matches_per_rule_loop(self, patterns):
+        from scripts.stage1_pattern_checker import CombinedPatternScanner
+
+        scanner = CombinedPatternScanner(patterns)
+        for line in self.SAMPLE_LINES:
+            expected = [p["id"] for p in patterns if p["compiled"].search(line)]
+            got = [p["id"] for p in scanner.match_rules(line)]
+            assert got == expected, f"mismatch on line: {line!r}"
+
+    def test_overlapping_rules_all_reported(self, patterns):
+        """Rules whose matches overlap must all fire (alternation alone
+        would consume the span of the leftmost match)."""
+        from scripts.stage1_pattern_checker import CombinedPatternScanner
+
+        scanner = CombinedPatternScanner(patterns)
+        matched = {p["id"] for p in scanner.match_rules(
+            'UE_LOG(LogTemp, Warning, TEXT("hi"))'
+        )}
+        assert {"logtemp", "macro_no_semicolon"} <= matched
+
+    def test_prefilter_built_from_checklist(self, patterns):
+        from scripts.stage1_pattern_checker import CombinedPatternScanner
+
+        scanner = CombinedPatternScanner(patterns)
+        # Every checklist rule has at least one derivable anchor literal,
+        # so the fast path must be active.
+        assert scanner._prefilter is not None
+        assert "LogTemp" in scanner._prefilter
+
+    def test_empty_patterns(self):
+        from scripts.stage1_pattern_checker import CombinedPatternScanner
+
+        scanner = CombinedPatternScanner([])
+        assert scanner.match_rules("UE_LOG(LogTemp, Warning, x);") == []
+
+    def test_check_line_with_scanner_matches_without(self, patterns):
+        from scripts.stage1_pattern_checker import CombinedPatternScanner
+
+        scanner = CombinedPatternScanner(patterns)
+        for line in self.SAMPLE_LINES:
+            without = check_line(line, patterns)
+            with_scanner = check_line(line, patterns, scanner=scanner)
+            assert with_scanner == without
+
+    def test_prev_line_rule_still_validated(self, patterns):
+        """unbraced_shipping_macro needs prev-line context with or
+        without the scanner."""
+        from scripts.stage1_pattern_checker import CombinedPatternScanner
+
+        scanner = CombinedPatternScanner(patterns)
+        line = "    check(bFlag)"
+        prev = "    if (bCondition)"
+        with_prev = check_line(line, patterns, prev_line=prev, scanner=scanner)
+        without_prev = check_line(line, patterns, prev_line=None, scanner=scanner)
+        assert {f["rule_id"] for f in with_prev} >= {"unbraced_shipping_macro"}
+        assert "unbraced_shipping_macro" not in {
+            f["rule_id"] for f in without_prev
+        }
+
+
+class TestRequiredLiterals:
+    """Tests for regex anchor-literal extraction."""
+
+    def test_plain_literal(self):
+        from scripts.stage1_pattern_checker import _required_literals
+
+        assert _required_literals(r"\bLogTemp\b") == {"LogTemp"}
+
+    def test_alternation_union(self):
+        from scripts.stage1_pattern_checker import _required_literals
+
+        anchors = _required_literals(r"(UE_LOG|ensure|verify)\s*\(")
+        assert anchors == {"UE_LOG", "ensure", "verify"}
+
+    def test_optional_group_not_required(self):
+        from scripts.stage1_pattern_checker import _required_literals
+
+        # "Maybe" is optional, so it cannot anchor; "Anchor" can.
+        assert _required_literals(r"(Maybe)?Anchor") == {"Anchor"}
+
+    def test_branch_without_literals_gives_none(self):
+        from scripts.stage1_pattern_checker import _required_literals
+
+        assert _required_literals(r"[A-Z]+\d*") is None
+
+    def test_short_literals_rejected(self):
+        from scripts.stage1_pattern_checker import _required_literals
+
+        # Two-character literals are too common to be useful anchors.
+        assert _required_literals(r"if\s*\(") is None
+
+    def test_every_checklist_rule_has_anchor(self, patterns):
+        from scripts.stage1_pattern_checker import _required_literals
+
+        for pat in patterns:
+            anchors = _required_literals(pat["raw_pattern"])
+            assert anchors, f"no anchor literals for rule {pat['id']}"
+
+
+# ============================================================================
+# Streaming diff parser and parsed-diff artifact tests
+# ============================================================================
+
+
+class TestIterParseDiff:
+    """Tests for the streaming generator-based diff parser."""
+
+    MULTI_FILE_DIFF = textwrap.dedent("""\
+        diff --git a/Source/A.cpp b/Source/A.cpp
+        --- a/Source/A.cpp
+        +++ b/Source/A.cpp
+        @@ -1,2 +1,3 @@
+         context
+        +added in A
+         more context
+        diff --git a/Source/B.h b/Source/B.h
+        --- a/Source/B.h
+        +++ b/Source/B.h
+        @@ -10,1 +10,2 @@
+         ctx
+        +added in B
+    """)
+
+    def test_yields_file_diffs_in_order(self):
+        results = list(iter_parse_diff(self.MULTI_FILE_DIFF.splitlines()))
+        assert [fd.path for fd in results] == ["Source/A.cpp", "Source/B.h"]
+
+    def test_matches_parse_diff(self):
+        parsed = parse_diff(self.MULTI_FILE_DIFF)
+        streamed = {
+            fd.path: fd
+            for fd in iter_parse_diff(self.MULTI_FILE_DIFF.splitlines())
+        }
+        assert streamed.keys() == parsed.keys()
+        for path, fd in parsed.items():
+            assert streamed[path].added_lines == fd.added_lines
+            assert streamed[path].context_lines == fd.context_lines
+            assert streamed[path].hunks == fd.hunks
+
+    def test_first_file_available_before_exhaustion(self):
+        """Each FileDiff is yielded as soon as its section completes."""
+        it = iter_parse_diff(self.MULTI_FILE_DIFF.splitlines())
+        first = next(it)
+        assert first.path == "Source/A.cpp"
+        assert first.added_lines == {2: "added in A"}
+
+    def test_streams_from_open_file(self, tmp_path):
+        """Reading an open file object works without materializing text."""
+        diff_file = tmp_path / "pr.diff"
+        diff_file.write_text(self.MULTI_FILE_DIFF, encoding="utf-8")
+        with open(diff_file, "r", encoding="utf-8") as f:
+            results = list(iter_parse_diff(f))
+        assert [fd.path for fd in results] == ["Source/A.cpp", "Source/B.h"]
+        assert results[1].added_lines == {11: "added in B"}
+
+    def test_deleted_file_excluded(self):
+        diff = textwrap.dedent("""\
+            diff --git a/Source/Gone.cpp b/Source/Gone.cpp
+            deleted file mode 100644
+            --- a/Source/Gone.cpp
+            +++ /dev/null
+            @@ -1,2 +0,0 @@
+            -bye
+            -bye
+        """)
+        assert list(iter_parse_diff(diff.splitlines())) == []
+
+    def test_duplicate_path_sections_merged_by_parse_diff(self):
+        diff = textwrap.dedent("""\
+            diff --git a/Source/A.cpp b/Source/A.cpp
+            --- a/Source/A.cpp
+            +++ b/Source/A.cpp
+            @@ -1,1 +1,2 @@
+             ctx
+            +first section
+            diff --git a/Source/A.cpp b/Source/A.cpp
+            --- a/Source/A.cpp
+            +++ b/Source/A.cpp
+            @@ -10,1 +10,2 @@
+             ctx
+            +second section
+        """)
+        # Streaming yields one FileDiff per section...
+        streamed = list(iter_parse_diff(diff.splitlines()))
+        assert len(streamed) == 2
+        # ...while parse_diff merges them under one path
+        parsed = parse_diff(diff)
+        assert len(parsed) == 1
+        fd = parsed["Source/A.cpp"]
+        assert fd.added_lines == {2: "first section", 11: "second section"}
+        assert len(fd.hunks) == 2
+
+
+class TestParsedDiffArtifact:
+    """Tests for the shared parsed-diff JSON artifact."""
+
+    def test_round_trip_preserves_data(self, tmp_path):
+        diff = textwrap.dedent("""\
+            diff --git a/Source/A.cpp b/Source/A.cpp
+            --- a/Source/A.cpp
+            +++ b/Source/A.cpp
+            @@ -1,2 +1,3 @@
+             context
+            +UE_LOG(LogTemp, Warning, TEXT("hi"));
+             more context
+        """)
+        parsed = parse_diff(diff)
+        artifact = tmp_path / "pr-diff.json"
+        save_parsed_diff(parsed, artifact)
+        loaded = load_parsed_diff(artifact)
+
+        assert loaded.keys() == parsed.keys()
+        fd = loaded["Source/A.cpp"]
+        # Line-number keys must come back as int, not JSON strings
+        assert fd.added_lines == parsed["Source/A.cpp"].added_lines
+        assert fd.context_lines == parsed["Source/A.cpp"].context_lines
+        assert fd.hunks == parsed["Source/A.cpp"].hunks
+
+    def test_check_diff_agrees_on_loaded_artifact(self, tmp_path):
+        """Pattern checking a loaded artifact matches direct parsing."""
+        diff = textwrap.dedent("""\
+            diff --git a/Source/A.cpp b/Source/A.cpp
+            --- a/Source/A.cpp
+            +++ b/Source/A.cpp
+            @@ -1,2 +1,3 @@
+             context
+            +UE_LOG(LogTemp, Warning, TEXT("hi"));
+             more context
+        """)
+        patterns = load_tier1_patterns(str(CHECKLIST_PATH))
+        direct = check_diff(parse_diff(diff), patterns)
+
+        artifact = tmp_path / "pr-diff.json"
+        save_parsed_diff(parse_diff(diff), artifact)
+        via_artifact = check_diff(load_parsed_diff(artifact), patterns)
+
+        assert via_artifact == direct
+
+
+# ============================================================================
+# Streaming comment classifier tests
+# ============================================================================
+
+
+class TestScanCodeSegment:
+    """Tests for _scan_code_segment — single-pass line classifier."""
+
+    def test_plain_code_unchanged(self):
+        from scripts.stage1_pattern_checker import _scan_code_segment
+
+        assert _scan_code_segment("int x = 5;", False) == ("int x = 5;", False)
+
+    def test_inline_comment_removed(self):
+        from scripts.stage1_pattern_checker import _scan_code_segment
+
+        code, in_block = _scan_code_segment("int x = 5; // note", False)
+        assert code == "int x = 5; "
+        assert in_block is False
+
+    def test_url_in_string_preserved(self):
+        from scripts.stage1_pattern_checker import _scan_code_segment
+
+        line = 'UE_LOG(LogNet, Log, TEXT("http://example.com"));'
+        assert _scan_code_segment(line, False) == (line, False)
+
+    def test_block_comment_opens_mid_line(self):
+        from scripts.stage1_pattern_checker import _scan_code_segment
+
+        code, in_block = _scan_code_segment("x(); /* start of block", False)
+        assert code == "x(); "
+        assert in_block is True
+
+    def test_block_comment_closes_mid_line(self):
+        from scripts.stage1_pattern_checker import _scan_code_segment
+
+        code, in_block = _scan_code_segment("still inside */ y();", True)
+        assert code == "  y();"
+        assert in_block is False
+
+    def test_block_comment_within_line(self):
+        from scripts.stage1_pattern_checker import _scan_code_segment
+
+        code, in_block = _scan_code_segment("a(); /* c */ b();", False)
+        assert code == "a();   b();"
+        assert in_block is False
+
+    def test_comment_start_inside_string_ignored(self):
+        from scripts.stage1_pattern_checker import _scan_code_segment
+
+        line = 'Print(TEXT("/* not a comment */"));'
+        assert _scan_code_segment(line, False) == (line, False)
+
+    def test_escaped_quote_in_string(self):
+        from scripts.stage1_pattern_checker import _scan_code_segment
+
+        line = 'Print("say \\"hi\\" // still string");'
+        assert _scan_code_segment(line, False) == (line, False)
+
+
+class TestBuildCodeLineMask:
+    """Tests for build_code_line_mask — block comment state across lines."""
+
+    def test_multi_line_block_comment_masked(self):
+        from scripts.stage1_pattern_checker import build_code_line_mask
+
+        mask = build_code_line_mask({
+            1: "int a = 1;",
+            2: "/*",
+            3: 'UE_LOG(LogTemp, Warning, TEXT("disabled"));',
+            4: "*/",
+            5: "int b = 2;",
+        })
+        assert mask[1] == "int a = 1;"
+        assert not mask[3].strip()
+        assert mask[5] == "int b = 2;"
+
+    def test_gap_resets_block_state(self):
+        from scripts.stage1_pattern_checker import build_code_line_mask
+
+        # Line 2 opens a block comment but line 10 is across a gap —
+        # unseen lines may have closed it, so state resets to code.
+        mask = build_code_line_mask({
+            1: "int a = 1;",
+            2: "/* opened here",
+            10: "int b = 2;",
+        })
+        assert mask[10] == "int b = 2;"
+
+    def test_contiguous_lines_carry_state(self):
+        from scripts.stage1_pattern_checker import build_code_line_mask
+
+        mask = build_code_line_mask({
+            7: "/* opened here",
+            8: "int hidden = 1;",
+        })
+        assert not mask[8].strip()
+
+
+class TestBlockCommentSuppression:
+    """check_diff must not fire patterns inside /* */ blocks."""
+
+    def test_pattern_inside_block_comment_suppressed(self, patterns):
+        diff = textwrap.dedent("""\
+            diff --git a/Source/A.cpp b/Source/A.cpp
+            --- a/Source/A.cpp
+            +++ b/Source/A.cpp
+            @@ -0,0 +1,6 @@
+            +/* Old implementation kept for reference:
+            +UE_LOG(LogTemp, Warning, TEXT("commented out"));
+            +*/
+            +void F()
+            +{
+            +}
+        """)
+        findings = check_diff(parse_diff(diff), patterns)
+        assert [f for f in findings if f["rule_id"] == "logtemp"] == []
+
+    def test_pattern_after_block_comment_still_fires(self, patterns):
+        diff = textwrap.dedent("""\
+            diff --git a/Source/A.cpp b/Source/A.cpp
+            --- a/Source/A.cpp
+            +++ b/Source/A.cpp
+            @@ -0,0 +1,4 @@
+            +/*
+            +disabled
+            +*/
+            +UE_LOG(LogTemp, Warning, TEXT("live code"));
+        """)
+        findings = check_diff(parse_diff(diff), patterns)
+        assert [f["rule_id"] for f in findings] == ["logtemp"]
+
+    def test_block_state_carries_over_context_lines(self, patterns):
+        diff = textwrap.dedent("""\
+            diff --git a/Source/A.cpp b/Source/A.cpp
+            --- a/Source/A.cpp
+            +++ b/Source/A.cpp
+            @@ -1,3 +1,4 @@
+             /*
+            +UE_LOG(LogTemp, Warning, TEXT("inside block"));
+             some note
+             */
+        """)
+        findings = check_diff(parse_diff(diff), patterns)
+        assert findings == []
+
+    def test_skip_comments_false_still_detects(self, patterns):
+        diff = textwrap.dedent("""\
+            diff --git a/Source/A.cpp b/Source/A.cpp
+            --- a/Source/A.cpp
+            +++ b/Source/A.cpp
+            @@ -0,0 +1,3 @@
+            +/*
+            +UE_LOG(LogTemp, Warning, TEXT("commented out"));
+            +*/
+        """)
+        findings = check_diff(parse_diff(diff), patterns, skip_comments=False)
+        assert "logtemp" in [f["rule_id"] for f in findings]
@@ -31,15 +31,20 @@ from scripts.post_review import (
     build_review_comments,
     build_summary,
     deduplicate_findings,
+    extract_fingerprint,
     filter_already_posted,
     filter_findings_by_diff,
+    finding_fingerprint,
     format_comment_body,
     load_findings,
     post_review,
+    post_review_streaming,
     split_into_batches,
 )
 from scripts.utils.gh_api import GitHubClient
 
+_FP_RE = __import__('re').compile(r"<!-- ue-review-bot:fp=[0-9a-f]{16} -->")
+
 
 # ---------------------------------------------------------------------------
 # Fixtures
@@ -603,6 +608,31 @@ class TestBuildSummary:
         assert "[SUGGESTION]: 1" in summary
         assert "[INFO]: 1" in summary
 
+    def test_metrics_table_appended(self, stage1_findings):
+        metrics = [
+            {
+                "stage": "gate",
+                "wall_time_s": 0.02,
+                "counters": {"files_total": 5},
+                "timings": {},
+            }
+        ]
+        summary = build_summary(stage1_findings, ["stage1"], metrics=metrics)
+        assert "### 처리 시간" in summary
+        assert "| gate |" in summary
+        assert "files_total=5" in summary
+
+    def test_metrics_table_on_clean_pr(self):
+        metrics = [
+            {"stage": "gate", "wall_time_s": 0.02, "counters": {}, "timings": {}}
+        ]
+        summary = build_summary([], metrics=metrics)
+        assert "No issues found" in summary
+        assert "### 처리 시간" in summary
+
+    def test_no_metrics_table_by_default(self, stage1_findings):
+        assert "처리 시간" not in build_summary(stage1_findings)
+
     def test_rule_count_summary(self):
         findings = [
             {"severity": "warning", "rule_id": "logtemp"},
@@ -1336,8 +1366,8 @@ class TestGitHubClient:
         client = GitHubClient(token="test-token")
         items = [{"id": i} for i in range(10)]
 
-        with patch.object(client, "_request") as mock_req:
-            mock_req.return_value = items
+        with patch.object(client, "_request_with_headers") as mock_req:
+            mock_req.return_value = (items, {})
             result = client._get_all_pages("/test/path", per_page=100)
             assert len(result) == 10
             mock_req.assert_called_once_with(
@@ -1345,25 +1375,31 @@ class TestGitHubClient:
             )
 
     def test_get_all_pages_multiple_pages(self):
-        """Multiple pages are fetched until an incomplete page is returned."""
+        """Without a Link header, pages are fetched serially until an
+        incomplete page is returned."""
         client = GitHubClient(token="test-token")
         page1 = [{"id": i} for i in range(100)]
         page2 = [{"id": i} for i in range(100, 130)]
 
-        with patch.object(client, "_request") as mock_req:
-            mock_req.side_effect = [page1, page2]
+        with patch.object(client, "_request_with_headers") as mock_first, \
+                patch.object(client, "_request") as mock_rest:
+            mock_first.return_value = (page1, {})
+            mock_rest.return_value = page2
             result = client._get_all_pages("/test/path", per_page=100)
             assert len(result) == 130
-            assert mock_req.call_count == 2
-            mock_req.assert_any_call("GET", "/test/path?per_page=100&page=1")
-            mock_req.assert_any_call("GET", "/test/path?per_page=100&page=2")
+            mock_first.assert_called_once_with(
+                "GET", "/test/path?per_page=100&page=1"
+            )
+            mock_rest.assert_called_once_with(
+                "GET", "/test/path?per_page=100&page=2"
+            )
 
     def test_get_all_pages_empty_first_page(self):
         """Empty first page returns empty list."""
         client = GitHubClient(token="test-token")
 
-        with patch.object(client, "_request") as mock_req:
-            mock_req.return_value = []
+        with patch.object(client, "_request_with_headers") as mock_req:
+            mock_req.return_value = ([], {})
             result = client._get_all_pages("/test/path")
             assert result == []
             mock_req.assert_called_once()
@@ -1374,11 +1410,171 @@ class TestGitHubClient:
         page1 = [{"id": i} for i in range(100)]
         page2: list = []
 
-        with patch.object(client, "_request") as mock_req:
-            mock_req.side_effect = [page1, page2]
+        with patch.object(client, "_request_with_headers") as mock_first, \
+                patch.object(client, "_request") as mock_rest:
+            mock_first.return_value = (page1, {})
+            mock_rest.return_value = page2
             result = client._get_all_pages("/test/path", per_page=100)
             assert len(result) == 100
-            assert mock_req.call_count == 2
+            assert mock_first.call_count == 1
+            assert mock_rest.call_count == 1
+
+    def test_get_all_pages_concurrent_with_link_header(self):
+        """With a rel="last" Link header, remaining pages are fetched in
+        parallel and results keep page order."""
+        client = GitHubClient(token="test-token")
+        page1 = [{"id": i} for i in range(100)]
+        page2 = [{"id": i} for i in range(100, 200)]
+        page3 = [{"id": i} for i in range(200, 230)]
+        link = (
+            '<https://api.github.com/test/path?per_page=100&page=2>; '
+            'rel="next", '
+            '<https://api.github.com/test/path?per_page=100&page=3>; '
+            'rel="last"'
+        )
+
+        def fake_request(method, path):
+            if "page=2" in path:
+                return page2
+            if "page=3" in path:
+                return page3
+            raise AssertionError(f"unexpected path: {path}")
+
+        with patch.object(client, "_request_with_headers") as mock_first, \
+                patch.object(client, "_request") as mock_rest:
+            mock_first.return_value = (page1, {"Link": link})
+            mock_rest.side_effect = fake_request
+            result = client._get_all_pages("/test/path", per_page=100)
+
+        assert [item["id"] for item in result] == list(range(230))
+        assert mock_first.call_count == 1
+        assert mock_rest.call_count == 2
+
+    def test_parse_last_page(self):
+        link = (
+            '<https://ghes.example.com/api/v3/x?per_page=100&page=2>; '
+            'rel="next", '
+            '<https://ghes.example.com/api/v3/x?per_page=100&page=34>; '
+            'rel="last"'
+        )
+        assert GitHubClient._parse_last_page({"Link": link}) == 34
+
+    def test_parse_last_page_case_insensitive_header(self):
+        link = '<https://api.github.com/x?page=5>; rel="last"'
+        assert GitHubClient._parse_last_page({"link": link}) == 5
+
+    def test_parse_last_page_absent(self):
+        assert GitHubClient._parse_last_page({}) is None
+        assert GitHubClient._parse_last_page(
+            {"Link": '<https://api.github.com/x?page=2>; rel="next"'}
+        ) is None
+
+
+class _FakeHTTPResponse:
+    def __init__(self, status=200, body=b"{}", headers=None):
+        self.status = status
+        self._body = body
+        self._headers = headers or {}
+
+    def getheaders(self):
+        return list(self._headers.items())
+
+    def read(self):
+        return self._body
+
+
+class _FakeConnection:
+    """Minimal http.client connection double for keep-alive tests."""
+
+    def __init__(self, responses=None):
+        self.requests = []
+        self.closed = False
+        self._responses = list(responses or [])
+
+    def request(self, method, path, body=None, headers=None):
+        self.requests.append((method, path))
+
+    def getresponse(self):
+        if self._responses:
+            item = self._responses.pop(0)
+            if isinstance(item, Exception):
+                raise item
+            return item
+        return _FakeHTTPResponse()
+
+    def close(self):
+        self.closed = True
+
+
+class TestGitHubClientKeepAlive:
+    """Tests for persistent connection reuse in GitHubClient."""
+
+    def test_connection_reused_across_requests(self):
+        client = GitHubClient(token="test-token")
+        conn = _FakeConnection()
+
+        with patch.object(client, "_new_connection", return_value=conn):
+            client._request("GET", "/repos/org/repo/pulls/1")
+            client._request("GET", "/repos/org/repo/pulls/2")
+
+        assert len(conn.requests) == 2
+        assert not conn.closed
+
+    def test_request_count_tracks_http_requests(self):
+        client = GitHubClient(token="test-token")
+        conn = _FakeConnection()
+
+        assert client.request_count == 0
+        with patch.object(client, "_new_connection", return_value=conn):
+            client._request("GET", "/repos/org/repo/pulls/1")
+            client._request("GET", "/repos/org/repo/pulls/2")
+
+        assert client.request_count == 2
+
+    def test_ghes_base_path_prefixed(self):
+        client = GitHubClient(
+            token="test-token",
+            api_url="https://github.company.com/api/v3",
+        )
+        conn = _FakeConnection()
+
+        with patch.object(client, "_new_connection", return_value=conn):
+            client._request("GET", "/repos/org/repo/pulls/1")
+
+        assert conn.requests == [("GET", "/api/v3/repos/org/repo/pulls/1")]
+
+    def test_stale_connection_reopened_immediately(self):
+        """A keep-alive connection the server closed retries on a fresh
+        connection without backoff."""
+        import http.client as http_client
+
+        client = GitHubClient(token="test-token")
+        stale = _FakeConnection(
+            responses=[http_client.RemoteDisconnected("closed")]
+        )
+        fresh = _FakeConnection(
+            responses=[_FakeHTTPResponse(body=b'{"ok": true}')]
+        )
+        client._local.conn = stale
+
+        with patch.object(client, "_new_connection", return_value=fresh):
+            result = client._request("GET", "/repos/org/repo/pulls/1")
+
+        assert result == {"ok": True}
+        assert stale.closed
+        assert len(fresh.requests) == 1
+
+    def test_http_error_raises_runtime_error(self):
+        client = GitHubClient(token="test-token")
+        conn = _FakeConnection(
+            responses=[
+                _FakeHTTPResponse(status=422, body=b'{"message": "bad"}')
+            ]
+        )
+
+        with patch.object(client, "_new_connection", return_value=conn):
+            with pytest.raises(RuntimeError, match="422"):
+                client._request("POST", "/repos/org/repo/pulls/1/reviews")
 
     def test_get_pull_request_path(self):
         client = GitHubClient(token="test-token")
@@ -1740,3 +1936,755 @@ class TestCLIValidation:
                         main()
                     # Partial success → exit 0
                     assert exc_info.value.code == 0
+
+
+# ---------------------------------------------------------------------------
+# post_review_streaming
+# ---------------------------------------------------------------------------
+
+
+class TestPostReviewStreaming:
+    """Tests for the pipelined posting entry point."""
+
+    def _make_client(self) -> MagicMock:
+        client = MagicMock(spec=GitHubClient)
+        client.create_review.return_value = {"id": 12345}
+        return client
+
+    @staticmethod
+    def _finding(i, file="Source/MyActor.cpp"):
+        return {
+            "file": file,
+            "line": 10 + i,
+            "severity": "warning",
+            "rule_id": f"rule_{i}",
+            "message": f"msg {i}",
+        }
+
+    def test_single_summary_review_for_small_stream(self):
+        client = self._make_client()
+        batches = [[self._finding(0)], [self._finding(1)]]
+
+        responses = post_review_streaming(
+            client, "owner", "repo", 1, "abc123", iter(batches), ["stage3"]
+        )
+
+        assert len(responses) == 1
+        call_kwargs = client.create_review.call_args
+        assert len(call_kwargs[1]["comments"]) == 2
+        assert "2" in call_kwargs[1]["body"]
+
+    def test_metrics_callable_evaluated_at_close(self):
+        # A callable metrics source is only snapshotted when the closing
+        # summary is built — after the stream has been fully consumed.
+        client = self._make_client()
+        consumed = []
+
+        def batches():
+            consumed.append(True)
+            yield [self._finding(0)]
+
+        def metrics_snapshot():
+            assert consumed, "metrics snapshot taken before stream consumed"
+            return [
+                {
+                    "stage": "pipeline",
+                    "wall_time_s": 1.0,
+                    "counters": {},
+                    "timings": {},
+                }
+            ]
+
+        post_review_streaming(
+            client,
+            "owner",
+            "repo",
+            1,
+            "abc123",
+            batches(),
+            ["stage3"],
+            metrics=metrics_snapshot,
+        )
+
+        body = client.create_review.call_args[1]["body"]
+        assert "### 처리 시간" in body
+        assert "| pipeline |" in body
+
+    def test_interim_batch_posted_before_stream_ends(self):
+        client = self._make_client()
+        posted_at = []
+
+        def record_review(**kwargs):
+            posted_at.append(len(kwargs["comments"]))
+            return {"id": len(posted_at)}
+
+        client.create_review.side_effect = record_review
+
+        def batches():
+            # First hand-off already fills a whole batch...
+            yield [self._finding(i) for i in range(MAX_COMMENTS_PER_REVIEW)]
+            # ...so it must be posted before this second hand-off.
+            assert len(posted_at) == 1
+            yield [self._finding(MAX_COMMENTS_PER_REVIEW)]
+
+        responses = post_review_streaming(
+            client, "owner", "repo", 1, "abc123", batches()
+        )
+
+        assert len(responses) == 2
+        assert posted_at == [MAX_COMMENTS_PER_REVIEW, 1]
+        # Interim review first, summary body last.
+        first_body = client.create_review.call_args_list[0][1]["body"]
+        last_body = client.create_review.call_args_list[1][1]["body"]
+        assert "streaming batch 1" in first_body
+        assert "issues found" in last_body
+
+    def test_duplicates_across_stream_dropped(self):
+        client = self._make_client()
+        batches = [[self._finding(0)], [self._finding(0), self._finding(1)]]
+
+        post_review_streaming(
+            client, "owner", "repo", 1, "abc123", iter(batches)
+        )
+
+        call_kwargs = client.create_review.call_args
+        assert len(call_kwargs[1]["comments"]) == 2
+
+    def test_already_posted_comments_filtered(self):
+        client = self._make_client()
+        finding = self._finding(0)
+        existing = [{
+            "path": finding["file"],
+            "line": finding["line"],
+            "commit_id": "abc123",
+            "body": format_comment_body(finding),
+        }]
+
+        responses = post_review_streaming(
+            client, "owner", "repo", 1, "abc123",
+            iter([[finding]]),
+            existing_comments=existing,
+        )
+
+        # Summary review still posted, but without the duplicate comment.
+        assert len(responses) == 1
+        call_kwargs = client.create_review.call_args
+        assert call_kwargs[1]["comments"] == []
+
+    def test_empty_stream_posts_clean_summary(self):
+        client = self._make_client()
+
+        responses = post_review_streaming(
+            client, "owner", "repo", 1, "abc123", iter([])
+        )
+
+        assert len(responses) == 1
+        call_kwargs = client.create_review.call_args
+        assert "No issues found" in call_kwargs[1]["body"]
+
+    def test_interim_error_does_not_stop_stream(self):
+        client = self._make_client()
+        client.create_review.side_effect = [
+            RuntimeError("API error"),
+            {"id": 2},
+        ]
+
+        batches = [
+            [self._finding(i) for i in range(MAX_COMMENTS_PER_REVIEW)],
+            [self._finding(MAX_COMMENTS_PER_REVIEW)],
+        ]
+        responses = post_review_streaming(
+            client, "owner", "repo", 1, "abc123", iter(batches)
+        )
+
+        assert len(responses) == 2
+        assert "error" in responses[0]
+        assert responses[1] == {"id": 2}
+
+
+# ---------------------------------------------------------------------------
+# Finding fingerprint tests
+# ---------------------------------------------------------------------------
+
+
+class TestFindingFingerprint:
+
+    def test_stable_across_message_whitespace(self):
+        a = {"file": "A.cpp", "rule_id": "logtemp", "message": "use  a\ncategory"}
+        b = {"file": "A.cpp", "rule_id": "logtemp", "message": "use a category"}
+        assert finding_fingerprint(a) == finding_fingerprint(b)
+
+    def test_differs_by_file_and_rule(self):
+        base = {"file": "A.cpp", "rule_id": "logtemp", "message": "msg"}
+        other_file = dict(base, file="B.cpp")
+        other_rule = dict(base, rule_id="sync_load_runtime")
+        assert finding_fingerprint(base) != finding_fingerprint(other_file)
+        assert finding_fingerprint(base) != finding_fingerprint(other_rule)
+
+    def test_category_used_when_rule_id_absent(self):
+        llm = {"file": "A.cpp", "category": "performance", "message": "msg"}
+        assert finding_fingerprint(llm) == finding_fingerprint(dict(llm))
+
+    def test_embedded_in_comment_body(self):
+        finding = {
+            "file": "A.cpp",
+            "line": 3,
+            "rule_id": "logtemp",
+            "severity": "warning",
+            "message": "로그 카테고리를 사용하세요.",
+        }
+        body = format_comment_body(finding)
+        assert extract_fingerprint(body) == finding_fingerprint(finding)
+
+    def test_extract_returns_none_without_marker(self):
+        assert extract_fingerprint("plain human comment") is None
+        assert extract_fingerprint("") is None
+
+
+class TestFilterAlreadyPostedFingerprint:
+
+    def _finding(self, **overrides):
+        finding = {
+            "file": "Source/A.cpp",
+            "line": 10,
+            "rule_id": "logtemp",
+            "severity": "warning",
+            "message": "LogTemp 대신 카테고리를 사용하세요.",
+        }
+        finding.update(overrides)
+        return finding
+
+    def test_fingerprinted_duplicate_filtered_across_commits(self):
+        """A fingerprint match dedups even when the existing comment was
+        left on an older commit."""
+        finding = self._finding()
+        comments = build_review_comments([finding])
+        existing = [
+            {
+                "path": "Source/A.cpp",
+                "line": 10,
+                "commit_id": "old-sha",
+                "body": format_comment_body(finding),
+            }
+        ]
+        result = filter_already_posted(comments, existing, commit_sha="new-sha")
+        assert result == []
+
+    def test_body_formatting_tweak_does_not_defeat_dedup(self):
+        """Reformatted body with the same fingerprint is still a dup."""
+        finding = self._finding()
+        comments = build_review_comments([finding])
+        fp = finding_fingerprint(finding)
+        existing = [
+            {
+                "path": "Source/A.cpp",
+                "line": 10,
+                "commit_id": "new-sha",
+                # Completely different rendering, same embedded marker
+                "body": f"legacy rendering\n<!-- ue-review-bot:fp={fp} -->",
+            }
+        ]
+        result = filter_already_posted(comments, existing, commit_sha="new-sha")
+        assert result == []
+
+    def test_same_fingerprint_on_other_line_not_filtered(self):
+        """The same rule+message on a different line is a distinct comment."""
+        finding = self._finding(line=30)
+        comments = build_review_comments([finding])
+        existing = [
+            {
+                "path": "Source/A.cpp",
+                "line": 10,
+                "commit_id": "new-sha",
+                "body": format_comment_body(self._finding()),
+            }
+        ]
+        result = filter_already_posted(comments, existing, commit_sha="new-sha")
+        assert len(result) == 1
+
+    def test_legacy_comments_still_use_prefix_match(self):
+        """Existing comments without a marker fall back to body-prefix
+        dedup restricted to the current commit."""
+        finding = self._finding()
+        comments = build_review_comments([finding])
+        # Strip the marker to simulate a comment from an older bot version
+        legacy_body = _FP_RE.sub("", format_comment_body(finding)).rstrip()
+        existing = [
+            {
+                "path": "Source/A.cpp",
+                "line": 10,
+                "commit_id": "new-sha",
+                "body": legacy_body,
+            }
+        ]
+        result = filter_already_posted(comments, existing, commit_sha="new-sha")
+        assert result == []
+
+
+# ---------------------------------------------------------------------------
+# ETag-cached comment fetch tests
+# ---------------------------------------------------------------------------
+
+
+class TestGetExistingCommentsETagCache:
+
+    def test_no_cache_path_fetches_all_pages(self):
+        client = GitHubClient(token="test-token")
+        with patch.object(client, "_get_all_pages") as mock_pages:
+            mock_pages.return_value = [{"id": 1}]
+            result = client.get_existing_review_comments("org", "repo", 5)
+        assert result == [{"id": 1}]
+        mock_pages.assert_called_once_with("/repos/org/repo/pulls/5/comments")
+
+    def test_304_replays_cached_comments(self, tmp_path):
+        cache_file = tmp_path / "comments.json"
+        cached_comments = [{"id": 1, "body": "cached"}]
+        cache_file.write_text(
+            json.dumps({"etag": 'W/"abc"', "comments": cached_comments}),
+            encoding="utf-8",
+        )
+
+        client = GitHubClient(token="test-token")
+        with patch.object(client, "_request_with_headers") as mock_req, \
+                patch.object(client, "_get_all_pages") as mock_pages:
+            mock_req.return_value = (None, {})  # 304 Not Modified
+            result = client.get_existing_review_comments(
+                "org", "repo", 5, cache_path=str(cache_file)
+            )
+
+        assert result == cached_comments
+        mock_pages.assert_not_called()
+        # The probe must send the cached ETag conditionally
+        _, kwargs = mock_req.call_args
+        assert kwargs["extra_headers"] == {"If-None-Match": 'W/"abc"'}
+
+    def test_changed_etag_refetches_and_rewrites_cache(self, tmp_path):
+        cache_file = tmp_path / "comments.json"
+        cache_file.write_text(
+            json.dumps({"etag": 'W/"old"', "comments": [{"id": 1}]}),
+            encoding="utf-8",
+        )
+        fresh = [{"id": 1}, {"id": 2}]
+
+        client = GitHubClient(token="test-token")
+        with patch.object(client, "_request_with_headers") as mock_req, \
+                patch.object(client, "_get_all_pages") as mock_pages:
+            mock_req.return_value = ([{"id": 2}], {"ETag": 'W/"new"'})
+            mock_pages.return_value = fresh
+            result = client.get_existing_review_comments(
+                "org", "repo", 5, cache_path=str(cache_file)
+            )
+
+        assert result == fresh
+        saved = json.loads(cache_file.read_text(encoding="utf-8"))
+        assert saved == {"etag": 'W/"new"', "comments": fresh}
+
+    def test_corrupt_cache_degrades_to_full_fetch(self, tmp_path):
+        cache_file = tmp_path / "comments.json"
+        cache_file.write_text("{not json", encoding="utf-8")
+        fresh = [{"id": 3}]
+
+        client = GitHubClient(token="test-token")
+        with patch.object(client, "_request_with_headers") as mock_req, \
+                patch.object(client, "_get_all_pages") as mock_pages:
+            mock_req.return_value = (fresh, {"ETag": 'W/"x"'})
+            mock_pages.return_value = fresh
+            result = client.get_existing_review_comments(
+                "org", "repo", 5, cache_path=str(cache_file)
+            )
+
+        assert result == fresh
+        # No conditional header without a valid cached ETag
+        _, kwargs = mock_req.call_args
+        assert kwargs["extra_headers"] is None
+
+
+# ---------------------------------------------------------------------------
+# Adaptive rate-limit backoff
+# ---------------------------------------------------------------------------
+
+
+class TestAdaptiveRateLimitBackoff:
+    """GitHubClient must honor server-provided rate-limit headers."""
+
+    def test_retry_after_header_honored(self):
+        client = GitHubClient(token="test-token", max_retries=1)
+        conn = _FakeConnection(responses=[
+            _FakeHTTPResponse(
+                status=429,
+                body=b'{"message": "rate limited"}',
+                headers={"Retry-After": "7"},
+            ),
+            _FakeHTTPResponse(body=b'{"ok": true}'),
+        ])
+
+        with patch.object(client, "_new_connection", return_value=conn), \
+                patch("scripts.utils.gh_api.time.sleep") as mock_sleep:
+            result = client._request("GET", "/repos/org/repo/pulls/1")
+
+        assert result == {"ok": True}
+        mock_sleep.assert_called_once_with(7)
+
+    def test_retry_after_capped(self):
+        client = GitHubClient(token="test-token")
+        wait = client._rate_limit_wait({"Retry-After": "999"}, 0)
+        assert wait == 120
+
+    def test_quota_reset_waited_when_exhausted(self):
+        import time as _time
+
+        client = GitHubClient(token="test-token")
+        headers = {
+            "X-RateLimit-Remaining": "0",
+            "X-RateLimit-Reset": str(int(_time.time()) + 30),
+        }
+        wait = client._rate_limit_wait(headers, 0)
+        assert 28 <= wait <= 32
+
+    def test_quota_reset_in_past_waits_minimum(self):
+        import time as _time
+
+        client = GitHubClient(token="test-token")
+        headers = {
+            "X-RateLimit-Remaining": "0",
+            "X-RateLimit-Reset": str(int(_time.time()) - 100),
+        }
+        assert client._rate_limit_wait(headers, 0) == 1
+
+    def test_exponential_fallback_without_headers(self):
+        client = GitHubClient(token="test-token")
+        assert client._rate_limit_wait({}, 0) == 2
+        assert client._rate_limit_wait({}, 1) == 4
+
+    def test_quota_remaining_nonzero_uses_exponential(self):
+        client = GitHubClient(token="test-token")
+        headers = {
+            "X-RateLimit-Remaining": "42",
+            "X-RateLimit-Reset": "9999999999",
+        }
+        assert client._rate_limit_wait(headers, 0) == 2
+
+    def test_secondary_rate_limit_detection(self):
+        from scripts.utils.gh_api import GitHubClient as GC
+
+        body = '{"message": "You have exceeded a secondary rate limit."}'
+        assert GC._is_secondary_rate_limit(403, body)
+        assert GC._is_secondary_rate_limit(429, body)
+        assert not GC._is_secondary_rate_limit(403, '{"message": "nope"}')
+        assert not GC._is_secondary_rate_limit(500, body)
+
+    def test_secondary_limit_raises_specific_error(self):
+        from scripts.utils.gh_api import SecondaryRateLimitError
+
+        client = GitHubClient(token="test-token", max_retries=0)
+        conn = _FakeConnection(responses=[
+            _FakeHTTPResponse(
+                status=403,
+                body=b'{"message": "secondary rate limit exceeded"}',
+            ),
+        ])
+
+        with patch.object(client, "_new_connection", return_value=conn):
+            with pytest.raises(SecondaryRateLimitError):
+                client._request("POST", "/repos/org/repo/pulls/1/reviews")
+
+    def test_primary_limit_still_plain_runtime_error(self):
+        from scripts.utils.gh_api import SecondaryRateLimitError
+
+        client = GitHubClient(token="test-token", max_retries=0)
+        conn = _FakeConnection(responses=[
+            _FakeHTTPResponse(
+                status=403,
+                body=b'{"message": "API rate limit exceeded"}',
+            ),
+        ])
+
+        with patch.object(client, "_new_connection", return_value=conn):
+            with pytest.raises(RuntimeError) as excinfo:
+                client._request("POST", "/repos/org/repo/pulls/1/reviews")
+        assert not isinstance(excinfo.value, SecondaryRateLimitError)
+
+
+# ---------------------------------------------------------------------------
+# Concurrent batch posting
+# ---------------------------------------------------------------------------
+
+
+class TestPostBatchesConcurrent:
+    """_post_batches: summary first, continuations in parallel."""
+
+    @staticmethod
+    def _batches(count):
+        return [
+            [{"path": f"Source/File{i}.cpp", "line": 1, "body": "b"}]
+            for i in range(count)
+        ]
+
+    def test_summary_posted_first_and_order_preserved(self):
+        from scripts.post_review import _post_batches
+
+        client = MagicMock(spec=GitHubClient)
+        client.create_review.side_effect = lambda **kw: {"body": kw["body"]}
+
+        responses = _post_batches(
+            client, "owner", "repo", 1, "abc123", "SUMMARY", self._batches(4)
+        )
+
+        # The very first API call carries the summary.
+        first_call = client.create_review.call_args_list[0]
+        assert first_call[1]["body"] == "SUMMARY"
+        # Responses line up with batch indices regardless of completion
+        # order in the pool.
+        assert responses[0]["body"] == "SUMMARY"
+        for idx in range(1, 4):
+            assert f"continued {idx + 1}/4" in responses[idx]["body"]
+
+    def test_secondary_limit_falls_back_to_sequential(self, capsys):
+        import threading
+        from scripts.post_review import _post_batches
+        from scripts.utils.gh_api import SecondaryRateLimitError
+
+        lock = threading.Lock()
+        failed_once = []
+
+        def side_effect(**kw):
+            with lock:
+                if "continued 3" in kw["body"] and not failed_once:
+                    failed_once.append(True)
+                    raise SecondaryRateLimitError("secondary rate limit")
+            return {"body": kw["body"]}
+
+        client = MagicMock(spec=GitHubClient)
+        client.create_review.side_effect = side_effect
+
+        responses = _post_batches(
+            client, "owner", "repo", 1, "abc123", "SUMMARY", self._batches(4)
+        )
+
+        assert all("error" not in r for r in responses)
+        # 4 batches + 1 sequential retry of the rate-limited one.
+        assert client.create_review.call_count == 5
+        assert "sequentially" in capsys.readouterr().err
+
+    def test_persistent_secondary_limit_recorded_as_error(self):
+        from scripts.post_review import _post_batches
+        from scripts.utils.gh_api import SecondaryRateLimitError
+
+        def side_effect(**kw):
+            if "continued 2" in kw["body"]:
+                raise SecondaryRateLimitError("still limited")
+            return {"body": kw["body"]}
+
+        client = MagicMock(spec=GitHubClient)
+        client.create_review.side_effect = side_effect
+
+        responses = _post_batches(
+            client, "owner", "repo", 1, "abc123", "SUMMARY", self._batches(3)
+        )
+
+        assert "error" in responses[1]
+        assert "error" not in responses[0]
+        assert "error" not in responses[2]
+
+    def test_generic_error_does_not_trigger_fallback(self):
+        from scripts.post_review import _post_batches
+
+        def side_effect(**kw):
+            if "continued 2" in kw["body"]:
+                raise RuntimeError("validation failed")
+            return {"body": kw["body"]}
+
+        client = MagicMock(spec=GitHubClient)
+        client.create_review.side_effect = side_effect
+
+        responses = _post_batches(
+            client, "owner", "repo", 1, "abc123", "SUMMARY", self._batches(4)
+        )
+
+        assert "error" in responses[1]
+        assert "error" not in responses[0]
+        assert "error" not in responses[2]
+        assert "error" not in responses[3]
+        # No sequential retry for non-rate-limit errors.
+        assert client.create_review.call_count == 4
+
+    def test_summary_secondary_limit_downgrades_all(self, capsys):
+        from scripts.post_review import _post_batches
+        from scripts.utils.gh_api import SecondaryRateLimitError
+
+        calls = []
+
+        def side_effect(**kw):
+            calls.append(kw["body"])
+            if kw["body"] == "SUMMARY" and calls.count("SUMMARY") == 1:
+                raise SecondaryRateLimitError("secondary rate limit")
+            return {"body": kw["body"]}
+
+        client = MagicMock(spec=GitHubClient)
+        client.create_review.side_effect = side_effect
+
+        responses = _post_batches(
+            client, "owner", "repo", 1, "abc123", "SUMMARY", self._batches(3)
+        )
+
+        assert "error" in responses[0]
+        assert "error" not in responses[1]
+        assert "error" not in responses[2]
+        # Continuations posted strictly in order after the downgrade.
+        assert calls[1:] == ["## UE5 Code Review Bot (continued 2/3)",
+                             "## UE5 Code Review Bot (continued 3/3)"]
+
+
+# ---------------------------------------------------------------------------
+# GraphQL PR context fetch
+# ---------------------------------------------------------------------------
+
+
+class TestGraphQLPRContext:
+    """Single-query PR metadata via GitHubClient.get_pr_context."""
+
+    @staticmethod
+    def _pr_payload(**overrides):
+        pr = {
+            "headRefOid": "headsha",
+            "baseRefOid": "basesha",
+            "changedFiles": 3,
+            "labels": {"nodes": [{"name": "large-pr"}, {"name": "ui"}]},
+            "reviewThreads": {
+                "pageInfo": {"hasNextPage": False},
+                "nodes": [
+                    {
+                        "comments": {
+                            "pageInfo": {"hasNextPage": False},
+                            "nodes": [
+                                {
+                                    "path": "Source/A.cpp",
+                                    "body": "old comment",
+                                    "line": 12,
+                                    "startLine": None,
+                                    "originalLine": 12,
+                                    "commit": {"oid": "headsha"},
+                                }
+                            ],
+                        }
+                    }
+                ],
+            },
+        }
+        pr.update(overrides)
+        return {"repository": {"pullRequest": pr}}
+
+    def test_graphql_path_ghes(self):
+        client = GitHubClient(
+            token="t", api_url="https://github.company.com/api/v3"
+        )
+        assert client._graphql_path() == "/api/graphql"
+
+    def test_graphql_path_github_com(self):
+        client = GitHubClient(token="t", api_url="https://api.github.com")
+        assert client._graphql_path() == "/graphql"
+
+    def test_graphql_posts_to_graphql_endpoint(self):
+        client = GitHubClient(
+            token="t", api_url="https://github.company.com/api/v3"
+        )
+        conn = _FakeConnection(
+            responses=[_FakeHTTPResponse(body=b'{"data": {"ok": true}}')]
+        )
+        with patch.object(client, "_new_connection", return_value=conn):
+            data = client.graphql("query { ok }")
+        assert data == {"ok": True}
+        assert conn.requests == [("POST", "/api/graphql")]
+
+    def test_graphql_errors_raise(self):
+        client = GitHubClient(token="t")
+        conn = _FakeConnection(
+            responses=[
+                _FakeHTTPResponse(
+                    body=b'{"errors": [{"message": "Field missing"}]}'
+                )
+            ]
+        )
+        with patch.object(client, "_new_connection", return_value=conn):
+            with pytest.raises(RuntimeError, match="Field missing"):
+                client.graphql("query { broken }")
+
+    def test_context_normalizes_to_rest_field_names(self):
+        client = GitHubClient(token="t")
+        with patch.object(client, "graphql", return_value=self._pr_payload()):
+            context = client.get_pr_context("owner", "repo", 7)
+
+        assert context["head_sha"] == "headsha"
+        assert context["base_sha"] == "basesha"
+        assert context["changed_files"] == 3
+        assert context["labels"] == ["large-pr", "ui"]
+        comment = context["review_comments"][0]
+        assert comment["path"] == "Source/A.cpp"
+        assert comment["start_line"] is None
+        assert comment["original_line"] == 12
+        assert comment["commit_id"] == "headsha"
+
+    def test_normalized_comments_feed_filter_already_posted(self):
+        """GraphQL-shaped comments must dedupe like REST-shaped ones."""
+        client = GitHubClient(token="t")
+        finding = {
+            "file": "Source/A.cpp",
+            "line": 12,
+            "severity": "warning",
+            "rule_id": "logtemp",
+            "message": "msg",
+        }
+        new_comments = build_review_comments([finding])
+        payload = self._pr_payload()
+        node = payload["repository"]["pullRequest"]["reviewThreads"][
+            "nodes"
+        ][0]["comments"]["nodes"][0]
+        node["body"] = new_comments[0]["body"]
+
+        with patch.object(client, "graphql", return_value=payload):
+            context = client.get_pr_context("owner", "repo", 7)
+
+        filtered = filter_already_posted(
+            new_comments, context["review_comments"], "headsha"
+        )
+        assert filtered == []
+
+    def test_overflowing_threads_mark_comments_incomplete(self):
+        client = GitHubClient(token="t")
+        payload = self._pr_payload()
+        payload["repository"]["pullRequest"]["reviewThreads"]["pageInfo"][
+            "hasNextPage"
+        ] = True
+        with patch.object(client, "graphql", return_value=payload):
+            context = client.get_pr_context("owner", "repo", 7)
+        assert context is not None
+        assert context["review_comments"] is None
+        assert context["labels"] == ["large-pr", "ui"]
+
+    def test_overflowing_thread_comments_mark_incomplete(self):
+        client = GitHubClient(token="t")
+        payload = self._pr_payload()
+        payload["repository"]["pullRequest"]["reviewThreads"]["nodes"][0][
+            "comments"
+        ]["pageInfo"]["hasNextPage"] = True
+        with patch.object(client, "graphql", return_value=payload):
+            context = client.get_pr_context("owner", "repo", 7)
+        assert context["review_comments"] is None
+
+    def test_graphql_failure_returns_none(self, capsys):
+        client = GitHubClient(token="t")
+        with patch.object(
+            client, "graphql", side_effect=RuntimeError("GraphQL disabled")
+        ):
+            context = client.get_pr_context("owner", "repo", 7)
+        assert context is None
+        assert "falling back to REST" in capsys.readouterr().err
+
+    def test_missing_pull_request_returns_none(self, capsys):
+        client = GitHubClient(token="t")
+        with patch.object(
+            client, "graphql", return_value={"repository": None}
+        ):
+            context = client.get_pr_context("owner", "repo", 7)
+        assert context is None
+        assert "falling back to REST" in capsys.readouterr().err
@@ -0,0 +1,204 @@
+"""Tests for run_pipeline.py — single-job in-process pipeline driver.
+
+Covers:
+  - Stage 1 in-process run over a parsed fixture diff
+  - compile_commands.json auto-detection
+  - finding-batch generator feeding post_review_streaming
+  - dry-run CLI end-to-end (gate → stage1 → payload, no GitHub/API)
+"""
+
+from __future__ import annotations
+
+import json
+import queue
+import subprocess
+import sys
+from pathlib import Path
+
+import pytest
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
+
+from scripts.run_pipeline import (
+    _STREAM_END,
+    _finding_batches,
+    find_compile_commands,
+    run_stage1,
+)
+from scripts.utils.diff_parser import parse_diff
+
+FIXTURES_DIR = Path(__file__).resolve().parent / "fixtures"
+CONFIGS_DIR = Path(__file__).resolve().parent.parent / "configs"
+
+
+# ---------------------------------------------------------------------------
+# Stage 1 in-process
+# ---------------------------------------------------------------------------
+
+
+class TestRunStage1:
+    def test_pattern_findings_from_fixture_diff(self, monkeypatch):
+        """Pattern findings come straight from the shared parsed diff."""
+        import scripts.run_pipeline as mod
+
+        # No clang-format in unit tests — pattern findings only.
+        monkeypatch.setattr(mod, "find_clang_format", lambda: None)
+
+        diff_text = (FIXTURES_DIR / "sample_diff.patch").read_text(
+            encoding="utf-8"
+        )
+        diff_data = parse_diff(diff_text)
+        findings = run_stage1(
+            diff_data,
+            list(diff_data.keys()),
+            str(CONFIGS_DIR / "checklist.yml"),
+            str(CONFIGS_DIR / ".clang-format"),
+        )
+        assert isinstance(findings, list)
+        for f in findings:
+            assert "file" in f
+            assert "line" in f
+            assert "rule_id" in f
+
+
+# ---------------------------------------------------------------------------
+# compile_commands.json detection
+# ---------------------------------------------------------------------------
+
+
+class TestFindCompileCommands:
+    def test_explicit_build_dir(self, tmp_path):
+        (tmp_path / "compile_commands.json").write_text("[]")
+        assert find_compile_commands(str(tmp_path)) == str(tmp_path)
+
+    def test_explicit_build_dir_missing(self, tmp_path):
+        assert find_compile_commands(str(tmp_path)) is None
+
+    def test_auto_detect_cwd_then_build(self, tmp_path):
+        import os
+
+        cwd = os.getcwd()
+        os.chdir(tmp_path)
+        try:
+            assert find_compile_commands() is None
+            (tmp_path / "build").mkdir()
+            (tmp_path / "build" / "compile_commands.json").write_text("[]")
+            assert find_compile_commands() == "build"
+            (tmp_path / "compile_commands.json").write_text("[]")
+            assert find_compile_commands() == "."
+        finally:
+            os.chdir(cwd)
+
+
+# ---------------------------------------------------------------------------
+# Streaming batch generator
+# ---------------------------------------------------------------------------
+
+
+class TestFindingBatches:
+    DIFF = (
+        "diff --git a/Source/A.cpp b/Source/A.cpp\n"
+        "index 111..222 100644\n"
+        "--- a/Source/A.cpp\n"
+        "+++ b/Source/A.cpp\n"
+        "@@ -1,2 +1,3 @@\n"
+        " int x;\n"
+        "+int y;\n"
+        " int z;\n"
+    )
+
+    def _finding(self, line):
+        return {
+            "file": "Source/A.cpp",
+            "line": line,
+            "rule_id": "test_rule",
+            "severity": "warning",
+            "message": "테스트",
+        }
+
+    def test_early_findings_first_then_stream(self):
+        q = queue.Queue()
+        q.put([self._finding(2)])
+        q.put(_STREAM_END)
+        batches = list(_finding_batches([self._finding(2)], q, self.DIFF))
+        assert len(batches) == 2
+
+    def test_empty_early_findings_skipped(self):
+        q = queue.Queue()
+        q.put(_STREAM_END)
+        assert list(_finding_batches([], q, self.DIFF)) == []
+
+    def test_batches_are_hunk_filtered(self):
+        q = queue.Queue()
+        # Line 99 is outside the diff hunks → dropped before posting.
+        q.put([self._finding(2), self._finding(99)])
+        q.put(_STREAM_END)
+        batches = list(_finding_batches([], q, self.DIFF))
+        assert len(batches) == 1
+        assert [f["line"] for f in batches[0]] == [2]
+
+    def test_fully_filtered_batch_not_yielded(self):
+        q = queue.Queue()
+        q.put([self._finding(99)])
+        q.put(_STREAM_END)
+        # filter drops everything; empty list still yielded is fine to
+        # skip — post_review_streaming treats both the same, but the
+        # generator must terminate on the sentinel either way.
+        batches = list(_finding_batches([], q, self.DIFF))
+        assert all(isinstance(b, list) for b in batches)
+
+
+# ---------------------------------------------------------------------------
+# Dry-run CLI
+# ---------------------------------------------------------------------------
+
+
+class TestPipelineDryRunCLI:
+    def test_dry_run_end_to_end(self, tmp_path, monkeypatch):
+        """Gate + Stage 1 run in one process and produce a payload."""
+        monkeypatch.delenv("ANTHROPIC_API_KEY", raising=False)
+        output_file = tmp_path / "result.json"
+        script = (
+            Path(__file__).resolve().parent.parent / "scripts" / "run_pipeline.py"
+        )
+        result = subprocess.run(
+            [
+                sys.executable,
+                str(script),
+                "--diff", str(FIXTURES_DIR / "sample_diff.patch"),
+                "--config", str(CONFIGS_DIR / "gate_config.yml"),
+                "--checklist", str(CONFIGS_DIR / "checklist.yml"),
+                "--clang-format-config", str(CONFIGS_DIR / ".clang-format"),
+                "--dry-run",
+                "--output", str(output_file),
+            ],
+            capture_output=True,
+            text=True,
+        )
+
+        assert result.returncode == 0, f"CLI failed: {result.stderr}"
+        data = json.loads(output_file.read_text())
+        assert data["gate"]["is_large_pr"] is False
+        assert len(data["gate"]["reviewable_files"]) == 4
+        assert data["stage3_findings"] == 0
+        assert "summary" in data
+        assert data["total_findings"] == len(
+            [c for c in data["comments"]]
+        ) or data["total_findings"] >= len(data["comments"])
+
+    def test_missing_diff_errors(self, tmp_path):
+        script = (
+            Path(__file__).resolve().parent.parent / "scripts" / "run_pipeline.py"
+        )
+        result = subprocess.run(
+            [
+                sys.executable,
+                str(script),
+                "--diff", str(tmp_path / "nope.diff"),
+                "--dry-run",
+            ],
+            capture_output=True,
+            text=True,
+        )
+        assert result.returncode == 1
+        assert "Diff file not found" in result.stderr
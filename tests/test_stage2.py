@@ -22,9 +22,11 @@ import yaml
 sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
 
 from scripts.stage2_tidy_to_suggestions import (
+    SourceIndex,
     convert_diagnostics,
     deduplicate,
     parse_tidy_fixes,
+    parse_tidy_fixes_text,
     _collect_source_contents,
     _extract_suggestion_span,
     _offset_to_line,
@@ -491,6 +493,62 @@ class TestHelpers:
         assert result == "Source/A.cpp"
 
 
+class TestSourceIndex:
+    """Tests for the shared per-file offset→line index."""
+
+    def test_agrees_with_offset_to_line(self):
+        content = "line1\nline2\nline3\n"
+        index = SourceIndex(content)
+        for offset in range(len(content) + 2):
+            assert index.line_at(offset) == _offset_to_line(content, offset)
+
+    def test_agrees_on_multibyte_content(self):
+        # '한' is 3 UTF-8 bytes — byte offsets diverge from char offsets.
+        content = "// 한국어 주석\nint x = 0;\n"
+        index = SourceIndex(content)
+        for offset in range(len(content.encode("utf-8")) + 2):
+            assert index.line_at(offset) == _offset_to_line(content, offset)
+
+    def test_empty_content(self):
+        assert SourceIndex("").line_at(0) == 1
+
+    def test_encoded_bytes_cached(self):
+        content = "void f();\n"
+        index = SourceIndex(content)
+        assert index.encoded == content.encode("utf-8")
+
+
+class TestCollectSourceReadCache:
+    """Diagnostics spelling the same file differently read it once."""
+
+    def test_same_physical_file_read_once(self, tmp_path, monkeypatch):
+        src = tmp_path / "MyActor.cpp"
+        src.write_text("void f();\n", encoding="utf-8")
+        # Two spellings of the same file: direct and via a '.' component.
+        direct = str(src)
+        dotted = str(tmp_path / "." / "MyActor.cpp")
+        diags = [
+            {"DiagnosticMessage": {"FilePath": direct}},
+            {"DiagnosticMessage": {"FilePath": dotted}},
+        ]
+
+        import scripts.stage2_tidy_to_suggestions as mod
+
+        reads = []
+        real_read = mod._read_source
+
+        def counting_read(p):
+            reads.append(str(p))
+            return real_read(p)
+
+        monkeypatch.setattr(mod, "_read_source", counting_read)
+        contents, _ = _collect_source_contents(diags)
+
+        assert contents[direct] == "void f();\n"
+        assert contents[dotted] == "void f();\n"
+        assert len(reads) == 1
+
+
 # ---------------------------------------------------------------------------
 # Integration test — full pipeline
 # ---------------------------------------------------------------------------
@@ -1703,3 +1761,28 @@ class TestConstRefParamMigration:
         assert rule is not None
         assert rule["severity"] == "warning"
         assert rule["auto_fixable"] is True
+
+
+# ---------------------------------------------------------------------------
+# parse_tidy_fixes_text — in-memory YAML (single-job pipeline mode)
+# ---------------------------------------------------------------------------
+
+
+class TestParseTidyFixesText:
+    def test_agrees_with_file_parser(self, tmp_path):
+        content = _make_fixes_yaml(
+            [_make_diag("modernize-use-nullptr", "use nullptr")]
+        )
+        fixes_file = tmp_path / "fixes.yaml"
+        fixes_file.write_text(content, encoding="utf-8")
+        assert parse_tidy_fixes_text(content) == parse_tidy_fixes(
+            str(fixes_file)
+        )
+        assert len(parse_tidy_fixes_text(content)) == 1
+
+    def test_empty_text(self):
+        assert parse_tidy_fixes_text("") == []
+        assert parse_tidy_fixes_text("   \n") == []
+
+    def test_invalid_yaml(self):
+        assert parse_tidy_fixes_text("{ Diagnostics: [") == []
@@ -0,0 +1,278 @@
+"""Tests for stage2_tidy_runner.py — parallel clang-tidy orchestrator.
+
+Covers:
+  - longest-file-first scheduling order
+  - per-file result handling (missing files, missing binary)
+  - multi-document merge of per-file --export-fixes output
+  - merged output is parseable by stage2_tidy_to_suggestions
+"""
+
+from __future__ import annotations
+
+import json
+import sys
+from pathlib import Path
+from unittest.mock import patch
+
+import pytest
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
+
+from scripts.stage2_tidy_runner import (
+    merge_fixes_yaml,
+    order_longest_first,
+    run_clang_tidy_file,
+    run_parallel,
+)
+from scripts.stage2_tidy_to_suggestions import parse_tidy_fixes
+
+
+SAMPLE_FIXES_A = """\
+MainSourceFile: /src/A.cpp
+Diagnostics:
+  - DiagnosticName: modernize-use-override
+    DiagnosticMessage:
+      Message: "use override"
+      FilePath: /src/A.cpp
+      FileOffset: 10
+      Replacements: []
+    Level: Warning
+"""
+
+SAMPLE_FIXES_B = """\
+MainSourceFile: /src/B.cpp
+Diagnostics:
+  - DiagnosticName: performance-for-range-copy
+    DiagnosticMessage:
+      Message: "loop copy"
+      FilePath: /src/B.cpp
+      FileOffset: 20
+      Replacements: []
+    Level: Warning
+"""
+
+
+class TestOrderLongestFirst:
+    def test_orders_by_size_descending(self, tmp_path):
+        small = tmp_path / "small.cpp"
+        big = tmp_path / "big.cpp"
+        medium = tmp_path / "medium.cpp"
+        small.write_text("a" * 10)
+        big.write_text("a" * 1000)
+        medium.write_text("a" * 100)
+
+        ordered = order_longest_first([str(small), str(big), str(medium)])
+        assert ordered == [str(big), str(medium), str(small)]
+
+    def test_missing_files_sort_last(self, tmp_path):
+        present = tmp_path / "present.cpp"
+        present.write_text("content")
+
+        ordered = order_longest_first([str(tmp_path / "gone.cpp"), str(present)])
+        assert ordered == [str(present), str(tmp_path / "gone.cpp")]
+
+
+class TestRunClangTidyFile:
+    def test_missing_file_is_skipped(self, tmp_path):
+        result = run_clang_tidy_file(
+            str(tmp_path / "missing.cpp"), str(tmp_path)
+        )
+        assert result["status"] == "skipped"
+        assert result["fixes_yaml"] == ""
+
+    def test_missing_binary_is_error(self, tmp_path, monkeypatch):
+        import scripts.stage2_tidy_runner as mod
+
+        src = tmp_path / "a.cpp"
+        src.write_text("void f() {}")
+        monkeypatch.setattr(mod, "find_clang_tidy", lambda: None)
+
+        result = run_clang_tidy_file(str(src), str(tmp_path))
+        assert result["status"] == "error"
+
+
+class TestMergeFixesYaml:
+    def test_merges_into_multi_document_yaml(self):
+        results = [
+            {"file": "A.cpp", "status": "ok", "fixes_yaml": SAMPLE_FIXES_A},
+            {"file": "B.cpp", "status": "ok", "fixes_yaml": SAMPLE_FIXES_B},
+        ]
+        merged = merge_fixes_yaml(results)
+        assert "---" in merged
+
+    def test_skips_empty_outputs(self):
+        results = [
+            {"file": "A.cpp", "status": "ok", "fixes_yaml": SAMPLE_FIXES_A},
+            {"file": "B.cpp", "status": "ok", "fixes_yaml": ""},
+            {"file": "C.cpp", "status": "timeout", "fixes_yaml": ""},
+        ]
+        merged = merge_fixes_yaml(results)
+        assert merged.count("Diagnostics") == 1
+
+    def test_no_fixes_gives_empty_string(self):
+        assert merge_fixes_yaml([]) == ""
+        assert merge_fixes_yaml([{"file": "A.cpp", "status": "ok", "fixes_yaml": ""}]) == ""
+
+    def test_merged_output_feeds_parse_tidy_fixes(self, tmp_path):
+        """End-to-end: merged YAML is consumed by the Stage 2 converter."""
+        results = [
+            {"file": "A.cpp", "status": "ok", "fixes_yaml": SAMPLE_FIXES_A},
+            {"file": "B.cpp", "status": "ok", "fixes_yaml": SAMPLE_FIXES_B},
+        ]
+        merged_path = tmp_path / "tidy-fixes.yaml"
+        merged_path.write_text(merge_fixes_yaml(results), encoding="utf-8")
+
+        diagnostics = parse_tidy_fixes(str(merged_path))
+        names = {d["DiagnosticName"] for d in diagnostics}
+        assert names == {"modernize-use-override", "performance-for-range-copy"}
+
+
+class TestRunParallel:
+    def test_empty_file_list(self):
+        assert run_parallel([], ".") == []
+
+    @patch("scripts.stage2_tidy_runner.run_clang_tidy_file")
+    def test_all_files_processed(self, mock_run, tmp_path):
+        files = []
+        for i in range(5):
+            fp = tmp_path / f"f{i}.cpp"
+            fp.write_text("x" * (i + 1))
+            files.append(str(fp))
+
+        mock_run.side_effect = lambda fp, *a, **kw: {
+            "file": fp, "status": "ok", "fixes_yaml": "", "elapsed": 0.0,
+        }
+
+        results = run_parallel(files, str(tmp_path), jobs=3)
+        assert {r["file"] for r in results} == set(files)
+
+    @patch("scripts.stage2_tidy_runner.run_clang_tidy_file")
+    def test_submission_order_is_longest_first(self, mock_run, tmp_path):
+        small = tmp_path / "small.cpp"
+        big = tmp_path / "big.cpp"
+        small.write_text("a" * 5)
+        big.write_text("a" * 500)
+
+        submitted = []
+
+        def record(fp, *a, **kw):
+            submitted.append(fp)
+            return {"file": fp, "status": "ok", "fixes_yaml": "", "elapsed": 0.0}
+
+        mock_run.side_effect = record
+
+        # Single worker makes submission order observable.
+        run_parallel([str(small), str(big)], str(tmp_path), jobs=1)
+        assert submitted == [str(big), str(small)]
+
+
+# ---------------------------------------------------------------------------
+# Tests: incremental result cache
+# ---------------------------------------------------------------------------
+
+
+class TestTidyCache:
+    """Tests for the incremental result cache (scripts.utils.tidy_cache)."""
+
+    def test_key_sensitivity(self):
+        from scripts.utils.tidy_cache import make_tidy_cache_key
+
+        base = make_tidy_cache_key("src", "entry", "config")
+        assert base == make_tidy_cache_key("src", "entry", "config")
+        assert base != make_tidy_cache_key("src2", "entry", "config")
+        assert base != make_tidy_cache_key("src", "entry2", "config")
+        assert base != make_tidy_cache_key("src", "entry", "config2")
+
+    def test_put_get_roundtrip(self, tmp_path):
+        from scripts.utils.tidy_cache import TidyCache
+
+        cache = TidyCache(str(tmp_path / "cache"))
+        cache.put("k1", "a.cpp", SAMPLE_FIXES_A)
+
+        assert cache.get("k1") == SAMPLE_FIXES_A
+        assert cache.get("missing") is None
+        assert cache.summary() == {"cache_hits": 1, "cache_misses": 1}
+
+    def test_empty_yaml_is_cacheable(self, tmp_path):
+        """A clean file (no diagnostics) is a valid cached result."""
+        from scripts.utils.tidy_cache import TidyCache
+
+        cache = TidyCache(str(tmp_path / "cache"))
+        cache.put("clean", "a.cpp", "")
+        assert cache.get("clean") == ""
+
+    def test_load_compile_commands_index(self, tmp_path):
+        from scripts.utils.tidy_cache import load_compile_commands_index
+
+        src = tmp_path / "A.cpp"
+        src.write_text("void f() {}")
+        db = [
+            {
+                "directory": str(tmp_path),
+                "command": "clang++ -c A.cpp",
+                "file": "A.cpp",
+            }
+        ]
+        (tmp_path / "compile_commands.json").write_text(json.dumps(db))
+
+        index = load_compile_commands_index(str(tmp_path))
+        assert str(src.resolve()) in index
+        assert "clang++" in index[str(src.resolve())]
+
+    def test_missing_database_gives_empty_index(self, tmp_path):
+        from scripts.utils.tidy_cache import load_compile_commands_index
+
+        assert load_compile_commands_index(str(tmp_path)) == {}
+
+    @patch("scripts.stage2_tidy_runner.run_clang_tidy_file")
+    def test_second_run_replays_from_cache(self, mock_run, tmp_path):
+        from scripts.utils.tidy_cache import TidyCache
+
+        src = tmp_path / "a.cpp"
+        src.write_text("void f() {}")
+        mock_run.side_effect = lambda fp, *a, **kw: {
+            "file": fp, "status": "ok",
+            "fixes_yaml": SAMPLE_FIXES_A, "elapsed": 1.0,
+        }
+
+        cache = TidyCache(str(tmp_path / "cache"))
+        results1 = run_parallel([str(src)], str(tmp_path), cache=cache)
+        assert results1[0]["status"] == "ok"
+        assert mock_run.call_count == 1
+
+        results2 = run_parallel([str(src)], str(tmp_path), cache=cache)
+        assert mock_run.call_count == 1  # no new clang-tidy run
+        assert results2[0]["status"] == "cached"
+        assert results2[0]["fixes_yaml"] == SAMPLE_FIXES_A
+
+    @patch("scripts.stage2_tidy_runner.run_clang_tidy_file")
+    def test_content_change_invalidates(self, mock_run, tmp_path):
+        from scripts.utils.tidy_cache import TidyCache
+
+        src = tmp_path / "a.cpp"
+        src.write_text("void f() {}")
+        mock_run.side_effect = lambda fp, *a, **kw: {
+            "file": fp, "status": "ok", "fixes_yaml": "", "elapsed": 0.5,
+        }
+
+        cache = TidyCache(str(tmp_path / "cache"))
+        run_parallel([str(src)], str(tmp_path), cache=cache)
+        src.write_text("void f() { int x = 0; }")
+        run_parallel([str(src)], str(tmp_path), cache=cache)
+        assert mock_run.call_count == 2
+
+    @patch("scripts.stage2_tidy_runner.run_clang_tidy_file")
+    def test_timeout_not_cached(self, mock_run, tmp_path):
+        from scripts.utils.tidy_cache import TidyCache
+
+        src = tmp_path / "a.cpp"
+        src.write_text("void f() {}")
+        mock_run.side_effect = lambda fp, *a, **kw: {
+            "file": fp, "status": "timeout", "fixes_yaml": "", "elapsed": 300.0,
+        }
+
+        cache = TidyCache(str(tmp_path / "cache"))
+        run_parallel([str(src)], str(tmp_path), cache=cache)
+        run_parallel([str(src)], str(tmp_path), cache=cache)
+        # Timed-out file must be retried, not served from cache.
+        assert mock_run.call_count == 2